@@ -0,0 +1,45 @@
+#include "../src/double_buffer.h"
+#include "../src/grid.h"
+#include <benchmark/benchmark.h>
+
+// Compares finishing a generation by copying the whole back buffer into the
+// front one against flipping the two buffers. The step itself is left out so
+// only the hand-off cost is measured.
+
+static void BM_GenerationCopy(benchmark::State& state) {
+    const auto size = static_cast<std::size_t>(state.range(0));
+    Grid grid{size, size};
+    const Grid buffer{size, size};
+
+    for (auto _ : state) {
+        grid = buffer;
+        benchmark::DoNotOptimize(grid.row(0));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(
+        static_cast<std::int64_t>(state.iterations() * size * size));
+}
+
+static void BM_GenerationFlip(benchmark::State& state) {
+    const auto size = static_cast<std::size_t>(state.range(0));
+    DoubleBuffer<Grid> generations{size, size};
+
+    for (auto _ : state) {
+        generations.flip();
+        benchmark::DoNotOptimize(generations.current().row(0));
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK(BM_GenerationCopy)
+    ->Arg(1 << 10)
+    ->Arg(1 << 12)
+    ->Arg(1 << 14)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GenerationFlip)
+    ->Arg(1 << 10)
+    ->Arg(1 << 12)
+    ->Arg(1 << 14)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
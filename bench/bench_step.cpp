@@ -0,0 +1,322 @@
+#include "../src/active_tile_engine.h"
+#include "../src/density_pyramid.h"
+#include "../src/ensemble.h"
+#include "../src/grid_engine.h"
+#include "../src/hashlife.h"
+#include "../src/packed_grid.h"
+#include "../src/sparse_tile_engine.h"
+#include "../src/step_kernels.h"
+#include "../src/tiled_grid_engine.h"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+// Step throughput over board size (64^2 to 16k^2), alive cell density (in
+// percent) and stepping engine. Every benchmark reports processed cells per
+// second and the bytes per cell its representation needs for both
+// generations. Run with --benchmark_out=<file> --benchmark_out_format=json to
+// get results that can be diffed between builds.
+
+namespace {
+
+Grid makeRandomGrid(std::size_t size, std::int64_t density_percent) {
+    std::mt19937_64 gen{size * 100 + static_cast<std::size_t>(density_percent)};
+    const auto threshold = std::mt19937_64::max() / 100 * density_percent;
+
+    Grid grid{size, size};
+    for (std::size_t i = 0; i < size; i++) {
+        auto* row = grid.row(i);
+        for (std::size_t j = 0; j < size; j++) {
+            row[j].data = gen() < threshold;
+        }
+    }
+    return grid;
+}
+
+void setCounters(benchmark::State& state, std::size_t cells, double bytes) {
+    state.counters["cells/s"] = benchmark::Counter(
+        static_cast<double>(cells) * static_cast<double>(state.iterations()),
+        benchmark::Counter::kIsRate);
+    state.counters["bytes/cell"] = bytes / static_cast<double>(cells);
+}
+
+// Registers every size/density pair up to `max_size`, once per value of an
+// optional third argument.
+void applyArgs(benchmark::internal::Benchmark* bench,
+               std::int64_t max_size,
+               const std::vector<std::int64_t>& extra_values = {},
+               const char* extra_name = nullptr) {
+    const auto repeats
+        = extra_values.empty() ? std::vector<std::int64_t>{0} : extra_values;
+    for (const auto extra : repeats) {
+        for (std::int64_t size = 64; size <= max_size; size *= 4) {
+            for (const std::int64_t density : {1, 10, 50}) {
+                if (extra_values.empty()) {
+                    bench->Args({size, density});
+                } else {
+                    bench->Args({size, density, extra});
+                }
+            }
+        }
+    }
+
+    if (extra_values.empty()) {
+        bench->ArgNames({"size", "density"});
+    } else {
+        bench->ArgNames({"size", "density", extra_name});
+    }
+    bench->Unit(benchmark::kMillisecond);
+}
+
+}  // namespace
+
+static void BM_GetPeriodicIndex(benchmark::State& state) {
+    const Grid grid{1024, 1024};
+    for (auto _ : state) {
+        for (int i = -1; i <= 1024; i++) {
+            for (int j = -1; j <= 1024; j++) {
+                benchmark::DoNotOptimize(grid.getPeriodicIndex(i, j));
+            }
+        }
+    }
+    setCounters(state, 1026 * 1026, 0);
+}
+
+static void BM_CheckCell(benchmark::State& state) {
+    const auto size = static_cast<std::size_t>(state.range(0));
+    const auto grid = makeRandomGrid(size, state.range(1));
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < size; i++) {
+            for (std::size_t j = 0; j < size; j++) {
+                benchmark::DoNotOptimize(grid.checkCell({i, j}));
+            }
+        }
+    }
+    setCounters(state, size * size, 2.0 * sizeof(Cell) * size * size);
+}
+
+static void BM_RowKernel(benchmark::State& state) {
+    const auto& kernel = getAvailableKernels()[static_cast<std::size_t>(state.range(2))];
+    state.SetLabel(std::string(kernel.name));
+
+    const auto size = static_cast<std::size_t>(state.range(0));
+    const auto grid = makeRandomGrid(size, state.range(1));
+    Grid next{size, size};
+    for (auto _ : state) {
+        stepRows(grid, next, 0, size, kernel.compute_row);
+        benchmark::ClobberMemory();
+    }
+    setCounters(state, size * size, 2.0 * sizeof(Cell) * size * size);
+}
+
+// The kernels specialized for HighLife followed by the table-driven ones, to
+// measure what compile-time specialization saves on a rule other than Life.
+static void BM_HighLifeKernel(benchmark::State& state) {
+    const auto& specialized = getAvailableKernels(highlife_rule);
+    const auto& table = getTableKernels();
+    const auto index = static_cast<std::size_t>(state.range(2));
+    const auto& kernel
+        = index < specialized.size() ? specialized[index] : table[index - specialized.size()];
+    state.SetLabel(std::string(kernel.name));
+
+    const auto size = static_cast<std::size_t>(state.range(0));
+    const auto grid = makeRandomGrid(size, state.range(1));
+    Grid next{size, size};
+    for (auto _ : state) {
+        stepRows(grid, next, 0, size, kernel.compute_row, highlife_rule);
+        benchmark::ClobberMemory();
+    }
+    setCounters(state, size * size, 2.0 * sizeof(Cell) * size * size);
+}
+
+static void BM_GridEngineStep(benchmark::State& state) {
+    const auto size = static_cast<std::size_t>(state.range(0));
+    GridEngine engine{size, size, static_cast<std::size_t>(state.range(2))};
+    engine.load(makeRandomGrid(size, state.range(1)));
+    state.SetLabel(std::to_string(engine.threadCount()) + " threads");
+
+    for (auto _ : state) {
+        engine.step(1);
+    }
+    setCounters(state, size * size, 2.0 * sizeof(Cell) * size * size);
+}
+
+// The same step on cache-sized tiles with a halo, at the tile size picked from
+// the L2 cache.
+static void BM_TiledGridEngineStep(benchmark::State& state) {
+    const auto size = static_cast<std::size_t>(state.range(0));
+    TiledGridEngine engine{size, size, static_cast<std::size_t>(state.range(2))};
+    engine.load(makeRandomGrid(size, state.range(1)));
+    state.SetLabel(std::to_string(engine.threadCount()) + " threads, "
+                   + std::to_string(engine.tileSize().row) + "x"
+                   + std::to_string(engine.tileSize().col) + " tiles");
+
+    for (auto _ : state) {
+        engine.step(1);
+    }
+    setCounters(state, size * size, 2.0 * sizeof(Cell) * size * size);
+}
+
+// Boards with rows of up to 8 MiB, stepped by the row sweep (0) and in
+// square tiles (1).
+static void BM_WideBoardStep(benchmark::State& state) {
+    constexpr std::size_t rows = 32;
+    const auto columns = static_cast<std::size_t>(state.range(0));
+    std::unique_ptr<GridEngine> engine;
+    if (state.range(1) == 0) {
+        engine = std::make_unique<GridEngine>(rows, columns);
+    } else {
+        engine = std::make_unique<TiledGridEngine>(rows, columns);
+    }
+    Grid grid{rows, columns};
+    fillRandom(grid, 0.3, 1);
+    engine->load(grid);
+    state.SetLabel(std::string(engine->name()));
+
+    for (auto _ : state) {
+        engine->step(1);
+    }
+    setCounters(state, rows * columns, 2.0 * sizeof(Cell) * rows * columns);
+}
+
+static void BM_ActiveTileEngineStep(benchmark::State& state) {
+    const auto size = static_cast<std::size_t>(state.range(0));
+    ActiveTileEngine engine{size, size};
+    engine.load(makeRandomGrid(size, state.range(1)));
+
+    std::size_t active_tiles = 0;
+    for (auto _ : state) {
+        engine.step(1);
+        active_tiles += engine.activeTileCount();
+    }
+    setCounters(state, size * size, 2.0 * sizeof(Cell) * size * size);
+    state.counters["active tiles"] = benchmark::Counter(
+        static_cast<double>(active_tiles), benchmark::Counter::kAvgIterations);
+}
+
+static void BM_PackedGridStep(benchmark::State& state) {
+    const auto size = static_cast<std::size_t>(state.range(0));
+    PackedGrid current{makeRandomGrid(size, state.range(1))};
+    PackedGrid next{size, size};
+    for (auto _ : state) {
+        current.step(next);
+        std::swap(current, next);
+    }
+    setCounters(state,
+                size * size,
+                2.0 * sizeof(PackedGrid::Word) * current.wordsPerRow() * size);
+}
+
+static void BM_SparseTileEngineStep(benchmark::State& state) {
+    const auto size = static_cast<std::size_t>(state.range(0));
+    SparseTileEngine engine;
+    engine.load(makeRandomGrid(size, state.range(1)));
+    for (auto _ : state) {
+        engine.step(1);
+    }
+    const auto memory = engine.pooledTileCount()
+                        * (2 * sizeof(Cell) * SparseTileEngine::tile_size
+                           * SparseTileEngine::tile_size);
+    setCounters(state, size * size, static_cast<double>(memory));
+}
+
+static void BM_HashLifeStep(benchmark::State& state) {
+    const auto size = static_cast<std::size_t>(state.range(0));
+    HashLifeEngine engine;
+    engine.load(makeRandomGrid(size, state.range(1)));
+    for (auto _ : state) {
+        engine.step(1);
+    }
+    setCounters(state, size * size, static_cast<double>(engine.memoryUsage()));
+}
+
+// Keeping the zoomed out view of a board up to date after every step, which
+// only touches the blocks above cells that changed.
+static void BM_DensityPyramidUpdate(benchmark::State& state) {
+    const auto size = static_cast<std::size_t>(state.range(0));
+    GridEngine engine{size, size};
+    engine.load(makeRandomGrid(size, state.range(1)));
+    DensityPyramid pyramid{size, size};
+    Grid cells{size, size};
+    pyramid.update(cells, engine.current());
+    for (auto _ : state) {
+        state.PauseTiming();
+        engine.step(1);
+        state.ResumeTiming();
+        pyramid.update(cells, engine.current());
+    }
+    setCounters(state, size * size, static_cast<double>(sizeof(Cell) * size * size));
+}
+
+// A batch of independent 256^2 boards spread over a work-stealing pool, which
+// should scale with the number of threads.
+static void BM_Ensemble(benchmark::State& state) {
+    constexpr std::size_t size = 256;
+    std::vector<EnsembleJob> jobs;
+    for (std::uint64_t seed = 0; seed < 32; seed++) {
+        jobs.push_back({.size = {size, size},
+                        .density = 0.35,
+                        .seed = seed,
+                        .max_generations = 500});
+    }
+    const auto threads = static_cast<std::size_t>(state.range(0));
+    std::uint64_t generations = 0;
+    for (auto _ : state) {
+        runEnsemble(jobs, threads, life_rule, [&](const EnsembleResult& result) {
+            generations += result.generations;
+        });
+    }
+    state.counters["boards/s"] = benchmark::Counter(
+        static_cast<double>(jobs.size() * state.iterations()), benchmark::Counter::kIsRate);
+    state.counters["cells/s"] = benchmark::Counter(
+        static_cast<double>(generations * size * size), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_GetPeriodicIndex);
+// The reference implementation is too slow to sweep the largest boards.
+BENCHMARK(BM_CheckCell)->Apply([](benchmark::internal::Benchmark* bench) {
+    applyArgs(bench, 4096);
+});
+BENCHMARK(BM_RowKernel)->Apply([](benchmark::internal::Benchmark* bench) {
+    std::vector<std::int64_t> kernels(getAvailableKernels().size());
+    std::iota(kernels.begin(), kernels.end(), 0);
+    applyArgs(bench, 16384, kernels, "kernel");
+});
+BENCHMARK(BM_HighLifeKernel)->Apply([](benchmark::internal::Benchmark* bench) {
+    std::vector<std::int64_t> kernels(getAvailableKernels(highlife_rule).size()
+                                      + getTableKernels().size());
+    std::iota(kernels.begin(), kernels.end(), 0);
+    applyArgs(bench, 4096, kernels, "kernel");
+});
+// Zero threads uses every hardware thread.
+BENCHMARK(BM_GridEngineStep)->Apply([](benchmark::internal::Benchmark* bench) {
+    applyArgs(bench, 16384, {1, 0}, "threads");
+});
+BENCHMARK(BM_TiledGridEngineStep)->Apply([](benchmark::internal::Benchmark* bench) {
+    applyArgs(bench, 16384, {1, 0}, "threads");
+});
+BENCHMARK(BM_WideBoardStep)
+    ->ArgNames({"columns", "tiled"})
+    ->ArgsProduct({{1 << 16, 1 << 20, 1 << 23}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ActiveTileEngineStep)->Apply([](benchmark::internal::Benchmark* bench) {
+    applyArgs(bench, 16384);
+});
+BENCHMARK(BM_PackedGridStep)->Apply([](benchmark::internal::Benchmark* bench) {
+    applyArgs(bench, 16384);
+});
+BENCHMARK(BM_SparseTileEngineStep)->Apply([](benchmark::internal::Benchmark* bench) {
+    applyArgs(bench, 4096);
+});
+BENCHMARK(BM_DensityPyramidUpdate)->Apply([](benchmark::internal::Benchmark* bench) {
+    applyArgs(bench, 4096);
+});
+// HashLife memoizes structure, not random noise: on large random boards it
+// only measures its table overhead.
+BENCHMARK(BM_HashLifeStep)->Apply([](benchmark::internal::Benchmark* bench) {
+    applyArgs(bench, 1024);
+});
+BENCHMARK(BM_Ensemble)->ArgName("threads")->Arg(1)->Arg(2)->Arg(4)->Arg(0)->UseRealTime();
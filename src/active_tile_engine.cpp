@@ -0,0 +1,164 @@
+#include "active_tile_engine.h"
+#include "zobrist.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+
+ActiveTileEngine::ActiveTileEngine(std::size_t rows,
+                                   std::size_t columns,
+                                   std::size_t threads,
+                                   std::size_t tile_size,
+                                   const Rule& rule)
+    : GridEngine{rows, columns, threads, rule}
+    , tile_size_{tile_size}
+    , tile_rows_{(rows + tile_size - 1) / tile_size}
+    , tile_columns_{(columns + tile_size - 1) / tile_size}
+    , changed_(tile_rows_ * tile_columns_, 1)
+    , next_changed_(tile_rows_ * tile_columns_, 0)
+    , is_active_(tile_rows_ * tile_columns_, 0) {
+    assert(tile_size > 0);
+}
+
+void ActiveTileEngine::step(std::uint64_t generations) {
+    const auto kernel = getDefaultKernel(rule_).compute_row;
+
+    for (std::uint64_t gen = 0; gen < generations; gen++) {
+        collectActiveTiles();
+        std::fill(next_changed_.begin(), next_changed_.end(), 0);
+
+        std::atomic<std::uint64_t> changes = 0;
+        thread_pool_.parallelFor(
+            active_tile_rows_.size(), [&](std::size_t begin, std::size_t end) {
+                std::uint64_t band_changes = 0;
+                for (auto i = begin; i < end; i++) {
+                    band_changes ^= computeTileRow(active_tile_rows_[i], kernel);
+                }
+                changes.fetch_xor(band_changes, std::memory_order_relaxed);
+            });
+
+        hash_ ^= changes.load(std::memory_order_relaxed);
+        generations_.flip();
+        std::swap(changed_, next_changed_);
+        generation_++;
+    }
+}
+
+void ActiveTileEngine::collectActiveTiles() {
+    // Shifting by count - 1 modulo count steps back with wrap-around.
+    const std::size_t row_shifts[] = {tile_rows_ - 1, 0, 1};
+    const std::size_t col_shifts[] = {tile_columns_ - 1, 0, 1};
+
+    std::fill(is_active_.begin(), is_active_.end(), 0);
+    for (std::size_t tile_row = 0; tile_row < tile_rows_; tile_row++) {
+        for (std::size_t tile_col = 0; tile_col < tile_columns_; tile_col++) {
+            if (!changed_[tile_row * tile_columns_ + tile_col]) {
+                continue;
+            }
+            for (const auto row_shift : row_shifts) {
+                for (const auto col_shift : col_shifts) {
+                    const auto row = (tile_row + row_shift) % tile_rows_;
+                    const auto col = (tile_col + col_shift) % tile_columns_;
+                    is_active_[row * tile_columns_ + col] = 1;
+                }
+            }
+        }
+    }
+
+    active_tile_rows_.clear();
+    active_tile_count_ = 0;
+    for (std::size_t tile_row = 0; tile_row < tile_rows_; tile_row++) {
+        const auto first = is_active_.begin() + tile_row * tile_columns_;
+        const auto count
+            = static_cast<std::size_t>(std::count(first, first + tile_columns_, 1));
+        if (count > 0) {
+            active_tile_rows_.push_back(tile_row);
+            active_tile_count_ += count;
+        }
+    }
+}
+
+std::uint64_t ActiveTileEngine::computeTileRow(std::size_t tile_row, RowKernel kernel) {
+    const auto& current = generations_.current();
+    auto& next = generations_.next();
+    const auto rows = current.rows();
+    const auto columns = current.columns();
+
+    const auto* is_active = is_active_.data() + tile_row * tile_columns_;
+    auto* changed = next_changed_.data() + tile_row * tile_columns_;
+
+    std::uint64_t changes = 0;
+    const auto first_row = tile_row * tile_size_;
+    const auto last_row = std::min(first_row + tile_size_, rows);
+    for (auto i = first_row; i < last_row; i++) {
+        const auto* up = current.row(i == 0 ? rows - 1 : i - 1);
+        const auto* mid = current.row(i);
+        const auto* down = current.row(i == rows - 1 ? 0 : i + 1);
+        auto* out = next.row(i);
+
+        for (std::size_t tile_col = 0; tile_col < tile_columns_;) {
+            if (!is_active[tile_col]) {
+                tile_col++;
+                continue;
+            }
+            auto span_end = tile_col;
+            while (span_end < tile_columns_ && is_active[span_end]) {
+                span_end++;
+            }
+
+            const auto first_col = tile_col * tile_size_;
+            const auto last_col = std::min(span_end * tile_size_, columns);
+            kernel(up, mid, down, out, columns, first_col, last_col, rule_);
+            if (is_hashing_) {
+                changes ^= hashRowChanges(
+                    mid, out, first_col, last_col, static_cast<std::int64_t>(i));
+            }
+
+            for (; tile_col < span_end; tile_col++) {
+                if (changed[tile_col]) {
+                    continue;
+                }
+                const auto tile_first_col = tile_col * tile_size_;
+                const auto width = std::min(tile_size_, columns - tile_first_col);
+                changed[tile_col] = std::memcmp(mid + tile_first_col,
+                                                out + tile_first_col,
+                                                width * sizeof(Cell))
+                                    != 0;
+            }
+        }
+    }
+    return changes;
+}
+
+void ActiveTileEngine::set(Index ind, bool alive) {
+    GridEngine::set(ind, alive);
+    changed_[getTile(ind)] = 1;
+}
+
+void ActiveTileEngine::markEdited(Index origin, Index extent) {
+    const auto size = current().getSize();
+    forEachSpan(size, origin, extent, [&](Index cell, Index, std::size_t count) {
+        // Only the first row of the rectangle in each row of tiles is needed.
+        if (cell.row % tile_size_ != 0 && cell.row != origin.row % size.row) {
+            return;
+        }
+        for (auto col = cell.col; col < cell.col + count; col += tile_size_) {
+            changed_[getTile({cell.row, col})] = 1;
+        }
+        changed_[getTile({cell.row, cell.col + count - 1})] = 1;
+    });
+}
+
+void ActiveTileEngine::load(const Grid& grid) {
+    GridEngine::load(grid);
+    std::fill(changed_.begin(), changed_.end(), 1);
+}
+
+std::size_t ActiveTileEngine::memoryUsage() const {
+    return GridEngine::memoryUsage() + changed_.capacity() + next_changed_.capacity()
+           + is_active_.capacity() + active_tile_rows_.capacity() * sizeof(std::size_t);
+}
+
+void ActiveTileEngine::printStatistics(std::ostream& out) const {
+    out << "active tiles: " << activeTileCount() << " / " << tileCount() << '\n';
+}
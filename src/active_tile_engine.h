@@ -0,0 +1,68 @@
+#pragma once
+
+#include "grid_engine.h"
+#include "step_kernels.h"
+#include <cstdint>
+#include <vector>
+
+// Grid engine that only recomputes the tiles whose neighbourhood changed in
+// the previous generation, wrap-around included. A tile that was skipped
+// already holds the right cells in the back buffer: it did not change in the
+// previous generation either, so both buffers agree on it.
+class ActiveTileEngine : public GridEngine {
+public:
+    static constexpr std::size_t default_tile_size = 64;
+
+    ActiveTileEngine(std::size_t rows,
+                     std::size_t columns,
+                     std::size_t threads = 1,
+                     std::size_t tile_size = default_tile_size,
+                     const Rule& rule = life_rule);
+
+    std::string_view name() const override { return "active"; }
+
+    void step(std::uint64_t generations) override;
+
+    // Skipped tiles are never read, so births and deaths would be free, but
+    // the bounding box would need a pass over the board of its own.
+    bool trackStatistics() override { return false; }
+
+    void set(Index ind, bool alive) override;
+    void load(const Grid& grid) override;
+
+    std::size_t memoryUsage() const override;
+    void printStatistics(std::ostream& out) const override;
+
+    std::size_t tileSize() const { return tile_size_; }
+    std::size_t tileCount() const { return tile_rows_ * tile_columns_; }
+
+    // Number of tiles recomputed by the last step.
+    std::size_t activeTileCount() const { return active_tile_count_; }
+
+protected:
+    void markEdited(Index origin, Index extent) override;
+
+private:
+    std::size_t getTile(Index ind) const {
+        return ind.row / tile_size_ * tile_columns_ + ind.col / tile_size_;
+    }
+
+    void collectActiveTiles();
+
+    // Recomputes the active tiles of one row of tiles. Runs of adjacent active
+    // tiles are computed row by row as one span to keep memory access
+    // sequential, then every tile is compared to its previous generation.
+    // Returns the change of the hash if it is tracked.
+    std::uint64_t computeTileRow(std::size_t tile_row, RowKernel kernel);
+
+    std::size_t tile_size_;
+    std::size_t tile_rows_;
+    std::size_t tile_columns_;
+
+    // Per tile flags, one byte each so that threads can write them freely.
+    std::vector<std::uint8_t> changed_;
+    std::vector<std::uint8_t> next_changed_;
+    std::vector<std::uint8_t> is_active_;
+    std::vector<std::size_t> active_tile_rows_;
+    std::size_t active_tile_count_ = 0;
+};
@@ -0,0 +1,158 @@
+#include "board_statistics.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace {
+
+static_assert(sizeof(Cell) == 1);
+constexpr std::size_t word_cells = sizeof(std::uint64_t);
+// Byte lanes of a word of cells overflow after this many words are added.
+constexpr std::size_t max_lane_words = 255;
+
+std::uint64_t loadWord(const Cell* cells) {
+    std::uint64_t word;
+    std::memcpy(&word, cells, word_cells);
+    return word;
+}
+
+// Sum of the eight byte lanes of a word.
+std::uint64_t sumLanes(std::uint64_t word) {
+    word = (word & 0x00ff00ff00ff00ffULL) + ((word >> 8) & 0x00ff00ff00ff00ffULL);
+    return (word * 0x0001000100010001ULL) >> 48;
+}
+
+// Offsets of the first and the last live cell in a word of cells with at
+// least one.
+std::size_t getFirstCell(std::uint64_t word) {
+    if constexpr (std::endian::native == std::endian::little) {
+        return static_cast<std::size_t>(std::countr_zero(word)) / 8;
+    } else {
+        return static_cast<std::size_t>(std::countl_zero(word)) / 8;
+    }
+}
+
+std::size_t getLastCell(std::uint64_t word) {
+    if constexpr (std::endian::native == std::endian::little) {
+        return word_cells - 1 - static_cast<std::size_t>(std::countl_zero(word)) / 8;
+    } else {
+        return word_cells - 1 - static_cast<std::size_t>(std::countr_zero(word)) / 8;
+    }
+}
+
+// First live cell of [first, last), of a range with at least one.
+std::size_t findFirstLive(const Cell* cells, std::size_t first, std::size_t last) {
+    auto j = first;
+    for (; j + word_cells <= last; j += word_cells) {
+        if (const auto word = loadWord(cells + j); word != 0) {
+            return j + getFirstCell(word);
+        }
+    }
+    while (!cells[j].data) {
+        j++;
+    }
+    return j;
+}
+
+// One past the last live cell of [first, last), of a range with at least one.
+std::size_t findLastLive(const Cell* cells, std::size_t first, std::size_t last) {
+    auto j = last;
+    for (; j >= first + word_cells; j -= word_cells) {
+        if (const auto word = loadWord(cells + j - word_cells); word != 0) {
+            return j - word_cells + getLastCell(word) + 1;
+        }
+    }
+    while (!cells[j - 1].data) {
+        j--;
+    }
+    return j;
+}
+
+}
+
+void BoardStatistics::includeBounds(Index first_cell, Index last_cell) {
+    if (first_cell.row >= last_cell.row || first_cell.col >= last_cell.col) {
+        return;
+    }
+    if (!hasBounds()) {
+        first = first_cell;
+        last = last_cell;
+        return;
+    }
+    first = {std::min(first.row, first_cell.row), std::min(first.col, first_cell.col)};
+    last = {std::max(last.row, last_cell.row), std::max(last.col, last_cell.col)};
+}
+
+void BoardStatistics::merge(const BoardStatistics& part) {
+    population += part.population;
+    births += part.births;
+    deaths += part.deaths;
+    includeBounds(part.first, part.last);
+}
+
+void addRowCounts(const RowCounts& row_counts,
+                  const Cell* cells,
+                  std::size_t first,
+                  std::size_t last,
+                  std::size_t row,
+                  BoardStatistics& counts) {
+    counts.population += row_counts.population;
+    counts.births += row_counts.births;
+    counts.deaths += row_counts.deaths;
+    if (row_counts.population > 0) {
+        counts.includeBounds({row, findFirstLive(cells, first, last)},
+                             {row + 1, findLastLive(cells, first, last)});
+    }
+}
+
+void countRowChanges(const Cell* before,
+                     const Cell* after,
+                     std::size_t first,
+                     std::size_t last,
+                     std::size_t row,
+                     BoardStatistics& counts) {
+    // Cells are 0 or 1, so adding whole words counts eight cells at once in
+    // the byte lanes, which are summed before they can overflow.
+    RowCounts row_counts;
+    auto j = first;
+    while (j + word_cells <= last) {
+        const auto words = std::min((last - j) / word_cells, max_lane_words);
+        std::uint64_t alive_lanes = 0;
+        std::uint64_t born_lanes = 0;
+        std::uint64_t died_lanes = 0;
+        for (std::size_t k = 0; k < words; k++, j += word_cells) {
+            const auto before_word = loadWord(before + j);
+            const auto after_word = loadWord(after + j);
+            alive_lanes += after_word;
+            born_lanes += after_word & ~before_word;
+            died_lanes += before_word & ~after_word;
+        }
+        row_counts.population += sumLanes(alive_lanes);
+        row_counts.births += sumLanes(born_lanes);
+        row_counts.deaths += sumLanes(died_lanes);
+    }
+    for (; j < last; j++) {
+        row_counts.population += after[j].data;
+        row_counts.births += after[j].data && !before[j].data;
+        row_counts.deaths += before[j].data && !after[j].data;
+    }
+    addRowCounts(row_counts, after, first, last, row, counts);
+}
+
+BoardStatistics countGrid(const Grid& grid) {
+    BoardStatistics counts;
+    for (std::size_t i = 0; i < grid.rows(); i++) {
+        countRowChanges(grid.row(i), grid.row(i), 0, grid.columns(), i, counts);
+    }
+    return counts;
+}
+
+void writeStatisticsCsvHeader(std::ostream& out) {
+    out << "generation,population,births,deaths,first_row,first_col,last_row,last_col\n";
+}
+
+void writeStatisticsCsvRow(std::ostream& out, const BoardStatistics& counts) {
+    out << counts.generation << ',' << counts.population << ',' << counts.births << ','
+        << counts.deaths << ',' << counts.first.row << ',' << counts.first.col << ','
+        << counts.last.row << ',' << counts.last.col << '\n';
+}
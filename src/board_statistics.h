@@ -0,0 +1,61 @@
+#pragma once
+
+#include "grid.h"
+#include "step_kernels.h"
+#include <cstdint>
+#include <ostream>
+
+// Counts of a generation of a bounded board. The grid engines keep them up to
+// date as a byproduct of stepping, see Engine::trackStatistics().
+struct BoardStatistics {
+    std::uint64_t generation = 0;
+    std::uint64_t population = 0;
+    // Cells that came alive and died in the step to `generation`.
+    std::uint64_t births = 0;
+    std::uint64_t deaths = 0;
+    // Rows and columns [first, last) of the smallest rectangle holding every
+    // live cell, empty if there are none.
+    Index first{0, 0};
+    Index last{0, 0};
+
+    bool hasBounds() const { return first.row < last.row && first.col < last.col; }
+
+    // Grows the bounding box to hold the rectangle [first, last).
+    void includeBounds(Index first, Index last);
+    // Whether the rectangle [first, last) reaches an edge of the bounding box,
+    // so the box may shrink once its cells die.
+    bool reachesBounds(Index first, Index last) const {
+        return first.row == this->first.row || first.col == this->first.col
+               || last.row == this->last.row || last.col == this->last.col;
+    }
+
+    // Adds the counts of another part of the same generation, such as the
+    // rows a different thread stepped.
+    void merge(const BoardStatistics& part);
+};
+
+// Adds the counts of cells [first, last) of row `row` that a counting step
+// kernel computed into `cells` to `counts`, and grows its bounding box to hold
+// the live ones. Rows without live cells do not touch the bounding box.
+void addRowCounts(const RowCounts& row_counts,
+                  const Cell* cells,
+                  std::size_t first,
+                  std::size_t last,
+                  std::size_t row,
+                  BoardStatistics& counts);
+
+// Like addRowCounts() for a row that was `before` in the previous generation
+// and is `after` now, counted eight cells at a time for edits and loads.
+void countRowChanges(const Cell* before,
+                     const Cell* after,
+                     std::size_t first,
+                     std::size_t last,
+                     std::size_t row,
+                     BoardStatistics& counts);
+
+// Population and bounding box of the whole grid, with no births or deaths.
+BoardStatistics countGrid(const Grid& grid);
+
+// One line per generation: the header, then a row of counts.
+void writeStatisticsCsvHeader(std::ostream& out);
+void writeStatisticsCsvRow(std::ostream& out, const BoardStatistics& counts);
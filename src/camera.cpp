@@ -0,0 +1,46 @@
+#include "camera.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+Camera::Camera(double cell_pixels, double x, double y)
+    : cell_pixels_{cell_pixels}
+    , x_{x}
+    , y_{y} {
+    assert(cell_pixels > 0);
+}
+
+void Camera::drag(double dx, double dy) {
+    x_ -= dx / cell_pixels_;
+    y_ -= dy / cell_pixels_;
+}
+
+void Camera::zoom(int steps, double screen_x, double screen_y, unsigned max_level) {
+    const auto anchor_x = toCellX(screen_x);
+    const auto anchor_y = toCellY(screen_y);
+    const auto min_cell_pixels = std::ldexp(1.0, -static_cast<int>(max_level));
+
+    // Whole pixels change by about a quarter per step, fractions of a pixel
+    // by a factor of two.
+    for (; steps > 0; steps--) {
+        cell_pixels_ = cell_pixels_ < 1
+                           ? cell_pixels_ * 2
+                           : std::max(cell_pixels_ + 1, std::round(cell_pixels_ * 1.25));
+    }
+    for (; steps < 0; steps++) {
+        cell_pixels_ = cell_pixels_ <= 1
+                           ? cell_pixels_ / 2
+                           : std::min(cell_pixels_ - 1, std::round(cell_pixels_ / 1.25));
+    }
+    cell_pixels_ = std::clamp(cell_pixels_, min_cell_pixels, max_cell_pixels);
+
+    x_ = anchor_x - screen_x / cell_pixels_;
+    y_ = anchor_y - screen_y / cell_pixels_;
+}
+
+unsigned Camera::level() const {
+    if (cell_pixels_ >= 1) {
+        return 0;
+    }
+    return static_cast<unsigned>(std::lround(-std::log2(cell_pixels_)));
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdlib>
+
+// Maps screen pixels to board cells for a view that can be moved and zoomed.
+// Zoomed in, a cell covers a whole number of pixels so the grid lines stay
+// sharp; zoomed out, a pixel covers a power of two cells so it matches one
+// texel of a DensityPyramid level.
+class Camera {
+public:
+    static constexpr double max_cell_pixels = 256;
+
+    // Starts with the cell (x, y) at the upper left corner of the screen.
+    explicit Camera(double cell_pixels, double x = 0, double y = 0);
+
+    double cellPixels() const { return cell_pixels_; }
+    double x() const { return x_; }
+    double y() const { return y_; }
+
+    // Moves the view so that the content follows a drag by (dx, dy) pixels.
+    void drag(double dx, double dy);
+
+    // Zooms in for positive steps and out for negative ones, keeping the cell
+    // under the screen point in place. Never zooms out beyond a pixel per
+    // 2^max_level cells.
+    void zoom(int steps, double screen_x, double screen_y, unsigned max_level);
+
+    double toCellX(double screen_x) const { return x_ + screen_x / cell_pixels_; }
+    double toCellY(double screen_y) const { return y_ + screen_y / cell_pixels_; }
+    double toScreenX(double cell_x) const { return (cell_x - x_) * cell_pixels_; }
+    double toScreenY(double cell_y) const { return (cell_y - y_) * cell_pixels_; }
+
+    // The pyramid level whose texels cover one pixel each, 0 zoomed in.
+    unsigned level() const;
+
+private:
+    double cell_pixels_;
+    double x_;
+    double y_;
+};
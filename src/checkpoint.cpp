@@ -0,0 +1,310 @@
+#include "checkpoint.h"
+#include "little_endian.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+// A checkpoint file starts with the magic "GOLCKPT1" and the rows and columns
+// of the board. Records follow, each a kind, a generation and a payload size
+// in words, then the payload. All words are little-endian 64-bit. A full
+// record holds the board in the PackedGrid layout, a delta record a list of
+// block indices, each followed by the XOR of that block with the previous
+// checkpoint.
+
+namespace {
+
+using Word = PackedGrid::Word;
+
+constexpr std::string_view magic = "GOLCKPT1";
+constexpr std::size_t header_size = magic.size() + 2 * sizeof(Word);
+constexpr std::size_t record_header_size = 3 * sizeof(Word);
+constexpr std::size_t block_words = 8;
+
+enum RecordKind : Word { full_record = 0, delta_record = 1 };
+
+void writeWords(std::ostream& out, const Word* words, std::size_t count) {
+    if constexpr (std::endian::native == std::endian::little) {
+        out.write(reinterpret_cast<const char*>(words),
+                  static_cast<std::streamsize>(count * sizeof(Word)));
+    } else {
+        for (std::size_t i = 0; i < count; i++) {
+            const auto word = toLittleEndian(words[i]);
+            out.write(reinterpret_cast<const char*>(&word), sizeof(word));
+        }
+    }
+}
+
+void writeRecordHeader(std::ostream& out,
+                       RecordKind kind,
+                       std::uint64_t generation,
+                       std::size_t payload_words) {
+    const Word header[] = {kind, generation, payload_words};
+    writeWords(out, header, std::size(header));
+}
+
+std::size_t getWordsPerRow(std::size_t columns) {
+    return (columns + PackedGrid::word_bits - 1) / PackedGrid::word_bits;
+}
+
+}  // namespace
+
+CheckpointWriter::CheckpointWriter(std::string path, std::size_t compaction_interval)
+    : path_{std::move(path)}
+    , compaction_interval_{compaction_interval}
+    , thread_{[this] { run(); }} {}
+
+CheckpointWriter::~CheckpointWriter() {
+    {
+        const std::lock_guard lock{mutex_};
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+void CheckpointWriter::save(const Grid& grid, std::uint64_t generation) {
+    const auto start = std::chrono::steady_clock::now();
+
+    std::unique_lock lock{mutex_};
+    waitForWriter(lock);
+    lock.unlock();
+
+    // The writer is idle until is_pending_ is set, staged_ is ours.
+    const auto words_per_row = getWordsPerRow(grid.columns());
+    staged_.resize(grid.rows() * words_per_row);
+    for (std::size_t i = 0; i < grid.rows(); i++) {
+        packCells(grid.row(i), grid.columns(), staged_.data() + i * words_per_row);
+    }
+    staged_size_ = grid.getSize();
+    staged_generation_ = generation;
+
+    const auto stall = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+    lock.lock();
+    is_pending_ = true;
+    statistics_.stall_seconds += stall;
+    statistics_.max_stall_seconds = std::max(statistics_.max_stall_seconds, stall);
+    lock.unlock();
+    cv_.notify_all();
+}
+
+void CheckpointWriter::flush() {
+    std::unique_lock lock{mutex_};
+    waitForWriter(lock);
+}
+
+CheckpointWriter::Statistics CheckpointWriter::statistics() const {
+    const std::lock_guard lock{mutex_};
+    return statistics_;
+}
+
+void CheckpointWriter::printStatistics(std::ostream& out) const {
+    const auto stats = statistics();
+    const auto average_stall = stats.checkpoints > 0
+                                   ? stats.stall_seconds / stats.checkpoints
+                                   : 0.0;
+    out << "checkpoints: " << stats.checkpoints << " (" << stats.full_checkpoints
+        << " full), " << stats.bytes_written / (1024.0 * 1024.0) << " MiB written\n"
+        << "checkpoint stall: " << average_stall * 1000 << " ms average, "
+        << stats.max_stall_seconds * 1000 << " ms max\n";
+}
+
+void CheckpointWriter::waitForWriter(std::unique_lock<std::mutex>& lock) {
+    cv_.wait(lock, [this] { return !is_pending_; });
+    if (error_) {
+        std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+}
+
+void CheckpointWriter::run() {
+    while (true) {
+        std::unique_lock lock{mutex_};
+        cv_.wait(lock, [this] { return stopping_ || is_pending_; });
+        if (!is_pending_) {
+            return;
+        }
+        lock.unlock();
+
+        std::exception_ptr error;
+        try {
+            write();
+        } catch (...) {
+            error = std::current_exception();
+            // The file may end in a partial record now, start over with a full
+            // checkpoint rather than appending deltas behind it.
+            written_size_ = {0, 0};
+        }
+
+        lock.lock();
+        error_ = error;
+        is_pending_ = false;
+        lock.unlock();
+        cv_.notify_all();
+    }
+}
+
+void CheckpointWriter::write() {
+    const bool is_same_size = staged_size_.row == written_size_.row
+                              && staged_size_.col == written_size_.col;
+    if (!is_same_size || deltas_since_full_ + 1 >= compaction_interval_) {
+        writeFull();
+    } else {
+        std::vector<Word> delta;
+        for (std::size_t first = 0; first < staged_.size(); first += block_words) {
+            const auto count = std::min(block_words, staged_.size() - first);
+            if (std::equal(staged_.begin() + first,
+                           staged_.begin() + first + count,
+                           written_.begin() + first)) {
+                continue;
+            }
+            delta.push_back(first / block_words);
+            for (std::size_t i = first; i < first + count; i++) {
+                delta.push_back(staged_[i] ^ written_[i]);
+            }
+            if (delta.size() >= staged_.size()) {
+                break;
+            }
+        }
+
+        if (delta.size() >= staged_.size()) {
+            writeFull();
+        } else {
+            writeDelta(delta);
+        }
+    }
+
+    written_.swap(staged_);
+    written_size_ = staged_size_;
+
+    const std::lock_guard lock{mutex_};
+    statistics_.checkpoints++;
+}
+
+void CheckpointWriter::writeFull() {
+    // Written next to the checkpoint and renamed over it, so a crash leaves
+    // either the old or the new file behind.
+    const auto temporary_path = path_ + ".tmp";
+    {
+        std::ofstream out{temporary_path, std::ios::binary | std::ios::trunc};
+        if (!out) {
+            throw std::runtime_error("could not open checkpoint file " + temporary_path);
+        }
+        out.write(magic.data(), magic.size());
+        const Word size[] = {staged_size_.row, staged_size_.col};
+        writeWords(out, size, std::size(size));
+        writeRecordHeader(out, full_record, staged_generation_, staged_.size());
+        writeWords(out, staged_.data(), staged_.size());
+        if (!out.flush()) {
+            throw std::runtime_error("could not write checkpoint file " + temporary_path);
+        }
+    }
+
+    out_.close();
+    std::filesystem::rename(temporary_path, path_);
+    out_.open(path_, std::ios::binary | std::ios::app);
+    if (!out_) {
+        throw std::runtime_error("could not open checkpoint file " + path_);
+    }
+    deltas_since_full_ = 0;
+
+    const std::lock_guard lock{mutex_};
+    statistics_.full_checkpoints++;
+    statistics_.bytes_written
+        += header_size + record_header_size + staged_.size() * sizeof(Word);
+}
+
+void CheckpointWriter::writeDelta(const std::vector<Word>& delta) {
+    writeRecordHeader(out_, delta_record, staged_generation_, delta.size());
+    writeWords(out_, delta.data(), delta.size());
+    if (!out_.flush()) {
+        throw std::runtime_error("could not write checkpoint file " + path_);
+    }
+    deltas_since_full_++;
+
+    const std::lock_guard lock{mutex_};
+    statistics_.bytes_written += record_header_size + delta.size() * sizeof(Word);
+}
+
+Snapshot readCheckpoint(const std::string& path) {
+    const MappedFile file{path};
+    const auto* data = file.data();
+    const auto* end = data + file.size();
+
+    const auto corrupted = [&path] {
+        return std::runtime_error("checkpoint file " + path + " is corrupted");
+    };
+
+    if (file.size() < header_size
+        || std::memcmp(data, magic.data(), magic.size()) != 0) {
+        throw std::runtime_error(path + " is not a checkpoint file");
+    }
+    const auto rows = readLittleEndian(data + magic.size());
+    const auto columns = readLittleEndian(data + magic.size() + sizeof(Word));
+    const auto words_per_row = getWordsPerRow(columns);
+    if (rows == 0 || columns == 0 || words_per_row > file.size() / rows) {
+        throw corrupted();
+    }
+
+    std::vector<Word> words;
+    std::uint64_t generation = 0;
+    for (const auto* record = data + header_size;
+         static_cast<std::size_t>(end - record) >= record_header_size;) {
+        const auto kind = readLittleEndian(record);
+        const auto record_generation = readLittleEndian(record + sizeof(Word));
+        const auto payload_words = readLittleEndian(record + 2 * sizeof(Word));
+        const auto* payload = record + record_header_size;
+        if (payload_words > static_cast<std::size_t>(end - payload) / sizeof(Word)) {
+            // Cut short while it was being written.
+            break;
+        }
+        const auto readPayload = [payload](std::size_t i) {
+            return readLittleEndian(payload + i * sizeof(Word));
+        };
+
+        if (kind == full_record) {
+            if (payload_words != rows * words_per_row) {
+                throw corrupted();
+            }
+            words.resize(payload_words);
+            for (std::size_t i = 0; i < payload_words; i++) {
+                words[i] = readPayload(i);
+            }
+        } else if (kind == delta_record && !words.empty()) {
+            for (std::size_t i = 0; i < payload_words;) {
+                const auto first = readPayload(i++) * block_words;
+                if (first >= words.size()) {
+                    throw corrupted();
+                }
+                const auto count = std::min(block_words, words.size() - first);
+                if (i + count > payload_words) {
+                    throw corrupted();
+                }
+                for (std::size_t j = 0; j < count; j++) {
+                    words[first + j] ^= readPayload(i++);
+                }
+            }
+        } else {
+            throw corrupted();
+        }
+
+        generation = record_generation;
+        record = payload + payload_words * sizeof(Word);
+    }
+
+    if (words.empty()) {
+        throw std::runtime_error("checkpoint file " + path + " holds no checkpoint");
+    }
+
+    Grid grid{rows, columns};
+    for (std::size_t i = 0; i < rows; i++) {
+        unpackCells(words.data() + i * words_per_row, columns, grid.row(i));
+    }
+    return {std::move(grid), generation};
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "grid.h"
+#include "packed_grid.h"
+#include "snapshot.h"
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Writes checkpoints of a running board into one file on a background thread,
+// so that a long run can be resumed after a crash. The first checkpoint is a
+// full snapshot, the following ones only store the XOR of each block of 512
+// cells that changed since the checkpoint before. Every `compaction_interval`
+// checkpoints, or as soon as a delta would not be smaller, the file is
+// atomically replaced by a single full snapshot again.
+class CheckpointWriter {
+public:
+    static constexpr std::size_t default_compaction_interval = 16;
+
+    struct Statistics {
+        std::uint64_t checkpoints = 0;
+        std::uint64_t full_checkpoints = 0;
+        std::uint64_t bytes_written = 0;
+        // Time spent in save(), which is all a checkpoint adds to the latency
+        // of the step it follows.
+        double stall_seconds = 0;
+        double max_stall_seconds = 0;
+    };
+
+    explicit CheckpointWriter(
+        std::string path,
+        std::size_t compaction_interval = default_compaction_interval);
+    // Finishes writing the last checkpoint.
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    // Packs a copy of `grid` and returns, the checkpoint is written off-thread.
+    // Waits if the previous checkpoint is still being written and rethrows
+    // the error if writing it failed.
+    void save(const Grid& grid, std::uint64_t generation);
+
+    // Waits until the last checkpoint is written.
+    void flush();
+
+    Statistics statistics() const;
+    void printStatistics(std::ostream& out) const;
+
+private:
+    using Word = PackedGrid::Word;
+
+    void run();
+    void write();
+    void writeFull();
+    void writeDelta(const std::vector<Word>& delta);
+    void waitForWriter(std::unique_lock<std::mutex>& lock);
+
+    std::string path_;
+    std::size_t compaction_interval_;
+
+    // The generation being written, packed by save() while the writer is idle,
+    // and the last generation written.
+    std::vector<Word> staged_;
+    Index staged_size_{0, 0};
+    std::uint64_t staged_generation_ = 0;
+    std::vector<Word> written_;
+    Index written_size_{0, 0};
+    std::size_t deltas_since_full_ = 0;
+    std::ofstream out_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool is_pending_ = false;
+    bool stopping_ = false;
+    std::exception_ptr error_;
+    Statistics statistics_;
+
+    std::thread thread_;
+};
+
+// Rebuilds the last complete checkpoint of a checkpoint file. A record cut
+// short by a crash is ignored.
+Snapshot readCheckpoint(const std::string& path);
@@ -0,0 +1,649 @@
+#include "control_server.h"
+#include "little_endian.h"
+#include "pattern.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <expected>
+#include <future>
+#include <mutex>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+struct ControlServer::Mailbox {};
+
+ControlServer::ControlServer(Simulation& simulation, std::string path)
+    : simulation_{simulation}
+    , path_{std::move(path)} {
+    throw std::runtime_error("could not open control socket " + path_
+                             + ": Unix domain sockets are not supported on Windows");
+}
+
+ControlServer::~ControlServer() = default;
+
+void ControlServer::waitForShutdown() {}
+
+#else
+
+namespace {
+
+#if defined(MSG_NOSIGNAL)
+constexpr int send_flags = MSG_NOSIGNAL;
+#else
+// SO_NOSIGPIPE is set on every client socket instead.
+constexpr int send_flags = 0;
+#endif
+
+std::string describeError() { return std::strerror(errno); }
+
+void setNonBlocking(int fd) {
+    const auto flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        throw std::runtime_error("could not make a control socket non-blocking: "
+                                 + describeError());
+    }
+}
+
+// A request line turned into the commands it posts and the reply it is owed.
+struct Request {
+    enum class Reply { generation, stats, region, shutdown };
+
+    Reply reply = Reply::generation;
+    std::vector<Simulation::Command> commands;
+    Index origin{0, 0};
+    Index extent{0, 0};
+    // Whether the reply waits for the generations of `step` to be done.
+    bool waits_for_steps = false;
+    // The pattern file of `load`, read off the server thread before its
+    // command is posted.
+    std::string pattern_path;
+};
+
+std::uint64_t readNumber(std::istringstream& in, const char* what) {
+    std::uint64_t number;
+    if (!(in >> number)) {
+        throw std::runtime_error(std::string{"expected "} + what);
+    }
+    return number;
+}
+
+bool readAlive(std::istringstream& in) {
+    const auto alive = readNumber(in, "0 or 1");
+    if (alive > 1) {
+        throw std::runtime_error("expected 0 or 1");
+    }
+    return alive == 1;
+}
+
+Index readCell(std::istringstream& in, Index view) {
+    const auto row = readNumber(in, "a row");
+    const auto col = readNumber(in, "a column");
+    if (row >= view.row || col >= view.col) {
+        throw std::runtime_error("cell " + std::to_string(row) + " " + std::to_string(col)
+                                 + " is out of the view");
+    }
+    return {row, col};
+}
+
+// Reads "<row> <col> <rows> <columns>" into `origin` and `extent`, which must
+// lie within the view.
+void readRectangle(std::istringstream& in,
+                   Index view,
+                   const std::string& what,
+                   Index& origin,
+                   Index& extent) {
+    origin = readCell(in, view);
+    extent.row = readNumber(in, "a number of rows");
+    extent.col = readNumber(in, "a number of columns");
+    if (extent.row > view.row - origin.row || extent.col > view.col - origin.col) {
+        throw std::runtime_error("the " + what + " is out of the view");
+    }
+}
+
+bool isAtEnd(std::istringstream& in) {
+    in >> std::ws;
+    return in.eof();
+}
+
+Request parseRequest(const std::string& line, Index view) {
+    std::istringstream in{line};
+    std::string verb;
+    in >> verb;
+
+    Request request;
+    if (verb == "run") {
+        if (isAtEnd(in)) {
+            request.commands.emplace_back(Simulation::SetUnthrottled{true});
+        } else {
+            const auto delay = readNumber(in, "a step delay in milliseconds");
+            request.commands.emplace_back(Simulation::SetUnthrottled{false});
+            request.commands.emplace_back(
+                Simulation::SetStepDelay{std::chrono::milliseconds{delay}});
+        }
+        request.commands.emplace_back(Simulation::SetPaused{false});
+    } else if (verb == "pause") {
+        request.commands.emplace_back(Simulation::SetPaused{true});
+    } else if (verb == "step") {
+        request.commands.emplace_back(
+            Simulation::Step{readNumber(in, "a number of generations")});
+        request.waits_for_steps = true;
+    } else if (verb == "set") {
+        Simulation::SetCells cells{.cells = {}, .alive = readAlive(in)};
+        while (!isAtEnd(in)) {
+            cells.cells.push_back(readCell(in, view));
+        }
+        request.commands.emplace_back(std::move(cells));
+    } else if (verb == "fill") {
+        Index origin;
+        Index extent;
+        readRectangle(in, view, "rectangle", origin, extent);
+        request.commands.emplace_back(
+            Simulation::FillCells{origin, extent, readAlive(in)});
+    } else if (verb == "clear") {
+        request.commands.emplace_back(Simulation::ClearBoard{});
+    } else if (verb == "load") {
+        std::getline(in >> std::ws, request.pattern_path);
+        if (request.pattern_path.empty()) {
+            throw std::runtime_error("expected a pattern file");
+        }
+    } else if (verb == "stats") {
+        request.reply = Request::Reply::stats;
+    } else if (verb == "region") {
+        request.reply = Request::Reply::region;
+        readRectangle(in, view, "region", request.origin, request.extent);
+    } else if (verb == "shutdown") {
+        request.reply = Request::Reply::shutdown;
+    } else {
+        throw std::runtime_error("unknown request " + verb);
+    }
+    if (!isAtEnd(in)) {
+        throw std::runtime_error("too many arguments for " + verb);
+    }
+    return request;
+}
+
+// A pattern file, or why it could not be read. Errors are passed on as text,
+// so the exception never leaves the thread reading the file.
+using PatternRead = std::expected<Grid, std::string>;
+
+PatternRead tryReadPattern(const std::string& path) {
+    try {
+        return readPattern(path);
+    } catch (const std::exception& e) {
+        return std::unexpected{e.what()};
+    }
+}
+
+// Copies the `extent` cells at `origin` out of `cells` in the layout of the
+// region reply.
+std::string packRegion(const PackedGrid& cells, Index origin, Index extent) {
+    constexpr auto word_bits = PackedGrid::word_bits;
+    const auto words_per_row = (extent.col + word_bits - 1) / word_bits;
+    std::string region;
+    region.reserve(extent.row * words_per_row * sizeof(PackedGrid::Word));
+    for (std::size_t i = 0; i < extent.row; i++) {
+        const auto* row = cells.row(origin.row + i);
+        for (std::size_t k = 0; k < words_per_row; k++) {
+            const auto first = origin.col + k * word_bits;
+            const auto shift = first % word_bits;
+            auto word = row[first / word_bits] >> shift;
+            if (shift > 0 && first / word_bits + 1 < cells.wordsPerRow()) {
+                word |= row[first / word_bits + 1] << (word_bits - shift);
+            }
+            const auto count = std::min(word_bits, extent.col - k * word_bits);
+            if (count < word_bits) {
+                word &= (PackedGrid::Word{1} << count) - 1;
+            }
+            word = toLittleEndian(word);
+            region.append(reinterpret_cast<const char*>(&word), sizeof(word));
+        }
+    }
+    return region;
+}
+
+}  // namespace
+
+struct ControlServer::Mailbox {
+    Mailbox() {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            throw std::runtime_error("could not open a pipe for the control server: "
+                                     + describeError());
+        }
+        read_fd = fds[0];
+        write_fd = fds[1];
+        setNonBlocking(read_fd);
+        setNonBlocking(write_fd);
+    }
+
+    ~Mailbox() {
+        close(read_fd);
+        close(write_fd);
+    }
+
+    Mailbox(const Mailbox&) = delete;
+    Mailbox& operator=(const Mailbox&) = delete;
+
+    void deliver(std::shared_ptr<const SimulationSnapshot> snapshot) {
+        {
+            const std::lock_guard lock{mutex};
+            snapshots.push_back(std::move(snapshot));
+        }
+        wake();
+    }
+
+    std::vector<std::shared_ptr<const SimulationSnapshot>> take() {
+        const std::lock_guard lock{mutex};
+        return std::exchange(snapshots, {});
+    }
+
+    // Never blocks, a full pipe wakes the server all the same.
+    void wake() {
+        const char byte = 0;
+        if (write(write_fd, &byte, 1) < 0) {
+            return;
+        }
+    }
+
+    void drain() {
+        char buffer[64];
+        while (read(read_fd, buffer, sizeof(buffer)) > 0) {
+        }
+    }
+
+    int read_fd = -1;
+    int write_fd = -1;
+    std::mutex mutex;
+    std::vector<std::shared_ptr<const SimulationSnapshot>> snapshots;
+};
+
+struct ControlServer::Client {
+    explicit Client(int fd)
+        : fd{fd} {}
+
+    ~Client() { close(fd); }
+
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    // Part of a reply still to be written. Text replies own their bytes,
+    // regions spanning whole rows point into the packed cells they keep alive.
+    struct Chunk {
+        std::shared_ptr<const void> owner;
+        const char* data;
+        std::size_t size;
+    };
+
+    void queue(std::string text) {
+        auto owned = std::make_shared<const std::string>(std::move(text));
+        const auto* data = owned->data();
+        const auto size = owned->size();
+        output.push_back({std::move(owned), data, size});
+    }
+
+    // Reads whatever arrived, returns false once the client is done sending.
+    bool receive() {
+        char buffer[64 * 1024];
+        while (true) {
+            const auto count = recv(fd, buffer, sizeof(buffer), 0);
+            if (count > 0) {
+                input.append(buffer, static_cast<std::size_t>(count));
+            } else if (count == 0) {
+                return false;
+            } else if (errno != EINTR) {
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+        }
+    }
+
+    // Writes as much of the output as the socket takes, returns false on
+    // errors.
+    bool send() {
+        while (!output.empty()) {
+            const auto& chunk = output.front();
+            const auto count
+                = ::send(fd, chunk.data + written, chunk.size - written, send_flags);
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+            written += static_cast<std::size_t>(count);
+            if (written == chunk.size) {
+                output.pop_front();
+                written = 0;
+            }
+        }
+        return true;
+    }
+
+    int fd;
+    std::string input;
+    std::deque<Chunk> output;
+    // Bytes of output.front() already written.
+    std::size_t written = 0;
+    // The request waiting for the snapshot with its ticket. Later lines are
+    // left in `input` until it is answered.
+    std::optional<Request> request;
+    std::uint64_t ticket = 0;
+    std::shared_ptr<const SimulationSnapshot> snapshot;
+    // The pattern of a `load` request or why it could not be read, read on a
+    // thread of its own that wakes the server once it is done.
+    std::future<PatternRead> pattern;
+    // Set once the reply to "shutdown" is queued, waitForShutdown() returns
+    // once it is written.
+    bool has_shut_down = false;
+    // Set after a protocol error, the client is dropped once its output is
+    // written.
+    bool is_closing = false;
+    // Set once the client shut down its side, the requests it sent before are
+    // still answered.
+    bool has_hung_up = false;
+    bool is_gone = false;
+
+    bool isDone() const {
+        const bool is_finished
+            = is_closing
+              || (has_hung_up && !request && input.find('\n') == std::string::npos);
+        return is_gone || (is_finished && output.empty());
+    }
+};
+
+ControlServer::ControlServer(Simulation& simulation, std::string path)
+    : simulation_{simulation}
+    , path_{std::move(path)}
+    , mailbox_{std::make_shared<Mailbox>()} {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path_.empty() || path_.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("could not open control socket " + path_
+                                 + ": the path is empty or too long");
+    }
+    std::memcpy(address.sun_path, path_.c_str(), path_.size() + 1);
+
+    // Only a socket is replaced, never a file someone meant to keep.
+    struct stat status;
+    if (lstat(path_.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+        unlink(path_.c_str());
+    }
+
+    listener_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener_ < 0) {
+        throw std::runtime_error("could not open control socket " + path_ + ": "
+                                 + describeError());
+    }
+    if (bind(listener_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+        || listen(listener_, SOMAXCONN) != 0) {
+        const auto reason = describeError();
+        close(listener_);
+        throw std::runtime_error("could not open control socket " + path_ + ": "
+                                 + reason);
+    }
+    try {
+        setNonBlocking(listener_);
+    } catch (...) {
+        close(listener_);
+        unlink(path_.c_str());
+        throw;
+    }
+    thread_ = std::thread{[this] { run(); }};
+}
+
+ControlServer::~ControlServer() {
+    stopping_ = true;
+    mailbox_->wake();
+    thread_.join();
+    close(listener_);
+    unlink(path_.c_str());
+}
+
+void ControlServer::waitForShutdown() {
+    std::unique_lock lock{mutex_};
+    shutdown_cv_.wait(lock, [this] { return is_shut_down_; });
+}
+
+void ControlServer::run() {
+    std::vector<std::unique_ptr<Client>> clients;
+    std::vector<pollfd> fds;
+    std::uint64_t next_ticket = 1;
+
+    const auto answer = [&](Client& client, const SimulationSnapshot& snapshot) {
+        const auto& request = *client.request;
+        auto reply = "ok " + std::to_string(snapshot.generation);
+        if (request.reply == Request::Reply::stats) {
+            const auto& statistics = snapshot.statistics;
+            reply += " population " + std::to_string(snapshot.population);
+            if (statistics) {
+                reply += " births " + std::to_string(statistics->births) + " deaths "
+                         + std::to_string(statistics->deaths) + " bounds "
+                         + std::to_string(statistics->first.row) + " "
+                         + std::to_string(statistics->first.col) + " "
+                         + std::to_string(statistics->last.row) + " "
+                         + std::to_string(statistics->last.col);
+            }
+        } else if (request.reply == Request::Reply::region) {
+            const auto& cells = *snapshot.cells;
+            constexpr auto word_bits = PackedGrid::word_bits;
+            const auto words_per_row = (request.extent.col + word_bits - 1) / word_bits;
+            const auto bytes
+                = request.extent.row * words_per_row * sizeof(PackedGrid::Word);
+            reply += " " + std::to_string(request.extent.row) + " "
+                     + std::to_string(request.extent.col) + " " + std::to_string(bytes);
+            client.queue(reply + "\n");
+            const bool is_whole_rows = request.origin.col == 0
+                                       && request.extent.col == cells.columns()
+                                       && std::endian::native == std::endian::little;
+            if (bytes > 0 && is_whole_rows) {
+                client.output.push_back(
+                    {snapshot.cells,
+                     reinterpret_cast<const char*>(cells.row(request.origin.row)),
+                     bytes});
+            } else if (bytes > 0) {
+                client.queue(packRegion(cells, request.origin, request.extent));
+            }
+            return;
+        } else if (request.reply == Request::Reply::shutdown) {
+            client.has_shut_down = true;
+        }
+        client.queue(reply + "\n");
+    };
+
+    // Posts the commands of `request` and the Acknowledge its reply waits for.
+    const auto post = [&](Client& client, Request request) {
+        for (auto& command : request.commands) {
+            simulation_.post(std::move(command));
+        }
+        request.commands.clear();
+        client.ticket = next_ticket++;
+        // Only regions need the cells packed.
+        simulation_.post(Simulation::Acknowledge{
+            .ticket = client.ticket,
+            .on_published = [mailbox = mailbox_](const auto& snapshot) {
+                mailbox->deliver(snapshot);
+            },
+            .with_cells = request.reply == Request::Reply::region,
+            .waits_for_steps = request.waits_for_steps});
+        client.request = std::move(request);
+    };
+
+    // Answers the request of `client` if its snapshot is out, then posts the
+    // commands of its next line.
+    const auto serve = [&](Client& client) {
+        while (!client.is_closing) {
+            if (client.pattern.valid()) {
+                if (client.pattern.wait_for(std::chrono::seconds{0})
+                    != std::future_status::ready) {
+                    return;
+                }
+                auto request = std::move(*client.request);
+                client.request.reset();
+                auto pattern = client.pattern.get();
+                if (pattern) {
+                    request.commands.emplace_back(
+                        Simulation::LoadPattern{std::move(*pattern)});
+                    post(client, std::move(request));
+                } else {
+                    client.queue("error " + pattern.error() + "\n");
+                }
+                continue;
+            }
+            if (client.request) {
+                if (!client.snapshot) {
+                    return;
+                }
+                answer(client, *client.snapshot);
+                client.request.reset();
+                client.snapshot.reset();
+            }
+
+            const auto end = client.input.find('\n');
+            if (end == std::string::npos) {
+                if (client.input.size() > max_line_bytes) {
+                    client.queue("error request longer than "
+                                 + std::to_string(max_line_bytes) + " bytes\n");
+                    client.is_closing = true;
+                }
+                return;
+            }
+            auto line = client.input.substr(0, end);
+            client.input.erase(0, end + 1);
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.find_first_not_of(" \t") == std::string::npos) {
+                continue;
+            }
+
+            try {
+                auto request = parseRequest(line, simulation_.viewSize());
+                if (request.pattern_path.empty()) {
+                    post(client, std::move(request));
+                    continue;
+                }
+                // A slow disk must not hold up the other clients. The reader
+                // only owns the read and the mailbox, so a client that hangs
+                // up meanwhile does not have to wait for it.
+                std::packaged_task<PatternRead()> read{
+                    [path = request.pattern_path] { return tryReadPattern(path); }};
+                auto pattern = read.get_future();
+                std::thread{[read = std::move(read), mailbox = mailbox_]() mutable {
+                    read();
+                    mailbox->wake();
+                }}.detach();
+                client.pattern = std::move(pattern);
+                client.request = std::move(request);
+            } catch (const std::exception& e) {
+                client.queue(std::string{"error "} + e.what() + "\n");
+            }
+        }
+    };
+
+    while (!stopping_) {
+        // Each request is answered from the snapshot of its own ticket, those
+        // of clients that are gone are dropped.
+        for (auto& snapshot : mailbox_->take()) {
+            for (auto& client : clients) {
+                if (client->request && client->ticket == snapshot->ticket) {
+                    client->snapshot = std::move(snapshot);
+                    break;
+                }
+            }
+        }
+        for (auto& client : clients) {
+            serve(*client);
+        }
+        for (auto& client : clients) {
+            if (client->has_shut_down && (client->output.empty() || client->is_gone)) {
+                client->has_shut_down = false;
+                {
+                    const std::lock_guard lock{mutex_};
+                    is_shut_down_ = true;
+                }
+                shutdown_cv_.notify_all();
+            }
+        }
+        std::erase_if(clients, [](const auto& client) { return client->isDone(); });
+
+        fds.clear();
+        fds.push_back({mailbox_->read_fd, POLLIN, 0});
+        fds.push_back({listener_, POLLIN, 0});
+        for (const auto& client : clients) {
+            // A client waiting for a reply is not read from, which holds back
+            // clients that send faster than the simulation keeps up.
+            const bool is_reading
+                = !client->request && !client->is_closing && !client->has_hung_up;
+            const short events = (is_reading ? POLLIN : 0)
+                                 | (client->output.empty() ? 0 : POLLOUT);
+            fds.push_back({client->fd, events, 0});
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "control server stopped: " << describeError() << '\n';
+            return;
+        }
+
+        if (fds[0].revents != 0) {
+            mailbox_->drain();
+        }
+        for (std::size_t i = 0; i + 2 < fds.size(); i++) {
+            const auto events = fds[i + 2].revents;
+            auto& client = *clients[i];
+            if ((events & (POLLHUP | POLLERR)) != 0) {
+                client.is_gone = true;
+                continue;
+            }
+            if ((events & POLLIN) != 0 && !client.receive()) {
+                client.has_hung_up = true;
+            }
+            if ((events & POLLOUT) != 0 && !client.send()) {
+                client.is_gone = true;
+            }
+        }
+        if ((fds[1].revents & POLLIN) != 0) {
+            int fd;
+            while ((fd = accept(listener_, nullptr, nullptr)) >= 0) {
+#if defined(SO_NOSIGPIPE)
+                const int on = 1;
+                setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+                auto client = std::make_unique<Client>(fd);
+                try {
+                    setNonBlocking(fd);
+                } catch (const std::exception& e) {
+                    std::cerr << e.what() << '\n';
+                    continue;
+                }
+                clients.push_back(std::move(client));
+            }
+        }
+    }
+    // Replies still queued when the server stops are written as far as the
+    // sockets take them without waiting.
+    for (auto& client : clients) {
+        client->send();
+    }
+}
+
+#endif
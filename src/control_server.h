@@ -0,0 +1,83 @@
+#pragma once
+
+#include "simulation.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Lets scripts drive a simulation over a Unix domain socket with a line
+// protocol. Every request is one line, every reply starts with a line of
+// "ok ..." or "error <reason>":
+//
+//   run [delay_ms]                 steps on, as fast as possible without a delay
+//   pause                          also drops what is left of a step
+//   step <n>                       steps n generations
+//   set <0|1> <row> <col> ...      sets any number of cells in view
+//   fill <row> <col> <rows> <columns> <0|1>   the rectangle has to fit the view
+//   clear
+//   load <path>                    places a pattern file in the middle of the view
+//   stats
+//   region <row> <col> <rows> <columns>
+//   shutdown                       wakes waitForShutdown()
+//
+// Replies are sent once the simulation applied the request, so a request always
+// sees the effect of the ones before it, and start with the generation at that
+// point: "ok <generation>". A step is worked off one generation at a time
+// between other commands: its reply waits until it is done, other clients are
+// answered in between. `stats` adds "population <p>", counted over the whole
+// plane on one, followed by "births <b> deaths <d> bounds <first_row>
+// <first_col> <last_row> <last_col>" if the engine counts them, the last row
+// and column one past the live cells. `region` adds "<rows> <columns> <bytes>"
+// and is followed by that many bytes of cells: each row is a whole number of
+// little-endian 64-bit words and column j of the region is bit j % 64 of word
+// j / 64, as in snapshot files.
+//
+// Requests are served by a thread of its own that waits on every socket at once
+// and never waits for the simulation: edits are posted like any other command,
+// pattern files are read on a thread of their own, and replies are taken from
+// the snapshot the simulation publishes for each of them once it got to it.
+// Snapshots carry the generation and the counts, the cells in view are only
+// packed for `region`, from the last published frame. Rows of a region that
+// span the whole view are written to the socket straight from them.
+class ControlServer {
+public:
+    // Listens at `path`, replacing a socket file left behind by an earlier run.
+    ControlServer(Simulation& simulation, std::string path);
+    ~ControlServer();
+
+    ControlServer(const ControlServer&) = delete;
+    ControlServer& operator=(const ControlServer&) = delete;
+
+    const std::string& path() const { return path_; }
+
+    // Blocks until a client sends "shutdown".
+    void waitForShutdown();
+
+    // Longest request line accepted, a client sending more is disconnected.
+    static constexpr std::size_t max_line_bytes = 16 * 1024 * 1024;
+
+private:
+    struct Mailbox;
+    struct Client;
+
+    void run();
+
+    Simulation& simulation_;
+    std::string path_;
+    int listener_ = -1;
+    // Hands the snapshots of acknowledged requests to the server thread and
+    // wakes it from poll(), also when a pattern is read or the server is
+    // stopping. Shared with the acknowledgements still queued in the
+    // simulation and the pattern readers, which may outlive the server.
+    std::shared_ptr<Mailbox> mailbox_;
+    std::atomic<bool> stopping_ = false;
+
+    std::mutex mutex_;
+    std::condition_variable shutdown_cv_;
+    bool is_shut_down_ = false;
+
+    std::thread thread_;
+};
@@ -0,0 +1,41 @@
+#include "cycle_detector.h"
+#include <cassert>
+
+CycleDetector::CycleDetector(std::size_t history)
+    : history_{history}
+    , hashes_(history) {
+    assert(history > 0);
+}
+
+std::optional<Cycle> CycleDetector::update(std::uint64_t generation, std::uint64_t hash) {
+    if (last_generation_ && generation != *last_generation_ + 1) {
+        reset();
+    }
+
+    std::optional<Cycle> cycle;
+    if (const auto found = generations_.find(hash); found != generations_.end()) {
+        cycle = Cycle{.start = found->second, .period = generation - found->second};
+    }
+
+    // The slot still holds the hash of generation - history_ if the search
+    // goes back that far; it falls out of the history now, unless a later
+    // generation had the same hash.
+    auto& slot = hashes_[generation % history_];
+    if (last_generation_ && generation - first_generation_ >= history_) {
+        const auto evicted = generations_.find(slot);
+        if (evicted != generations_.end() && evicted->second == generation - history_) {
+            generations_.erase(evicted);
+        }
+    } else if (!last_generation_) {
+        first_generation_ = generation;
+    }
+    slot = hash;
+    generations_[hash] = generation;
+    last_generation_ = generation;
+    return cycle;
+}
+
+void CycleDetector::reset() {
+    generations_.clear();
+    last_generation_.reset();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// A board that repeats: the one at `start + period` equals the one at
+// `start`, and so does every later one a whole number of periods on.
+struct Cycle {
+    std::uint64_t start;
+    // 1 for a board that went still.
+    std::uint64_t period;
+
+    bool operator==(const Cycle&) const = default;
+};
+
+// Spots a repeating board from the hashes of consecutive generations. Only
+// the latest `history` hashes are remembered, which bounds the memory and
+// the longest period that is found. A 64-bit hash makes a false match
+// between two different boards vanishingly unlikely.
+class CycleDetector {
+public:
+    static constexpr std::size_t default_history = 1024;
+
+    explicit CycleDetector(std::size_t history = default_history);
+
+    // Feeds the hash of a generation. A generation that does not follow the
+    // previous one starts the search over. Returns the cycle as soon as the
+    // hash repeats a remembered one.
+    std::optional<Cycle> update(std::uint64_t generation, std::uint64_t hash);
+
+    // Forgets every hash, for when the board was edited.
+    void reset();
+
+private:
+    std::size_t history_;
+    // Hashes of the latest generations, the one of generation g at
+    // g % history_.
+    std::vector<std::uint64_t> hashes_;
+    // Latest remembered generation of every remembered hash.
+    std::unordered_map<std::uint64_t, std::uint64_t> generations_;
+    // First generation of the search, valid while last_generation_ is set.
+    std::uint64_t first_generation_ = 0;
+    std::optional<std::uint64_t> last_generation_;
+};
@@ -0,0 +1,87 @@
+#include "density_pyramid.h"
+#include <algorithm>
+#include <cstring>
+
+DensityPyramid::DensityPyramid(std::size_t rows, std::size_t columns) {
+    while (rows > 1 || columns > 1) {
+        rows = (rows + 1) / 2;
+        columns = (columns + 1) / 2;
+        levels_.push_back({.size = {rows, columns},
+                           .densities = std::vector<std::uint8_t>(rows * columns, 0),
+                           .is_dirty = std::vector<std::uint8_t>(rows * columns, 0),
+                           .dirty = {}});
+    }
+}
+
+void DensityPyramid::update(Grid& cells, const Grid& source) {
+    assert(cells.rows() == source.rows() && cells.columns() == source.columns());
+
+    const auto columns = cells.columns();
+    for (std::size_t i = 0; i < cells.rows(); i++) {
+        auto* row = cells.row(i);
+        const auto* source_row = source.row(i);
+        if (std::memcmp(row, source_row, columns * sizeof(Cell)) == 0) {
+            continue;
+        }
+        if (!levels_.empty()) {
+            for (std::size_t j = 0; j < columns; j++) {
+                if (row[j].data != source_row[j].data) {
+                    markDirty(levels_.front(), i / 2, j / 2);
+                }
+            }
+        }
+        std::copy(source_row, source_row + columns, row);
+    }
+    recomputeDirty(cells);
+}
+
+std::size_t DensityPyramid::memoryUsage() const {
+    std::size_t result = 0;
+    for (const auto& level : levels_) {
+        result += level.densities.capacity() + level.is_dirty.capacity()
+                  + level.dirty.capacity() * sizeof(std::size_t);
+    }
+    return result;
+}
+
+void DensityPyramid::markDirty(Level& level, std::size_t row, std::size_t col) {
+    const auto ind = row * level.size.col + col;
+    if (!level.is_dirty[ind]) {
+        level.is_dirty[ind] = 1;
+        level.dirty.push_back(ind);
+    }
+}
+
+void DensityPyramid::recomputeDirty(const Grid& cells) {
+    for (std::size_t k = 0; k < levels_.size(); k++) {
+        auto& level = levels_[k];
+        // Level 1 sums cells, the ones above average the level below.
+        const auto below_size = k == 0 ? cells.getSize() : levels_[k - 1].size;
+        const auto getBelow = [&](std::size_t row, std::size_t col) -> unsigned {
+            if (row >= below_size.row || col >= below_size.col) {
+                return 0;
+            }
+            if (k == 0) {
+                return cells.at({row, col}).data ? 255 : 0;
+            }
+            return levels_[k - 1].densities[row * below_size.col + col];
+        };
+
+        for (const auto ind : level.dirty) {
+            const auto row = ind / level.size.col;
+            const auto col = ind % level.size.col;
+            const auto sum = getBelow(2 * row, 2 * col) + getBelow(2 * row, 2 * col + 1)
+                             + getBelow(2 * row + 1, 2 * col)
+                             + getBelow(2 * row + 1, 2 * col + 1);
+            const auto density = static_cast<std::uint8_t>((sum + 2) / 4);
+            level.is_dirty[ind] = 0;
+            if (density != level.densities[ind]) {
+                level.densities[ind] = density;
+                if (k + 1 < levels_.size()) {
+                    markDirty(levels_[k + 1], row / 2, col / 2);
+                }
+            }
+        }
+        level.dirty.clear();
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "grid.h"
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+// Downsampled copies of a grid for drawing it zoomed out: level k holds one
+// byte per 2^k x 2^k block of cells, the share of live cells in it scaled to
+// 0-255, up to a level of a single block. Level 0 is the grid itself and not
+// stored here. Cells outside the grid count as dead.
+class DensityPyramid {
+public:
+    // Starts out matching an all dead grid of the given size.
+    DensityPyramid(std::size_t rows, std::size_t columns);
+
+    // Copies `source` into `cells`, which the pyramid was last updated from,
+    // and recomputes only the blocks above the cells that changed.
+    void update(Grid& cells, const Grid& source);
+
+    // Number of levels above the cells, so levels 1 to levelCount() exist.
+    unsigned levelCount() const { return static_cast<unsigned>(levels_.size()); }
+
+    Index levelSize(unsigned level) const { return getLevel(level).size; }
+
+    // Bytes held for all levels.
+    std::size_t memoryUsage() const;
+
+    const std::uint8_t* row(unsigned level, std::size_t ind) const {
+        const auto& data = getLevel(level);
+        return data.densities.data() + ind * data.size.col;
+    }
+
+private:
+    struct Level {
+        Index size;
+        std::vector<std::uint8_t> densities;
+        // Blocks to recompute in the next update, listed once each.
+        std::vector<std::uint8_t> is_dirty;
+        std::vector<std::size_t> dirty;
+    };
+
+    const Level& getLevel(unsigned level) const {
+        assert(level >= 1 && level <= levelCount());
+        return levels_[level - 1];
+    }
+
+    static void markDirty(Level& level, std::size_t row, std::size_t col);
+    void recomputeDirty(const Grid& cells);
+
+    std::vector<Level> levels_;
+};
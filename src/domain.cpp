@@ -0,0 +1,483 @@
+#include "domain.h"
+#include "checkpoint.h"
+#include "headless.h"
+#include "pattern.h"
+#include "step_kernels.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Zeroed memory that is shared with processes forked after it is mapped.
+void* mapShared(std::size_t size) {
+#if defined(_WIN32)
+    return ::operator new(size, std::align_val_t{64});
+#else
+    void* memory
+        = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        throw std::runtime_error("could not map " + std::to_string(size)
+                                 + " bytes of shared memory");
+    }
+    return memory;
+#endif
+}
+
+void unmapShared(void* memory, std::size_t size) {
+#if defined(_WIN32)
+    static_cast<void>(size);
+    ::operator delete(memory, std::align_val_t{64});
+#else
+    munmap(memory, size);
+#endif
+}
+
+// Start of part `part` of `count` nearly equal parts of `size`.
+std::size_t getSplit(std::size_t size, std::size_t count, std::size_t part) {
+    return size * part / count;
+}
+
+std::size_t wrap(std::size_t value, int offset, std::size_t count) {
+    const auto shifted = static_cast<std::int64_t>(value) + offset;
+    const auto size = static_cast<std::int64_t>(count);
+    return static_cast<std::size_t>((shifted % size + size) % size);
+}
+
+}  // namespace
+
+DomainLayout::DomainLayout(Index board, Index domains)
+    : board{board}
+    , domains{domains} {
+    if (domains.row == 0 || domains.col == 0 || domains.row > board.row
+        || domains.col > board.col) {
+        throw std::runtime_error("cannot split a " + std::to_string(board.col) + "x"
+                                 + std::to_string(board.row) + " board into "
+                                 + std::to_string(domains.col) + "x"
+                                 + std::to_string(domains.row) + " domains");
+    }
+}
+
+Index DomainLayout::origin(std::size_t domain) const {
+    return {getSplit(board.row, domains.row, domain / domains.col),
+            getSplit(board.col, domains.col, domain % domains.col)};
+}
+
+Index DomainLayout::extent(std::size_t domain) const {
+    const auto row = domain / domains.col;
+    const auto col = domain % domains.col;
+    return {getSplit(board.row, domains.row, row + 1)
+                - getSplit(board.row, domains.row, row),
+            getSplit(board.col, domains.col, col + 1)
+                - getSplit(board.col, domains.col, col)};
+}
+
+Index DomainLayout::maxExtent() const {
+    return {(board.row + domains.row - 1) / domains.row,
+            (board.col + domains.col - 1) / domains.col};
+}
+
+std::size_t DomainLayout::neighbour(std::size_t domain, int rows, int columns) const {
+    return wrap(domain / domains.col, rows, domains.row) * domains.col
+           + wrap(domain % domains.col, columns, domains.col);
+}
+
+HaloExchange::HaloExchange(const DomainLayout& layout)
+    : count_{layout.count()}
+    , max_extent_{layout.maxExtent()}
+    , size_{sizeof(Header) + count_ * sizeof(std::uint64_t)
+            + 2 * count_ * slotSize() * sizeof(Cell)}
+    , memory_{mapShared(size_)} {
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free);
+    static_assert(std::atomic<bool>::is_always_lock_free);
+    std::memset(memory_, 0, size_);
+    header_ = new (memory_) Header{};
+    populations_ = reinterpret_cast<std::uint64_t*>(header_ + 1);
+    slots_ = reinterpret_cast<Cell*>(populations_ + count_);
+}
+
+HaloExchange::~HaloExchange() {
+    header_->~Header();
+    unmapShared(memory_, size_);
+}
+
+Cell* HaloExchange::edge(std::size_t domain, std::uint64_t generation, Edge edge) {
+    auto* slot = slots_ + (2 * domain + generation % 2) * slotSize();
+    switch (edge) {
+    case Edge::top:
+        return slot;
+    case Edge::bottom:
+        return slot + max_extent_.col;
+    case Edge::left:
+        return slot + 2 * max_extent_.col;
+    case Edge::right:
+        return slot + 2 * max_extent_.col + max_extent_.row;
+    }
+    return slot;
+}
+
+const Cell* HaloExchange::edge(std::size_t domain,
+                               std::uint64_t generation,
+                               Edge edge) const {
+    return const_cast<HaloExchange*>(this)->edge(domain, generation, edge);
+}
+
+void HaloExchange::arriveAndWait() {
+    const auto phase = header_->phase.load(std::memory_order_acquire);
+    if (header_->waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == count_) {
+        header_->waiting.store(0, std::memory_order_relaxed);
+        header_->phase.store(phase + 1, std::memory_order_release);
+        return;
+    }
+    // std::atomic::wait() uses process-private futexes, so the processes spin
+    // and give up their time slice instead.
+    while (header_->phase.load(std::memory_order_acquire) == phase) {
+        if (header_->failed.load(std::memory_order_relaxed)) {
+            throw std::runtime_error("another domain failed");
+        }
+        std::this_thread::yield();
+    }
+}
+
+void HaloExchange::fail() {
+    header_->failed.store(true, std::memory_order_relaxed);
+}
+
+std::uint64_t& HaloExchange::population(std::size_t domain) {
+    return populations_[domain];
+}
+
+DomainEngine::DomainEngine(const DomainLayout& layout,
+                           std::size_t domain,
+                           HaloExchange& exchange,
+                           const Rule& rule)
+    : layout_{layout}
+    , domain_{domain}
+    , exchange_{exchange}
+    , origin_{layout.origin(domain)}
+    , extent_{layout.extent(domain)}
+    , generations_{extent_.row + 2, extent_.col + 2}
+    , rule_{rule} {}
+
+void DomainEngine::step(std::uint64_t generations) {
+    const auto kernel = getDefaultKernel(rule_).compute_row;
+    const auto columns = extent_.col + 2;
+
+    for (std::uint64_t gen = 0; gen < generations; gen++) {
+        publishEdges();
+        exchange_.arriveAndWait();
+        fillHalo();
+
+        // The halo columns are never computed, so the kernels do not wrap.
+        const auto& current = generations_.current();
+        auto& next = generations_.next();
+        for (std::size_t i = 1; i <= extent_.row; i++) {
+            kernel(current.row(i - 1),
+                   current.row(i),
+                   current.row(i + 1),
+                   next.row(i),
+                   columns,
+                   1,
+                   extent_.col + 1,
+                   rule_);
+        }
+        generations_.flip();
+        generation_++;
+    }
+}
+
+void DomainEngine::publishEdges() {
+    using Edge = HaloExchange::Edge;
+    const auto& current = generations_.current();
+    std::memcpy(exchange_.edge(domain_, generation_, Edge::top),
+                current.row(1) + 1,
+                extent_.col * sizeof(Cell));
+    std::memcpy(exchange_.edge(domain_, generation_, Edge::bottom),
+                current.row(extent_.row) + 1,
+                extent_.col * sizeof(Cell));
+    auto* left = exchange_.edge(domain_, generation_, Edge::left);
+    auto* right = exchange_.edge(domain_, generation_, Edge::right);
+    for (std::size_t i = 0; i < extent_.row; i++) {
+        left[i] = current.row(i + 1)[1];
+        right[i] = current.row(i + 1)[extent_.col];
+    }
+}
+
+void DomainEngine::fillHalo() {
+    using Edge = HaloExchange::Edge;
+    auto& current = generations_.current();
+    const auto height = extent_.row;
+    const auto width = extent_.col;
+
+    // Domains above and below are as wide, the ones beside as tall.
+    const auto* above
+        = exchange_.edge(layout_.neighbour(domain_, -1, 0), generation_, Edge::bottom);
+    const auto* below
+        = exchange_.edge(layout_.neighbour(domain_, 1, 0), generation_, Edge::top);
+    std::memcpy(current.row(0) + 1, above, width * sizeof(Cell));
+    std::memcpy(current.row(height + 1) + 1, below, width * sizeof(Cell));
+    const auto* left
+        = exchange_.edge(layout_.neighbour(domain_, 0, -1), generation_, Edge::right);
+    const auto* right
+        = exchange_.edge(layout_.neighbour(domain_, 0, 1), generation_, Edge::left);
+    for (std::size_t i = 0; i < height; i++) {
+        current.row(i + 1)[0] = left[i];
+        current.row(i + 1)[width + 1] = right[i];
+    }
+
+    // The corners are the ends of the diagonal neighbours' top and bottom rows.
+    const auto corner = [&](int rows, int columns, Edge edge, bool last) {
+        const auto domain = layout_.neighbour(domain_, rows, columns);
+        const auto* cells = exchange_.edge(domain, generation_, edge);
+        return last ? cells[layout_.extent(domain).col - 1] : cells[0];
+    };
+    current.row(0)[0] = corner(-1, -1, Edge::bottom, true);
+    current.row(0)[width + 1] = corner(-1, 1, Edge::bottom, false);
+    current.row(height + 1)[0] = corner(1, -1, Edge::top, true);
+    current.row(height + 1)[width + 1] = corner(1, 1, Edge::top, false);
+}
+
+bool DomainEngine::get(Index ind) const {
+    assert(ind.row - origin_.row < extent_.row && ind.col - origin_.col < extent_.col);
+    return generations_.current()
+        .at({ind.row - origin_.row + 1, ind.col - origin_.col + 1})
+        .data;
+}
+
+void DomainEngine::set(Index ind, bool alive) {
+    assert(ind.row - origin_.row < extent_.row && ind.col - origin_.col < extent_.col);
+    generations_.current().at({ind.row - origin_.row + 1, ind.col - origin_.col + 1}).data
+        = alive;
+}
+
+std::uint64_t DomainEngine::population() const {
+    const auto& current = generations_.current();
+    std::uint64_t population = 0;
+    for (std::size_t i = 1; i <= extent_.row; i++) {
+        const auto* row = current.row(i);
+        for (std::size_t j = 1; j <= extent_.col; j++) {
+            population += row[j].data;
+        }
+    }
+    return population;
+}
+
+std::size_t DomainEngine::memoryUsage() const {
+    return 2 * (extent_.row + 2) * (extent_.col + 2) * sizeof(Cell);
+}
+
+void DomainEngine::load(const Grid& grid) {
+    auto& current = generations_.current();
+    for (std::size_t i = 0; i < extent_.row; i++) {
+        std::memcpy(current.row(i + 1) + 1,
+                    grid.row(origin_.row + i) + origin_.col,
+                    extent_.col * sizeof(Cell));
+    }
+}
+
+void DomainEngine::fillRandom(double density, std::uint64_t seed) {
+    ::fillRandom(generations_.current(), {1, 1}, extent_, density, seed);
+}
+
+Grid DomainEngine::domainCells() const {
+    const auto& current = generations_.current();
+    Grid cells{extent_.row, extent_.col};
+    for (std::size_t i = 0; i < extent_.row; i++) {
+        std::memcpy(cells.row(i), current.row(i + 1) + 1, extent_.col * sizeof(Cell));
+    }
+    return cells;
+}
+
+void DomainEngine::save(Grid& grid) const {
+    const auto& current = generations_.current();
+    for (std::size_t i = 0; i < extent_.row; i++) {
+        std::memcpy(grid.row(origin_.row + i) + origin_.col,
+                    current.row(i + 1) + 1,
+                    extent_.col * sizeof(Cell));
+    }
+}
+
+std::string domainDumpPath(const std::string& dump, std::size_t domain) {
+    std::filesystem::path path{dump};
+    const auto extension = path.extension();
+    path.replace_extension("." + std::to_string(domain));
+    path += extension;
+    return path.string();
+}
+
+#if defined(_WIN32)
+
+DomainReport runDomains(Index,
+                        Index,
+                        std::uint64_t,
+                        const Rule&,
+                        const DomainSeed&,
+                        const DomainFinish&) {
+    throw std::runtime_error("domain decomposition needs fork(), which Windows lacks");
+}
+
+#else
+
+DomainReport runDomains(Index board,
+                        Index domains,
+                        std::uint64_t generations,
+                        const Rule& rule,
+                        const DomainSeed& seed,
+                        const DomainFinish& finish) {
+    const DomainLayout layout{board, domains};
+    HaloExchange exchange{layout};
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<pid_t> processes;
+    for (std::size_t domain = 0; domain < layout.count(); domain++) {
+        const auto pid = fork();
+        if (pid < 0) {
+            exchange.fail();
+            break;
+        }
+        if (pid > 0) {
+            processes.push_back(pid);
+            continue;
+        }
+
+        // The child only allocates its domain and leaves with _exit(), so it
+        // does not run the destructors and exit handlers of the parent's
+        // objects it inherited.
+        int status = EXIT_SUCCESS;
+        try {
+            DomainEngine engine{layout, domain, exchange, rule};
+            seed(engine);
+            engine.step(generations);
+            exchange.population(domain) = engine.population();
+            if (finish) {
+                finish(engine);
+            }
+        } catch (...) {
+            exchange.fail();
+            status = EXIT_FAILURE;
+        }
+        _exit(status);
+    }
+
+    // A process that was killed leaves the others waiting at the barrier until
+    // fail() is called, so every process is polled rather than waited for in
+    // turn. Once one failed the others leave the barrier as well.
+    bool failed = processes.size() != layout.count();
+    std::vector<pid_t> running = processes;
+    while (!running.empty()) {
+        std::erase_if(running, [&](pid_t pid) {
+            int status = 0;
+            const auto reaped = waitpid(pid, &status, WNOHANG);
+            if (reaped == 0) {
+                return false;
+            }
+            if (reaped < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+                exchange.fail();
+                failed = true;
+            }
+            return true;
+        });
+        if (!running.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    if (failed) {
+        throw std::runtime_error("a domain process failed");
+    }
+
+    std::uint64_t population = 0;
+    for (std::size_t domain = 0; domain < layout.count(); domain++) {
+        population += exchange.population(domain);
+    }
+    return {.seconds = std::chrono::duration<double>(elapsed).count(),
+            .population = population};
+}
+
+#endif
+
+void runDomains(const RunOptions& options) {
+    if (options.checkpoint_every > 0 || options.stop_on_cycle) {
+        std::cerr << "checkpoints and cycle detection are not supported with domains\n";
+    }
+
+    // Random boards are drawn by the domains, a pattern is placed in the middle
+    // of the board by each domain it overlaps. A checkpoint is only read as a
+    // whole, so that board is read before forking and each domain copies its
+    // part of it.
+    Index board_size{options.board_height, options.board_width};
+    std::optional<Grid> pattern;
+    std::optional<Grid> resumed;
+    if (!options.resume.empty()) {
+        auto snapshot = readCheckpoint(options.resume);
+        board_size = snapshot.grid.getSize();
+        resumed.emplace(std::move(snapshot.grid));
+    } else if (!options.pattern.empty()) {
+        pattern.emplace(readPattern(options.pattern));
+        board_size = {std::max(board_size.row, pattern->rows()),
+                      std::max(board_size.col, pattern->columns())};
+    }
+    const Index pattern_offset
+        = pattern ? Index{(board_size.row - pattern->rows()) / 2,
+                          (board_size.col - pattern->columns()) / 2}
+                  : Index{0, 0};
+
+    const auto seed = [&](DomainEngine& engine) {
+        if (resumed) {
+            engine.load(*resumed);
+        } else if (pattern) {
+            const auto origin = engine.origin();
+            const auto extent = engine.extent();
+            for (std::size_t i = 0; i < pattern->rows(); i++) {
+                for (std::size_t j = 0; j < pattern->columns(); j++) {
+                    const Index cell{pattern_offset.row + i, pattern_offset.col + j};
+                    if (pattern->at({i, j}).data && cell.row - origin.row < extent.row
+                        && cell.col - origin.col < extent.col) {
+                        engine.set(cell, true);
+                    }
+                }
+            }
+        } else {
+            engine.fillRandom(options.density, options.seed + engine.domain());
+        }
+    };
+    const auto dump = [&](const DomainEngine& engine) {
+        writePattern(domainDumpPath(options.dump, engine.domain()),
+                     engine.domainCells(),
+                     options.rule);
+    };
+
+    const Index domains{options.domains_down, options.domains_across};
+    const auto result = runDomains(board_size,
+                                   domains,
+                                   options.generations,
+                                   options.rule,
+                                   seed,
+                                   options.dump.empty() ? DomainFinish{} : dump);
+
+    const HeadlessReport report{.generations = options.generations,
+                                .seconds = result.seconds,
+                                .cells = board_size.row * board_size.col,
+                                .population = result.population,
+                                .cycle = std::nullopt};
+    printReport(std::cout,
+                "domains " + std::to_string(domains.col) + "x"
+                    + std::to_string(domains.row),
+                report);
+}
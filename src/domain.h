@@ -0,0 +1,167 @@
+#pragma once
+
+#include "double_buffer.h"
+#include "engine.h"
+#include "grid.h"
+#include "options.h"
+#include "rule.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <string>
+
+// A torus split into `domains.row` x `domains.col` rectangles, as evenly as
+// the board allows. Domains are numbered row by row; all domains of a domain
+// row are equally tall and all of a domain column equally wide.
+struct DomainLayout {
+    Index board;
+    Index domains;
+
+    // Throws unless every domain gets at least one row and column.
+    DomainLayout(Index board, Index domains);
+
+    std::size_t count() const { return domains.row * domains.col; }
+
+    // First row and column of `domain` on the board.
+    Index origin(std::size_t domain) const;
+    Index extent(std::size_t domain) const;
+    // The largest extent of any domain.
+    Index maxExtent() const;
+
+    // The domain `rows` down and `columns` right of `domain`, wrapping around
+    // the torus, so a layout of one domain is its own neighbour.
+    std::size_t neighbour(std::size_t domain, int rows, int columns) const;
+};
+
+// Memory shared by the processes stepping the domains of a layout: the
+// border cells every domain publishes for its neighbours, once per parity of
+// the generation, and the barrier they meet at between publishing and
+// reading. Mapped before the processes are forked, so they all see it.
+class HaloExchange {
+public:
+    enum class Edge { top, bottom, left, right };
+
+    explicit HaloExchange(const DomainLayout& layout);
+    ~HaloExchange();
+
+    HaloExchange(const HaloExchange&) = delete;
+    HaloExchange& operator=(const HaloExchange&) = delete;
+
+    // Border cells of `domain` at `generation`: a row of its width for the
+    // top and bottom edges, a column of its height for the left and right.
+    Cell* edge(std::size_t domain, std::uint64_t generation, Edge edge);
+    const Cell* edge(std::size_t domain, std::uint64_t generation, Edge edge) const;
+
+    // Blocks until all domains arrived. Throws once fail() was called, so a
+    // process that died does not leave the others waiting.
+    void arriveAndWait();
+    void fail();
+
+    // Population of every domain after the run.
+    std::uint64_t& population(std::size_t domain);
+
+private:
+    // Lock-free atomics are address-free, so they synchronize processes
+    // sharing the memory as well as threads.
+    struct Header {
+        std::atomic<std::uint32_t> waiting;
+        std::atomic<std::uint32_t> phase;
+        std::atomic<bool> failed;
+    };
+
+    std::size_t slotSize() const { return 2 * (max_extent_.row + max_extent_.col); }
+
+    std::size_t count_;
+    Index max_extent_;
+    std::size_t size_;
+    void* memory_;
+    Header* header_;
+    std::uint64_t* populations_;
+    Cell* slots_;
+};
+
+// Engine of one domain. The domain is kept with a one-cell halo ring that is
+// refilled every generation from the edges its eight neighbours publish to
+// the exchange, which keeps the wrap-around of the whole torus across domain
+// borders. All domains of the layout have to step together.
+class DomainEngine : public Engine {
+public:
+    DomainEngine(const DomainLayout& layout,
+                 std::size_t domain,
+                 HaloExchange& exchange,
+                 const Rule& rule = life_rule);
+
+    std::string_view name() const override { return "domain"; }
+
+    void step(std::uint64_t generations) override;
+    std::uint64_t generation() const override { return generation_; }
+
+    // Cells are addressed on the whole board and have to lie in the domain.
+    bool get(Index ind) const override;
+    void set(Index ind, bool alive) override;
+
+    std::uint64_t population() const override;
+    std::size_t memoryUsage() const override;
+
+    // Only the cells of the domain are read from and written to the board.
+    void load(const Grid& grid) override;
+    void save(Grid& grid) const override;
+
+    std::size_t domain() const { return domain_; }
+    Index origin() const { return origin_; }
+    Index extent() const { return extent_; }
+
+    // Fills the domain like fillRandom() fills a rectangle of its size.
+    void fillRandom(double density, std::uint64_t seed);
+
+    // The domain with its halo ring, cell (i, j) of the domain at (i + 1, j + 1).
+    const Grid& current() const { return generations_.current(); }
+    // The domain without its halo ring.
+    Grid domainCells() const;
+
+private:
+    void publishEdges();
+    void fillHalo();
+
+    const DomainLayout& layout_;
+    std::size_t domain_;
+    HaloExchange& exchange_;
+    Index origin_;
+    Index extent_;
+    DoubleBuffer<Grid> generations_;
+    Rule rule_;
+    std::uint64_t generation_ = 0;
+};
+
+struct DomainReport {
+    double seconds;
+    std::uint64_t population;
+};
+
+// Fills the domain of `engine` before the first step.
+using DomainSeed = std::function<void(DomainEngine& engine)>;
+// Handed the domain after the last step, for instance to dump it.
+using DomainFinish = std::function<void(const DomainEngine& engine)>;
+
+// Steps a board of size `board` by `generations` in one forked process per
+// domain. Each process only allocates its domain, fills it with `seed` and
+// hands it to `finish` when done, nothing of the board is gathered in the
+// calling process. Throws if a process fails, including if `seed` or `finish`
+// throw. Only supported on POSIX systems.
+DomainReport runDomains(Index board,
+                        Index domains,
+                        std::uint64_t generations,
+                        const Rule& rule,
+                        const DomainSeed& seed,
+                        const DomainFinish& finish = {});
+
+// File the final cells of `domain` are dumped to: `dump` with the number of
+// the domain before its extension, such as "board.3.rle" for "board.rle".
+std::string domainDumpPath(const std::string& dump, std::size_t domain);
+
+// Runs the headless board of `options` split into its domains, printing the
+// report and dumping every domain to its own file if requested. A random board
+// is drawn by the domains themselves, domain d with seed + d, so it differs
+// from the board of a single process with the same seed.
+void runDomains(const RunOptions& options);
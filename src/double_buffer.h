@@ -0,0 +1,27 @@
+#pragma once
+
+#include <array>
+#include <cstdlib>
+#include <utility>
+
+// Two generations of a board. The next generation is computed into `next()`
+// from `current()` and `flip()` then makes it current without copying.
+template <typename GridType>
+class DoubleBuffer {
+public:
+    template <typename... Args>
+    explicit DoubleBuffer(const Args&... args)
+        : buffers_{GridType(args...), GridType(args...)} {}
+
+    const GridType& current() const { return buffers_[front_]; }
+    GridType& current() { return buffers_[front_]; }
+
+    GridType& next() { return buffers_[front_ ^ 1]; }
+    const GridType& next() const { return buffers_[front_ ^ 1]; }
+
+    void flip() { front_ ^= 1; }
+
+private:
+    std::array<GridType, 2> buffers_;
+    std::size_t front_ = 0;
+};
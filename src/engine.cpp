@@ -0,0 +1,48 @@
+#include "engine.h"
+#include "active_tile_engine.h"
+#include "grid_engine.h"
+#include "hashlife.h"
+#include "sparse_tile_engine.h"
+#include "tiled_grid_engine.h"
+#include <stdexcept>
+#include <string>
+
+void Engine::load(const Grid& grid) {
+    for (std::size_t i = 0; i < grid.rows(); i++) {
+        for (std::size_t j = 0; j < grid.columns(); j++) {
+            set({i, j}, grid.at({i, j}).data);
+        }
+    }
+}
+
+void Engine::save(Grid& grid) const {
+    for (std::size_t i = 0; i < grid.rows(); i++) {
+        for (std::size_t j = 0; j < grid.columns(); j++) {
+            grid.at({i, j}).data = get({i, j});
+        }
+    }
+}
+
+std::unique_ptr<Engine> makeEngine(std::string_view name,
+                                   Index size,
+                                   std::size_t threads,
+                                   const Rule& rule) {
+    if (name == "grid") {
+        return std::make_unique<GridEngine>(size.row, size.col, threads, rule);
+    }
+    if (name == "active") {
+        return std::make_unique<ActiveTileEngine>(
+            size.row, size.col, threads, ActiveTileEngine::default_tile_size, rule);
+    }
+    if (name == "tiled") {
+        return std::make_unique<TiledGridEngine>(
+            size.row, size.col, threads, Index{0, 0}, rule);
+    }
+    if (name == "sparse") {
+        return std::make_unique<SparseTileEngine>(threads, rule);
+    }
+    if (name == "hashlife") {
+        return std::make_unique<HashLifeEngine>(HashLifeEngine::default_node_limit, rule);
+    }
+    throw std::runtime_error("unknown engine: " + std::string(name));
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "board_statistics.h"
+#include "grid.h"
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string_view>
+
+// Common interface of the stepping engines. Cells are addressed by Index, the
+// meaning of coordinates outside the board is up to the engine: the grid
+// engine wraps around a torus, HashLife lives on an unbounded plane.
+class Engine {
+public:
+    virtual ~Engine() = default;
+
+    virtual std::string_view name() const = 0;
+
+    virtual void step(std::uint64_t generations) = 0;
+    virtual std::uint64_t generation() const = 0;
+
+    virtual bool get(Index ind) const = 0;
+    virtual void set(Index ind, bool alive) = 0;
+
+    virtual std::uint64_t population() const = 0;
+
+    // Approximate bytes held for cells and the engine's own bookkeeping.
+    virtual std::size_t memoryUsage() const = 0;
+
+    // Starts keeping hash() up to date, returns false if the engine cannot.
+    // Engines that can update the hash incrementally from the cells a step
+    // changes, so it costs nothing while not tracked and never a full pass.
+    virtual bool trackHash() { return false; }
+    // Zobrist hash of the live cells, see zobrist.h.
+    virtual std::uint64_t hash() const { return 0; }
+
+    // Starts keeping boardStatistics() up to date, returns false if the engine
+    // cannot. Engines that can count the cells while stepping them, so the
+    // counts never cost a pass of their own.
+    virtual bool trackStatistics() { return false; }
+    // Counts of the current generation and the step to it.
+    virtual BoardStatistics boardStatistics() const { return {}; }
+
+    // Overwrites the cells [0, rows) x [0, columns) with the ones of `grid`.
+    // The grid engine only accepts a grid of its own size.
+    virtual void load(const Grid& grid);
+
+    // Copies the cells [0, rows) x [0, columns) of `grid`'s size into it.
+    virtual void save(Grid& grid) const;
+
+    // Prints engine specific statistics of the last step, one per line.
+    virtual void printStatistics(std::ostream& /*out*/) const {}
+};
+
+// Creates an engine by its name: "grid", "tiled", "active", "sparse" or
+// "hashlife". The grid engines wrap around a board of the given size, the
+// sparse engine and HashLife live on an unbounded plane and ignore it.
+std::unique_ptr<Engine> makeEngine(std::string_view name,
+                                   Index size,
+                                   std::size_t threads,
+                                   const Rule& rule = life_rule);
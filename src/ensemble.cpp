@@ -0,0 +1,145 @@
+#include "ensemble.h"
+#include "work_stealing_pool.h"
+#include "zobrist.h"
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <utility>
+
+std::array<Grid, 2>& EnsembleArena::getBoards(Index size) {
+    if (!boards_ || boards_->front().rows() != size.row
+        || boards_->front().columns() != size.col) {
+        boards_.emplace(std::array<Grid, 2>{Grid{size.row, size.col},
+                                            Grid{size.row, size.col}});
+    }
+    return *boards_;
+}
+
+EnsembleResult runEnsembleJob(const EnsembleJob& job,
+                              std::size_t index,
+                              const Rule& rule,
+                              EnsembleArena& arena) {
+    const auto start = std::chrono::steady_clock::now();
+
+    auto& boards = arena.getBoards(job.size);
+    auto* current = &boards[0];
+    auto* next = &boards[1];
+    fillRandom(*current, job.density, job.seed);
+
+    const auto countAlive = [](const Grid& grid) {
+        std::uint64_t population = 0;
+        for (std::size_t i = 0; i < grid.rows(); i++) {
+            const auto* row = grid.row(i);
+            for (std::size_t j = 0; j < grid.columns(); j++) {
+                population += row[j].data;
+            }
+        }
+        return population;
+    };
+
+    auto& detector = arena.cycleDetector();
+    detector.reset();
+    auto hash = hashGrid(*current);
+    detector.update(0, hash);
+
+    std::optional<Cycle> cycle;
+    std::uint64_t generation = 0;
+    const auto initial_population = countAlive(*current);
+    while (generation < job.max_generations && !cycle) {
+        current->step(*next, rule);
+        for (std::size_t i = 0; i < current->rows(); i++) {
+            hash ^= hashRowChanges(current->row(i),
+                                   next->row(i),
+                                   0,
+                                   current->columns(),
+                                   static_cast<std::int64_t>(i));
+        }
+        std::swap(current, next);
+        generation++;
+        cycle = detector.update(generation, hash);
+    }
+
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return {.job = index,
+            .initial_population = initial_population,
+            .final_population = countAlive(*current),
+            .generations = generation,
+            .cycle = cycle,
+            .seconds = std::chrono::duration<double>(elapsed).count()};
+}
+
+void runEnsemble(const std::vector<EnsembleJob>& jobs,
+                 std::size_t threads,
+                 const Rule& rule,
+                 const std::function<void(const EnsembleResult&)>& on_result) {
+    WorkStealingPool pool{threads};
+    std::vector<EnsembleArena> arenas(pool.threadCount());
+    std::mutex result_mutex;
+
+    pool.run(jobs.size(), [&](std::size_t index, std::size_t worker) {
+        const auto result = runEnsembleJob(jobs[index], index, rule, arenas[worker]);
+        const std::lock_guard lock{result_mutex};
+        on_result(result);
+    });
+}
+
+void writeEnsembleCsvHeader(std::ostream& out) {
+    out << "job,rows,columns,density,seed,initial_population,final_population,"
+           "generations,stabilized,cycle_start,period,milliseconds\n";
+}
+
+void writeEnsembleCsvRow(std::ostream& out,
+                         const EnsembleJob& job,
+                         const EnsembleResult& result) {
+    out << result.job << ',' << job.size.row << ',' << job.size.col << ','
+        << job.density << ',' << job.seed << ',' << result.initial_population << ','
+        << result.final_population << ',' << result.generations << ','
+        << (result.cycle ? 1 : 0) << ',';
+    if (result.cycle) {
+        out << result.cycle->start << ',' << result.cycle->period;
+    } else {
+        out << ',';
+    }
+    out << ',' << result.seconds * 1000 << '\n';
+}
+
+std::vector<EnsembleJob> makeEnsembleJobs(const RunOptions& options) {
+    const auto densities = options.ensemble_densities.empty()
+                               ? std::vector{options.density}
+                               : options.ensemble_densities;
+    std::vector<EnsembleJob> jobs;
+    jobs.reserve(densities.size() * options.ensemble);
+    for (const auto density : densities) {
+        for (std::uint64_t i = 0; i < options.ensemble; i++) {
+            jobs.push_back({.size = {options.board_height, options.board_width},
+                            .density = density,
+                            .seed = options.seed + i,
+                            .max_generations = options.generations});
+        }
+    }
+    return jobs;
+}
+
+void runEnsemble(const RunOptions& options) {
+    const auto jobs = makeEnsembleJobs(options);
+    const auto start = std::chrono::steady_clock::now();
+
+    writeEnsembleCsvHeader(std::cout);
+    std::uint64_t generations = 0;
+    runEnsemble(jobs, options.threads, options.rule, [&](const EnsembleResult& result) {
+        writeEnsembleCsvRow(std::cout, jobs[result.job], result);
+        generations += result.generations;
+    });
+    std::cout.flush();
+
+    const auto seconds
+        = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const auto per_second = [&](double count) {
+        return seconds > 0 ? count / seconds : 0;
+    };
+    std::cerr << "boards: " << jobs.size() << '\n'
+              << "time: " << seconds << " s\n"
+              << "boards/sec: " << per_second(static_cast<double>(jobs.size())) << '\n'
+              << "generations/sec: " << per_second(static_cast<double>(generations))
+              << '\n';
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "cycle_detector.h"
+#include "grid.h"
+#include "options.h"
+#include "rule.h"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+// One random board of an ensemble, stepped until it repeats or for
+// `max_generations`.
+struct EnsembleJob {
+    Index size;
+    double density;
+    std::uint64_t seed;
+    std::uint64_t max_generations;
+};
+
+struct EnsembleResult {
+    // Position of the job in the list it came from.
+    std::size_t job;
+    std::uint64_t initial_population;
+    std::uint64_t final_population;
+    // Generations stepped, the lifetime of a board that repeats.
+    std::uint64_t generations;
+    // Set if the board repeated, its start is the board's lifetime.
+    std::optional<Cycle> cycle;
+    double seconds;
+};
+
+// Reusable boards and cycle search of one worker. A worker runs many jobs in
+// a row, usually of one size, so the buffers are only reallocated when the
+// size changes and a whole ensemble allocates about once per worker.
+class EnsembleArena {
+public:
+    // Both boards of `size`, the first one current.
+    std::array<Grid, 2>& getBoards(Index size);
+    CycleDetector& cycleDetector() { return cycle_detector_; }
+
+private:
+    std::optional<std::array<Grid, 2>> boards_;
+    CycleDetector cycle_detector_;
+};
+
+// Runs one job with the buffers of `arena`. The board is a torus, its hash
+// is kept up to date from the cells each step changes.
+EnsembleResult runEnsembleJob(const EnsembleJob& job,
+                              std::size_t index,
+                              const Rule& rule,
+                              EnsembleArena& arena);
+
+// Spreads the jobs over a work-stealing pool of `threads` (0 for one per
+// hardware thread), every board stepped on a single thread. `on_result` is
+// called for every finished job in the order they finish, one at a time.
+void runEnsemble(const std::vector<EnsembleJob>& jobs,
+                 std::size_t threads,
+                 const Rule& rule,
+                 const std::function<void(const EnsembleResult&)>& on_result);
+
+void writeEnsembleCsvHeader(std::ostream& out);
+void writeEnsembleCsvRow(std::ostream& out,
+                         const EnsembleJob& job,
+                         const EnsembleResult& result);
+
+// `options.ensemble` random boards of the board size per density, seeds
+// counting up from `options.seed`.
+std::vector<EnsembleJob> makeEnsembleJobs(const RunOptions& options);
+
+// Runs the ensemble described by `options`, streaming one CSV row per board
+// to stdout and a summary to stderr.
+void runEnsemble(const RunOptions& options);
@@ -0,0 +1,234 @@
+#include "frame_export.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace {
+
+void append(std::vector<char>& out, std::string_view text) {
+    out.insert(out.end(), text.begin(), text.end());
+}
+
+std::string getY4mHeader(Index board_size) {
+    return "YUV4MPEG2 W" + std::to_string(board_size.col) + " H"
+           + std::to_string(board_size.row) + " F"
+           + std::to_string(FrameExporter::y4m_frame_rate) + ":1 Ip A1:1 Cmono\n";
+}
+
+}  // namespace
+
+FrameFormat getFrameFormat(std::string_view format, std::string_view path) {
+    if (format.empty()) {
+        format = path.ends_with(".y4m") ? "y4m" : "pbm";
+    }
+    if (format == "pbm") {
+        return FrameFormat::pbm;
+    }
+    if (format == "y4m") {
+        return FrameFormat::y4m;
+    }
+    throw std::runtime_error("unknown frame format " + std::string{format});
+}
+
+void encodePbm(const Grid& board, std::vector<char>& out) {
+    static_assert(sizeof(Cell) == 1);
+    append(out,
+           "P4\n" + std::to_string(board.columns()) + " " + std::to_string(board.rows())
+               + "\n");
+
+    const auto columns = board.columns();
+    const auto row_bytes = (columns + 7) / 8;
+    auto offset = out.size();
+    out.resize(offset + board.rows() * row_bytes);
+    for (std::size_t i = 0; i < board.rows(); i++) {
+        const auto* cells = board.row(i);
+        auto* bytes = reinterpret_cast<unsigned char*>(out.data() + offset);
+        std::size_t j = 0;
+        if constexpr (std::endian::native == std::endian::little) {
+            // As in packCells(), but the multiplication gathers the low bit of
+            // byte i into bit 63 - i, so the first cell ends up highest.
+            for (; j + 8 <= columns; j += 8) {
+                std::uint64_t cell_bytes;
+                std::memcpy(&cell_bytes, cells + j, sizeof(cell_bytes));
+                bytes[j / 8] = static_cast<unsigned char>(
+                    (cell_bytes * 0x8040201008040201) >> 56);
+            }
+        }
+        for (; j < columns; j++) {
+            if (j % 8 == 0) {
+                bytes[j / 8] = 0;
+            }
+            bytes[j / 8] |= static_cast<unsigned char>(cells[j].data << (7 - j % 8));
+        }
+        offset += row_bytes;
+    }
+}
+
+void encodeY4mFrame(const Grid& board, std::vector<char>& out) {
+    append(out, "FRAME\n");
+    auto offset = out.size();
+    out.resize(offset + board.rows() * board.columns());
+    for (std::size_t i = 0; i < board.rows(); i++) {
+        const auto* cells = board.row(i);
+        auto* luma = reinterpret_cast<unsigned char*>(out.data() + offset);
+        for (std::size_t j = 0; j < board.columns(); j++) {
+            luma[j] = cells[j].data ? 0 : 255;
+        }
+        offset += board.columns();
+    }
+}
+
+FrameExporter::FrameExporter(const std::string& path,
+                             Index board_size,
+                             FrameFormat format,
+                             std::size_t queue_frames)
+    : out_{path == "-" ? std::cout : file_}
+    , board_size_{board_size}
+    , format_{format} {
+    if (path == "-") {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    } else {
+        file_.open(path, std::ios::binary | std::ios::trunc);
+        if (!file_) {
+            throw std::runtime_error("could not open frame file " + path);
+        }
+    }
+    start(queue_frames);
+}
+
+FrameExporter::FrameExporter(std::ostream& out,
+                             Index board_size,
+                             FrameFormat format,
+                             std::size_t queue_frames)
+    : out_{out}
+    , board_size_{board_size}
+    , format_{format} {
+    start(queue_frames);
+}
+
+FrameExporter::~FrameExporter() {
+    {
+        const std::lock_guard lock{mutex_};
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+    out_.flush();
+}
+
+void FrameExporter::exportFrame(const Engine& engine) {
+    const auto start = std::chrono::steady_clock::now();
+
+    std::unique_lock lock{mutex_};
+    cv_.wait(lock, [this] { return !free_.empty() || error_; });
+    rethrowError();
+    auto board = std::move(free_.back());
+    free_.pop_back();
+    lock.unlock();
+
+    engine.save(board);
+
+    const auto stall = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+    lock.lock();
+    pending_.push_back(std::move(board));
+    statistics_.stall_seconds += stall;
+    statistics_.max_stall_seconds = std::max(statistics_.max_stall_seconds, stall);
+    lock.unlock();
+    cv_.notify_all();
+}
+
+void FrameExporter::flush() {
+    std::unique_lock lock{mutex_};
+    cv_.wait(lock, [this] { return pending_.empty() && !is_writing_; });
+    rethrowError();
+    // The writer is idle, the stream is ours.
+    out_.flush();
+}
+
+FrameExporter::Statistics FrameExporter::statistics() const {
+    const std::lock_guard lock{mutex_};
+    return statistics_;
+}
+
+void FrameExporter::printStatistics(std::ostream& out) const {
+    const auto stats = statistics();
+    const auto average_stall = stats.frames > 0 ? stats.stall_seconds / stats.frames
+                                                : 0.0;
+    out << "frames exported: " << stats.frames << ", "
+        << stats.bytes_written / (1024.0 * 1024.0) << " MiB written\n"
+        << "export stall: " << average_stall * 1000 << " ms average, "
+        << stats.max_stall_seconds * 1000 << " ms max\n";
+}
+
+void FrameExporter::start(std::size_t queue_frames) {
+    for (std::size_t i = 0; i < std::max<std::size_t>(queue_frames, 1); i++) {
+        free_.emplace_back(board_size_.row, board_size_.col);
+    }
+    if (format_ == FrameFormat::y4m) {
+        const auto header = getY4mHeader(board_size_);
+        out_.write(header.data(), static_cast<std::streamsize>(header.size()));
+        statistics_.bytes_written += header.size();
+    }
+    thread_ = std::thread{[this] { run(); }};
+}
+
+void FrameExporter::rethrowError() {
+    if (error_) {
+        std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+}
+
+void FrameExporter::run() {
+    while (true) {
+        std::unique_lock lock{mutex_};
+        cv_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+        if (pending_.empty()) {
+            return;
+        }
+        auto board = std::move(pending_.front());
+        pending_.pop_front();
+        is_writing_ = true;
+        lock.unlock();
+
+        std::exception_ptr error;
+        try {
+            encoded_.clear();
+            if (format_ == FrameFormat::pbm) {
+                encodePbm(board, encoded_);
+            } else {
+                encodeY4mFrame(board, encoded_);
+            }
+            out_.write(encoded_.data(), static_cast<std::streamsize>(encoded_.size()));
+            if (!out_) {
+                throw std::runtime_error("could not write frame");
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        free_.push_back(std::move(board));
+        is_writing_ = false;
+        if (error) {
+            error_ = error;
+        } else {
+            statistics_.frames++;
+            statistics_.bytes_written += encoded_.size();
+        }
+        lock.unlock();
+        cv_.notify_all();
+    }
+}
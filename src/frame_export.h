@@ -0,0 +1,104 @@
+#pragma once
+
+#include "engine.h"
+#include "grid.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Frame sequences a run can be exported as. Both are streams of raw frames
+// that can be piped into a video encoder: concatenated binary PBM images, one
+// bit per cell, or a YUV4MPEG2 stream of 8-bit monochrome frames. Live cells
+// are black in both.
+enum class FrameFormat { pbm, y4m };
+
+// "pbm" or "y4m", or the format of the file extension if `format` is empty.
+// Throws if neither names a format.
+FrameFormat getFrameFormat(std::string_view format, std::string_view path);
+
+// Streams generations of a board into a frame sequence. The stepping thread
+// only copies the board out of the engine into a free buffer, encoding and
+// writing happen on a background thread. Up to `queue_frames` copies wait to
+// be written, exportFrame() only blocks once they are all taken.
+class FrameExporter {
+public:
+    static constexpr std::size_t default_queue_frames = 4;
+    // Frames per second announced in the YUV4MPEG2 header.
+    static constexpr unsigned y4m_frame_rate = 30;
+
+    struct Statistics {
+        std::uint64_t frames = 0;
+        std::uint64_t bytes_written = 0;
+        // Time spent in exportFrame(), which is all an export adds to the
+        // latency of the step it follows.
+        double stall_seconds = 0;
+        double max_stall_seconds = 0;
+    };
+
+    // Writes to the file at `path`, or to stdout if it is "-".
+    FrameExporter(const std::string& path,
+                  Index board_size,
+                  FrameFormat format,
+                  std::size_t queue_frames = default_queue_frames);
+    // Writes to `out`, which has to outlive the exporter.
+    FrameExporter(std::ostream& out,
+                  Index board_size,
+                  FrameFormat format,
+                  std::size_t queue_frames = default_queue_frames);
+    // Finishes writing the queued frames.
+    ~FrameExporter();
+
+    FrameExporter(const FrameExporter&) = delete;
+    FrameExporter& operator=(const FrameExporter&) = delete;
+
+    // Queues the board of `engine` as the next frame. Rethrows the error if
+    // writing an earlier frame failed.
+    void exportFrame(const Engine& engine);
+
+    // Waits until the queued frames are written.
+    void flush();
+
+    Statistics statistics() const;
+    void printStatistics(std::ostream& out) const;
+
+private:
+    // Writes the stream header and starts the writer thread.
+    void start(std::size_t queue_frames);
+    void run();
+    void rethrowError();
+
+    std::ofstream file_;
+    std::ostream& out_;
+    Index board_size_;
+    FrameFormat format_;
+    // Only touched by the writer thread.
+    std::vector<char> encoded_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<Grid> free_;
+    std::deque<Grid> pending_;
+    // Set while the writer thread holds a frame taken from pending_.
+    bool is_writing_ = false;
+    bool stopping_ = false;
+    std::exception_ptr error_;
+    Statistics statistics_;
+
+    std::thread thread_;
+};
+
+// Appends `board` as a binary PBM image: a "P4" header, then every row packed
+// eight cells to a byte, first cell in the high bit, padded to whole bytes.
+void encodePbm(const Grid& board, std::vector<char>& out);
+
+// Appends `board` as a YUV4MPEG2 frame of one luma byte per cell, 0 for live
+// cells and 255 for dead ones. The stream header is written separately.
+void encodeY4mFrame(const Grid& board, std::vector<char>& out);
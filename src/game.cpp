@@ -1,26 +1,9 @@
 #include "game.h"
+#include "pattern.h"
+#include <algorithm>
+#include <cmath>
 #include <exception>
-
-bool Grid::checkCell(Index ind) const {
-    unsigned sum = 0;
-
-    const auto row = static_cast<int>(ind.row);
-    const auto col = static_cast<int>(ind.col);
-
-    for (int i = row - 1; i <= row + 1; i++) {
-        for (int j = col - 1; j <= col + 1; j++) {
-            sum += at(getPeriodicIndex(i, j)).data;
-        }
-    }
-
-    if (sum == 3) {
-        return true;
-    } else if (sum == 4) {
-        return at(ind).data;
-    }
-
-    return false;
-}
+#include <stdexcept>
 
 sf::Image createCellBordersImage(unsigned cell_size, sf::Color color) {
     sf::Image image;
@@ -38,123 +21,302 @@ sf::Image createCellBordersImage(unsigned cell_size, sf::Color color) {
     return image;
 }
 
-sf::Image createSquareImage(unsigned size, sf::Color color) {
-    sf::Image image;
-    image.create(size, size, color);
-    return image;
+GameOfLife::GameOfLife(Position upper_left,
+                       unsigned screen_width,
+                       unsigned screen_height,
+                       unsigned cell_size,
+                       Index board_size,
+                       unsigned threads,
+                       const Rule& rule,
+                       Topology topology)
+    : start_pos_{upper_left}
+    , screen_width_{screen_width}
+    , screen_height_{screen_height}
+    , columns_{getBoardSize(screen_width, screen_height, cell_size, board_size).col}
+    , rows_{getBoardSize(screen_width, screen_height, cell_size, board_size).row}
+    , camera_{getCentredCamera(screen_width, screen_height, cell_size, {rows_, columns_})}
+    , simulation_{rows_, columns_, threads, rule, topology} {
+    initializeResources();
 }
 
-void GameOfLife::runStep() {
-    for (std::size_t i = 0; i < rows_; i++) {
-        for (std::size_t j = 0; j < columns_; j++) {
-            const auto idx = Index{i, j};
-            buffer_.at(idx) = {grid_.checkCell(idx)};
-        }
+Index GameOfLife::getBoardSize(unsigned screen_width,
+                               unsigned screen_height,
+                               unsigned cell_size,
+                               Index board_size) {
+    if (board_size.row > 0 && board_size.col > 0) {
+        return board_size;
     }
-    grid_ = buffer_;
+    return {std::max(screen_height / cell_size, 1u),
+            std::max(screen_width / cell_size, 1u)};
+}
+
+Camera GameOfLife::getCentredCamera(unsigned screen_width,
+                                    unsigned screen_height,
+                                    unsigned cell_size,
+                                    Index board_size) {
+    const auto cell_pixels = static_cast<double>(cell_size);
+    const auto centre = [cell_pixels](unsigned screen_size, std::size_t cells) {
+        return (static_cast<double>(cells) - screen_size / cell_pixels) / 2;
+    };
+    return Camera{cell_pixels,
+                  centre(screen_width, board_size.col),
+                  centre(screen_height, board_size.row)};
 }
 
 void GameOfLife::render(sf::RenderWindow& window) {
-    if (is_hidden) {
-        return;
+    if (simulation_.updateFrame() || is_view_dirty_) {
+        updateView();
+        is_view_dirty_ = false;
     }
 
-    const auto upper_left = sf::Vector2f(static_cast<float>(offset_x_),
-                                         static_cast<float>(offset_y_));
-    resources_.alive_cell_sprite.setPosition(upper_left);
-    resources_.dead_cell_sprite.setPosition(upper_left);
-
-    for (std::size_t i = 0; i < rows_; i++) {
-        for (std::size_t j = 0; j < columns_; j++) {
-            const auto cur_pos = upper_left
-                                 + sf::Vector2f{static_cast<float>(j * cell_size_ + 1),
-                                                static_cast<float>(i * cell_size_ + 1)};
-
-            if (grid_.at({i, j}).data) {
-                resources_.alive_cell_sprite.setPosition(cur_pos);
-                window.draw(resources_.alive_cell_sprite);
-            } else {
-                resources_.dead_cell_sprite.setPosition(cur_pos);
-                window.draw(resources_.dead_cell_sprite);
-            }
-        }
+    window.draw(resources_.dead_cells_shape);
+    window.draw(resources_.view_sprite);
+    if (camera_.cellPixels() >= min_grid_cell_pixels) {
+        window.draw(resources_.grid_sprite);
     }
+}
 
-    window.draw(resources_.grid_sprite);
+void GameOfLife::pastePattern(Grid pattern) {
+    const auto centre = [](std::size_t view_size, std::size_t pattern_size) {
+        return view_size > pattern_size ? (view_size - pattern_size) / 2 : 0;
+    };
+    const Index origin{centre(rows_, pattern.rows()),
+                       centre(columns_, pattern.columns())};
+    simulation_.post(Simulation::PastePattern{std::move(pattern), origin});
 }
 
-void GameOfLife::handleClick(Position click_pos) {
-    if (auto cell = getIndexFromPositionOnScreen(click_pos); cell) {
-        auto& cell_value = grid_.at(*cell);
-        cell_value.data = !cell_value.data;
+void GameOfLife::beginStroke(Position pos, unsigned brush) {
+    const auto cell = getIndexFromPositionOnScreen(pos);
+    if (!cell) {
+        return;
     }
+    // The published frame may be a generation behind, which only matters
+    // for a cell that changes right under the click.
+    stroke_ = Stroke{.alive = !currentGeneration().at(*cell).data,
+                     .brush = std::max(brush, 1u),
+                     .last = *cell};
+    paintAt(*cell);
 }
 
-void GameOfLife::handleResize(unsigned int new_width,
-                              unsigned int new_height,
-                              sf::RenderWindow& window) {
-    cell_size_ = static_cast<unsigned>(
-        std::min(new_width / columns_, new_height / rows_));
-    if (cell_size_ == 0) {
-        is_hidden = true;
+void GameOfLife::continueStroke(Position pos) {
+    const auto cell = getIndexFromPositionOnScreen(pos);
+    if (!stroke_ || !cell) {
         return;
     }
+    // Mouse moves come in jumps, the cells between are stamped on a line so
+    // a fast stroke has no gaps.
+    const auto from = stroke_->last;
+    const auto rows = static_cast<double>(cell->row) - static_cast<double>(from.row);
+    const auto cols = static_cast<double>(cell->col) - static_cast<double>(from.col);
+    const auto steps = static_cast<int>(std::max(std::abs(rows), std::abs(cols)));
+    for (int step = 1; step <= steps; step++) {
+        const auto t = static_cast<double>(step) / steps;
+        paintAt({static_cast<std::size_t>(std::lround(from.row + t * rows)),
+                 static_cast<std::size_t>(std::lround(from.col + t * cols))});
+    }
+    stroke_->last = *cell;
+}
+
+void GameOfLife::paintAt(Index cell) {
+    // The brush is clipped to the view rather than wrapping around it.
+    const std::size_t brush = stroke_->brush;
+    const auto clip = [brush](std::size_t centre, std::size_t size) {
+        const auto first = centre >= brush / 2 ? centre - brush / 2 : 0;
+        const auto last = std::min(centre + brush - brush / 2, size);
+        return std::pair{first, last - first};
+    };
+    const auto [first_row, rows] = clip(cell.row, rows_);
+    const auto [first_col, cols] = clip(cell.col, columns_);
+    simulation_.post(
+        Simulation::FillCells{{first_row, first_col}, {rows, cols}, stroke_->alive});
+}
+
+void GameOfLife::dragCamera(int dx, int dy) {
+    camera_.drag(dx, dy);
+    is_view_dirty_ = true;
+}
+
+void GameOfLife::zoomCamera(int steps, Position around) {
+    // Zooming out stops where the whole board is a single texel.
+    camera_.zoom(steps,
+                 static_cast<double>(around.x) - start_pos_.x,
+                 static_cast<double>(around.y) - start_pos_.y,
+                 simulation_.frame().densities.levelCount());
+    is_view_dirty_ = true;
+}
+
+std::optional<Index> GameOfLife::getIndexFromPositionOnScreen(Position pos) const {
+    if (pos.x < start_pos_.x || pos.y < start_pos_.y) {
+        return std::nullopt;
+    }
+    const auto col = std::floor(camera_.toCellX(pos.x - start_pos_.x));
+    const auto row = std::floor(camera_.toCellY(pos.y - start_pos_.y));
+    if (col < 0 || row < 0 || col >= static_cast<double>(columns_)
+        || row >= static_cast<double>(rows_)) {
+        return std::nullopt;
+    }
+    return Index{static_cast<std::size_t>(row), static_cast<std::size_t>(col)};
+}
+
+void GameOfLife::savePattern(const std::string& path) const {
+    writePattern(path, currentGeneration(), rule());
+}
 
-    is_hidden = false;
-    offset_x_ = (new_width - cell_size_ * static_cast<unsigned>(columns_)) / 2;
-    offset_y_ = (new_height - cell_size_ * static_cast<unsigned>(rows_)) / 2;
+void GameOfLife::handleResize(unsigned int new_width, unsigned int new_height) {
     screen_width_ = new_width;
     screen_height_ = new_height;
-
-    resetGridTexture();
-    updateGridSprite();
-    updateCellsScale();
+    resetViewTexture();
+    is_view_dirty_ = true;
 }
 
-void GameOfLife::resetGridTexture() {
-    resources_.grid_image = createCellBordersImage(cell_size_);
-    if (!resources_.grid_texture.create(cell_size_, cell_size_)) {
-        throw std::runtime_error("could not create grid texture");
+void GameOfLife::resetViewTexture() {
+    // A texel covers at least a pixel, plus one partly visible at each edge.
+    const auto width = screen_width_ + 2;
+    const auto height = screen_height_ + 2;
+    if (!resources_.view_texture.create(width, height)) {
+        throw std::runtime_error("could not create view texture");
     }
-    resources_.grid_texture.update(resources_.grid_image);
+    resources_.view_pixels.assign(std::size_t{width} * height * 4, 255);
+    resources_.view_texels.reset();
 }
 
 void GameOfLife::updateGridSprite() {
+    const auto cell_pixels = static_cast<unsigned>(camera_.cellPixels());
+    if (cell_pixels < min_grid_cell_pixels) {
+        return;
+    }
+    if (cell_pixels != resources_.grid_cell_pixels) {
+        resources_.grid_image = createCellBordersImage(cell_pixels);
+        if (!resources_.grid_texture.create(cell_pixels, cell_pixels)) {
+            throw std::runtime_error("could not create grid texture");
+        }
+        resources_.grid_texture.update(resources_.grid_image);
+        resources_.grid_sprite.setTexture(resources_.grid_texture);
+        resources_.grid_cell_pixels = cell_pixels;
+    }
+
+    // The repeated texture covers the part of the board on screen, starting
+    // at the right offset into a cell.
+    const auto board_left = std::round(camera_.toScreenX(0));
+    const auto board_top = std::round(camera_.toScreenY(0));
+    const auto left = std::max(board_left, 0.0);
+    const auto top = std::max(board_top, 0.0);
+    const auto right = std::min(camera_.toScreenX(static_cast<double>(columns_)),
+                                static_cast<double>(screen_width_));
+    const auto bottom = std::min(camera_.toScreenY(static_cast<double>(rows_)),
+                                 static_cast<double>(screen_height_));
     resources_.grid_sprite.setTextureRect(
-        {0,
-         0,
-         static_cast<int>(screen_width_ - 2 * offset_x_),
-         static_cast<int>(screen_height_ - 2 * offset_y_)});
-    const auto upper_left = sf::Vector2f(static_cast<float>(offset_x_),
-                                         static_cast<float>(offset_y_));
-    resources_.grid_sprite.setPosition(upper_left);
+        {static_cast<int>(left - board_left),
+         static_cast<int>(top - board_top),
+         static_cast<int>(std::max(right - left, 0.0)),
+         static_cast<int>(std::max(bottom - top, 0.0))});
+    resources_.grid_sprite.setPosition(static_cast<float>(start_pos_.x + left),
+                                       static_cast<float>(start_pos_.y + top));
 }
 
-void GameOfLife::updateCellsScale() {
-    const auto factor = static_cast<float>(cell_size_ - 2);
-    resources_.alive_cell_sprite.setScale(factor, factor);
-    resources_.dead_cell_sprite.setScale(factor, factor);
-}
+void GameOfLife::updateView() {
+    constexpr std::size_t channels = 4;
+    const auto& frame = simulation_.frame();
 
-void GameOfLife::initializeResources() {
-    resources_.grid_texture.setSmooth(true);
-    resources_.grid_texture.setRepeated(true);
-    resources_.grid_sprite.setTexture(resources_.grid_texture);
-    resources_.grid_sprite.setColor(default_grid);
+    // Zoomed out, every texel is one pixel of the matching density level.
+    const auto level = std::min(camera_.level(), frame.densities.levelCount());
+    const auto texel_cells = std::ldexp(1.0, static_cast<int>(level));
+    const auto size
+        = level == 0 ? frame.grid.getSize() : frame.densities.levelSize(level);
+
+    const auto [texture_width, texture_height] = resources_.view_texture.getSize();
+    const auto getTexelRange = [texel_cells](double first_cell,
+                                             double last_cell,
+                                             std::size_t count,
+                                             unsigned capacity) {
+        const auto clampTexel = [count](double texel) {
+            return static_cast<std::size_t>(
+                std::clamp(texel, 0.0, static_cast<double>(count)));
+        };
+        const auto first = clampTexel(std::floor(first_cell / texel_cells));
+        const auto last = clampTexel(std::ceil(last_cell / texel_cells));
+        return std::pair{first, std::max(first, std::min(last, first + capacity))};
+    };
+    const auto [first_col, last_col] = getTexelRange(
+        camera_.x(), camera_.toCellX(screen_width_), size.col, texture_width);
+    const auto [first_row, last_row] = getTexelRange(
+        camera_.y(), camera_.toCellY(screen_height_), size.row, texture_height);
+    const auto width = last_col - first_col;
+    const auto height = last_row - first_row;
 
-    resources_.cell_image = createSquareImage(1, sf::Color::White);
-    if (!resources_.cell_texture.create(1, 1)) {
-        throw std::runtime_error("could not create cell texture");
+    // The texels are compared as they are filled in, so only the band from
+    // the first to the last row that changed is uploaded while the view stays
+    // where it is. Once it moved, zoomed or was resized every row is.
+    const Resources::TexelRect texels{.level = level,
+                                      .first_row = first_row,
+                                      .first_col = first_col,
+                                      .rows = height,
+                                      .columns = width};
+    const bool is_same_view = resources_.view_texels == texels;
+    resources_.view_texels = texels;
+    auto first_changed = is_same_view ? height : 0;
+    auto last_changed = is_same_view ? 0 : height;
+    const auto setAlpha = [](sf::Uint8& pixel, sf::Uint8 alpha) {
+        const bool changed = pixel != alpha;
+        pixel = alpha;
+        return changed;
+    };
+    for (std::size_t i = 0; i < height; i++) {
+        auto* pixels = resources_.view_pixels.data() + i * width * channels;
+        bool changed = false;
+        if (level == 0) {
+            const auto* row = frame.grid.row(first_row + i) + first_col;
+            for (std::size_t j = 0; j < width; j++) {
+                changed |= setAlpha(pixels[j * channels + 3], row[j].data ? 255 : 0);
+            }
+        } else {
+            const auto* row = frame.densities.row(level, first_row + i) + first_col;
+            for (std::size_t j = 0; j < width; j++) {
+                changed |= setAlpha(pixels[j * channels + 3], row[j]);
+            }
+        }
+        if (changed) {
+            first_changed = std::min(first_changed, i);
+            last_changed = std::max(last_changed, i + 1);
+        }
+    }
+    if (width > 0 && first_changed < last_changed) {
+        resources_.view_texture.update(
+            resources_.view_pixels.data() + first_changed * width * channels,
+            static_cast<unsigned>(width),
+            static_cast<unsigned>(last_changed - first_changed),
+            0,
+            static_cast<unsigned>(first_changed));
     }
-    resources_.cell_texture.update(resources_.cell_image);
 
-    resources_.alive_cell_sprite.setTexture(resources_.cell_texture);
-    resources_.dead_cell_sprite.setTexture(resources_.cell_texture);
+    const auto texel_pixels = static_cast<float>(texel_cells * camera_.cellPixels());
+    resources_.view_sprite.setTextureRect(
+        {0, 0, static_cast<int>(width), static_cast<int>(height)});
+    resources_.view_sprite.setScale(texel_pixels, texel_pixels);
+    const auto left = camera_.toScreenX(static_cast<double>(first_col) * texel_cells);
+    const auto top = camera_.toScreenY(static_cast<double>(first_row) * texel_cells);
+    resources_.view_sprite.setPosition(static_cast<float>(start_pos_.x + left),
+                                       static_cast<float>(start_pos_.y + top));
 
-    resources_.alive_cell_sprite.setColor(default_alive);
-    resources_.dead_cell_sprite.setColor(default_dead);
+    const auto board_width = static_cast<double>(columns_) * camera_.cellPixels();
+    const auto board_height = static_cast<double>(rows_) * camera_.cellPixels();
+    resources_.dead_cells_shape.setSize(
+        {static_cast<float>(board_width), static_cast<float>(board_height)});
+    resources_.dead_cells_shape.setPosition(
+        static_cast<float>(start_pos_.x + camera_.toScreenX(0)),
+        static_cast<float>(start_pos_.y + camera_.toScreenY(0)));
 
-    resetGridTexture();
     updateGridSprite();
-    updateCellsScale();
+}
+
+void GameOfLife::initializeResources() {
+    resources_.grid_texture.setSmooth(true);
+    resources_.grid_texture.setRepeated(true);
+    resources_.grid_sprite.setColor(default_grid);
+
+    resetViewTexture();
+    resources_.view_texture.setSmooth(false);
+    resources_.view_sprite.setTexture(resources_.view_texture, true);
+    resources_.view_sprite.setColor(default_alive);
+    resources_.dead_cells_shape.setFillColor(default_dead);
 }
@@ -1,8 +1,13 @@
 #pragma once
 
-#include <cassert>
+#include "camera.h"
+#include "grid.h"
+#include "simulation.h"
+#include <chrono>
 #include <cstdlib>
 #include <optional>
+#include <string>
+#include <utility>
 #include <SFML/Graphics.hpp>
 #include <vector>
 
@@ -11,136 +16,187 @@ struct Position {
     unsigned y;
 };
 
-struct Index {
-    std::size_t row;
-    std::size_t col;
-};
-
-struct Cell {
-    bool data;
-};
-
-class Grid {
-public:
-    Grid(std::size_t rows, std::size_t columns)
-        : grid_{rows, std::vector(columns, Cell{false})} {
-        assert(columns > 0 && rows > 0);
-    }
-
-    std::size_t rows() const { return grid_.size(); }
-
-    std::size_t columns() const { return grid_[0].size(); }
-
-    Index getSize() const { return {.row = rows(), .col = columns()}; }
-
-    Cell at(Index ind) const { return grid_[ind.row][ind.col]; }
-    Cell& at(Index ind) { return grid_[ind.row][ind.col]; }
-
-    Index getPeriodicIndex(int row, int col) const {
-        if (row < 0) {
-            row = static_cast<int>(rows() - (-row) % rows());
-        }
-        if (col < 0) {
-            col = static_cast<int>(columns() - (-col) % columns());
-        }
-        return {.row = row % rows(), .col = col % columns()};
-    }
-
-    bool checkCell(Index ind) const;
-
-private:
-    std::vector<std::vector<Cell>> grid_;
-};
-
 sf::Image createCellBordersImage(unsigned cell_size, sf::Color color = sf::Color::White);
-sf::Image createSquareImage(unsigned size, sf::Color color = sf::Color::White);
 
 class GameOfLife {
 public:
+    // The board is `board_size` cells large, or fills the screen with cells of
+    // `cell_size` pixels if that is 0 x 0. It starts out centred at that zoom.
     GameOfLife(Position upper_left,
                unsigned screen_width,
                unsigned screen_height,
-               unsigned cell_size)
-        : start_pos_{upper_left}
-        , screen_width_{screen_width}
-        , screen_height_{screen_height}
-        , cell_size_{cell_size}
-        , columns_{screen_width / cell_size}
-        , rows_{screen_height / cell_size}
-        , grid_{rows_, columns_}
-        , buffer_{grid_}
-        , offset_x_{(screen_width - cell_size * static_cast<unsigned>(columns_)) / 2}
-        , offset_y_{(screen_height - cell_size * static_cast<unsigned>(rows_)) / 2} {
-        initializeResources();
+               unsigned cell_size,
+               Index board_size = {0, 0},
+               unsigned threads = 1,
+               const Rule& rule = life_rule,
+               Topology topology = Topology::torus);
+
+    // Pace of the simulation thread. Changes are queued and take effect
+    // between two steps.
+    void setPaused(bool paused) { simulation_.post(Simulation::SetPaused{paused}); }
+    void setStepDelay(int delay_ms) {
+        simulation_.post(Simulation::SetStepDelay{std::chrono::milliseconds{delay_ms}});
+    }
+    void setUnthrottled(bool unthrottled) {
+        simulation_.post(Simulation::SetUnthrottled{unthrottled});
     }
 
-    void runStep();
+    // Moves the view across an unbounded plane by the given number of cells.
+    void panView(std::int64_t columns, std::int64_t rows) {
+        simulation_.post(Simulation::PanView{columns, rows});
+    }
+
+    // Moves the camera so the board follows a mouse drag by (dx, dy) pixels.
+    void dragCamera(int dx, int dy);
+    // Zooms in for positive steps and out for negative ones around a point.
+    void zoomCamera(int steps, Position around);
+    double cellPixels() const { return camera_.cellPixels(); }
+
+    // Replaces the board with `pattern` placed in the middle of the view.
+    void loadPattern(Grid pattern, std::uint64_t generation = 0) {
+        simulation_.post(Simulation::LoadPattern{std::move(pattern), generation});
+    }
+    // Copies `pattern` over the middle of the view without clearing the board.
+    void pastePattern(Grid pattern);
+    // Fills the whole view at random, each cell alive with probability
+    // `density`.
+    void randomFill(double density, std::uint64_t seed) {
+        simulation_.post(
+            Simulation::RandomFillCells{{0, 0}, {rows_, columns_}, density, seed});
+    }
+    void clearBoard() { simulation_.post(Simulation::ClearBoard{}); }
+
+    // Paints with a square brush of `brush` cells centred on the cell under
+    // the cursor. A stroke sets cells to the opposite of the cell it starts
+    // on, so a click with a brush of one cell toggles that cell. Every brush
+    // stamp is a single bulk edit.
+    void beginStroke(Position pos, unsigned brush);
+    // Paints along the line from the last cell of the stroke to `pos`.
+    void continueStroke(Position pos);
+    void endStroke() { stroke_.reset(); }
+    bool isPainting() const { return stroke_.has_value(); }
+
+    // Writes a checkpoint every `every` generations from the simulation thread.
+    void setCheckpoints(std::string path, std::uint64_t every) {
+        simulation_.post(Simulation::SetCheckpoints{std::move(path), every});
+    }
+    // Turns the board back into an earlier generation kept by the history.
+    void seekGeneration(std::uint64_t generation) {
+        simulation_.post(Simulation::SeekGeneration{generation});
+    }
+    void stepBack(std::uint64_t generations = 1) {
+        simulation_.post(Simulation::StepBack{generations});
+    }
+    void setHistoryLimit(std::size_t bytes) {
+        simulation_.post(Simulation::SetHistoryLimit{bytes});
+    }
+    // For clients that drive the simulation themselves.
+    Simulation& simulation() { return simulation_; }
+
+    // Writes the generation on screen, in the format of the file extension.
+    void savePattern(const std::string& path) const;
+
+    // The generation last published by the simulation thread.
+    const Grid& currentGeneration() const { return simulation_.frame().grid; }
+    std::uint64_t generation() const { return simulation_.frame().generation; }
+    const Rule& rule() const { return simulation_.rule(); }
+    Topology topology() const { return simulation_.topology(); }
+    std::int64_t viewX() const { return simulation_.frame().view_x; }
+    std::int64_t viewY() const { return simulation_.frame().view_y; }
+    Metrics& metrics() { return simulation_.metrics(); }
+    const std::optional<Cycle>& cycle() const { return simulation_.frame().cycle; }
+    std::uint64_t historyOldest() const { return simulation_.frame().history_oldest; }
+    std::uint64_t historyNewest() const { return simulation_.frame().history_newest; }
+    const std::optional<BoardStatistics>& statistics() const {
+        return simulation_.frame().statistics;
+    }
     void render(sf::RenderWindow& window);
 
-    void handleClick(Position click_pos);
-    void handleResize(unsigned int new_width,
-                      unsigned int new_height,
-                      sf::RenderWindow& window);
+    void handleResize(unsigned int new_width, unsigned int new_height);
 
     void setGridColor(sf::Color new_color) { resources_.grid_sprite.setColor(new_color); }
     void setAliveCellColor(sf::Color new_color) {
-        resources_.alive_cell_sprite.setColor(new_color);
+        resources_.view_sprite.setColor(new_color);
     }
     void setDeadCellColor(sf::Color new_color) {
-        resources_.dead_cell_sprite.setColor(new_color);
+        resources_.dead_cells_shape.setFillColor(new_color);
     }
 
     inline static const auto default_grid = sf::Color{128, 128, 128};
     inline static const auto default_alive = sf::Color{255, 255, 255};
     inline static const auto default_dead = sf::Color{0, 0, 0};
 
+    // Grid lines are only drawn while cells are at least this many pixels.
+    static constexpr double min_grid_cell_pixels = 4;
+
 private:
     struct Resources {
         sf::Image grid_image;
         sf::Texture grid_texture;
         sf::Sprite grid_sprite;
-
-        sf::Image cell_image;
-        sf::Texture cell_texture;
-        sf::Sprite alive_cell_sprite;
-        sf::Sprite dead_cell_sprite;
+        // Cell size the grid texture was made for.
+        unsigned grid_cell_pixels = 0;
+
+        // One texel per visible cell, or per block of cells of a density
+        // level when zoomed out, white with the live share as alpha. The
+        // sprite is tinted with the alive color and drawn over a rectangle of
+        // the dead color, so color changes need no texture update. The
+        // texture is as large as the screen, but only the band of texel rows
+        // that changed since the last frame is uploaded.
+        sf::Texture view_texture;
+        sf::Sprite view_sprite;
+        sf::RectangleShape dead_cells_shape;
+        std::vector<sf::Uint8> view_pixels;
+        // Texels in `view_pixels`, none after the texture was created. Any
+        // other texels than last frame's are uploaded as a whole.
+        struct TexelRect {
+            unsigned level;
+            std::size_t first_row;
+            std::size_t first_col;
+            std::size_t rows;
+            std::size_t columns;
+
+            bool operator==(const TexelRect&) const = default;
+        };
+        std::optional<TexelRect> view_texels;
     };
 
-    std::optional<Index> getIndexFromPositionOnScreen(Position pos) const {
-        if (isOutOfScreenBounds(pos)) {
-            return std::nullopt;
-        }
-        const Position relative = {pos.x - start_pos_.x - offset_x_,
-                                   pos.y - start_pos_.y - offset_y_};
-        return Index{relative.y / cell_size_, relative.x / cell_size_};
-    }
+    static Index getBoardSize(unsigned screen_width,
+                              unsigned screen_height,
+                              unsigned cell_size,
+                              Index board_size);
+    static Camera getCentredCamera(unsigned screen_width,
+                                   unsigned screen_height,
+                                   unsigned cell_size,
+                                   Index board_size);
 
-    bool isOutOfScreenBounds(Position pos) const {
-        return (pos.x < start_pos_.x + offset_x_ || pos.y < start_pos_.y + offset_y_
-                || pos.x >= start_pos_.x + cell_size_ * grid_.columns() + offset_x_
-                || pos.y >= start_pos_.y + cell_size_ * grid_.rows() + offset_y_);
-    }
+    std::optional<Index> getIndexFromPositionOnScreen(Position pos) const;
+    void paintAt(Index cell);
 
-    void resetGridTexture();
+    void resetViewTexture();
     void updateGridSprite();
-    void updateCellsScale();
+    void updateView();
     void initializeResources();
 
     Position start_pos_;
     unsigned screen_width_;
     unsigned screen_height_;
-    unsigned cell_size_;
 
     std::size_t columns_;
     std::size_t rows_;
 
-    unsigned offset_x_;
-    unsigned offset_y_;
+    Camera camera_;
+    // Set when the camera or the screen changed since the view was drawn.
+    bool is_view_dirty_ = true;
 
-    Grid grid_;
-    Grid buffer_;
+    Simulation simulation_;
 
-    Resources resources_;
+    struct Stroke {
+        bool alive;
+        unsigned brush;
+        Index last;
+    };
+    std::optional<Stroke> stroke_;
 
-    bool is_hidden = false;
+    Resources resources_;
 };
@@ -0,0 +1,213 @@
+#include "generation_history.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iterator>
+
+namespace {
+
+void writeVarint(std::uint64_t value, std::vector<std::uint8_t>& out) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+std::uint64_t readVarint(const std::uint8_t*& data) {
+    if (*data < 0x80) {
+        return *data++;
+    }
+    std::uint64_t value = 0;
+    for (unsigned shift = 0;; shift += 7) {
+        const auto byte = *data++;
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+}
+
+}  // namespace
+
+void encodeChanges(const Grid& before,
+                   const Grid& after,
+                   std::vector<std::uint8_t>& out) {
+    static_assert(sizeof(Cell) == 1);
+    constexpr std::size_t word_cells = sizeof(std::uint64_t);
+    const auto columns = before.columns();
+
+    // Each index is stored as its distance from the one after the previous.
+    std::uint64_t next = 0;
+    const auto emit = [&](std::uint64_t index) {
+        writeVarint(index - next, out);
+        next = index + 1;
+    };
+    for (std::size_t i = 0; i < before.rows(); i++) {
+        const auto* old_row = before.row(i);
+        const auto* new_row = after.row(i);
+        const auto row_start = static_cast<std::uint64_t>(i) * columns;
+        std::size_t j = 0;
+        // Cells are 0 or 1, so every set bit of the difference of eight cells
+        // is one changed cell, in index order on a little-endian CPU.
+        if constexpr (std::endian::native == std::endian::little) {
+            for (; j + word_cells <= columns; j += word_cells) {
+                std::uint64_t old_word;
+                std::uint64_t new_word;
+                std::memcpy(&old_word, old_row + j, word_cells);
+                std::memcpy(&new_word, new_row + j, word_cells);
+                for (auto changed = old_word ^ new_word; changed != 0;
+                     changed &= changed - 1) {
+                    const auto bit = static_cast<std::size_t>(std::countr_zero(changed));
+                    emit(row_start + j + bit / 8);
+                }
+            }
+        }
+        for (; j < columns; j++) {
+            if (old_row[j].data != new_row[j].data) {
+                emit(row_start + j);
+            }
+        }
+    }
+}
+
+void applyChanges(const std::vector<std::uint8_t>& changes, Grid& board) {
+    const auto columns = board.columns();
+    const auto* data = changes.data();
+    const auto* end = data + changes.size();
+    // Gaps are mostly shorter than a row, so the position is advanced rather
+    // than divided out of the index.
+    std::size_t row = 0;
+    std::size_t col = 0;
+    while (data < end) {
+        col += readVarint(data);
+        if (col >= columns) {
+            row += col / columns;
+            col %= columns;
+        }
+        auto& cell = board.row(row)[col];
+        cell.data = !cell.data;
+        col++;
+    }
+}
+
+GenerationHistory::GenerationHistory(std::size_t keyframe_interval,
+                                     std::size_t memory_cap)
+    : keyframe_interval_{std::max<std::size_t>(keyframe_interval, 1)}
+    , memory_cap_{memory_cap} {}
+
+void GenerationHistory::record(const Grid& before,
+                               const Grid& after,
+                               std::uint64_t generation) {
+    if (!cursor_set_ || generation != cursor_ + 1) {
+        clear();
+        cursor_set_ = true;
+        base_ = generation - 1;
+        cursor_ = base_;
+        addKeyframe(before, base_);
+    }
+
+    // Stepping from a generation sought back to starts a new future.
+    while (newest() > cursor_) {
+        memory_usage_ -= deltas_.back().size();
+        deltas_.pop_back();
+    }
+    while (!keyframes_.empty() && keyframes_.back().generation > cursor_) {
+        memory_usage_ -= getKeyframeBytes(keyframes_.back().board);
+        keyframes_.pop_back();
+    }
+
+    auto& changes = deltas_.emplace_back();
+    // Sized for the previous generation, which usually changed about as much.
+    changes.reserve(deltas_.size() > 1 ? deltas_[deltas_.size() - 2].size() : 0);
+    encodeChanges(before, after, changes);
+    memory_usage_ += changes.size();
+    cursor_ = generation;
+    if (generation % keyframe_interval_ == 0) {
+        addKeyframe(after, generation);
+    }
+
+    while (memory_usage_ > memory_cap_ && !deltas_.empty()) {
+        dropOldest();
+    }
+}
+
+void GenerationHistory::clear() {
+    cursor_set_ = false;
+    base_ = 0;
+    cursor_ = 0;
+    deltas_.clear();
+    keyframes_.clear();
+    memory_usage_ = 0;
+}
+
+std::uint64_t GenerationHistory::seek(std::uint64_t generation, Grid& board) {
+    if (empty()) {
+        return cursor_;
+    }
+    const auto target = std::clamp(generation, oldest(), newest());
+
+    // The nearest keyframes on either side compete with walking from the
+    // board at hand.
+    auto start = cursor_;
+    auto cost = getWalkBytes(cursor_, target);
+    const Keyframe* keyframe = nullptr;
+    const auto consider = [&](const Keyframe& candidate) {
+        const auto candidate_cost = getKeyframeBytes(candidate.board)
+                                    + getWalkBytes(candidate.generation, target);
+        if (candidate_cost < cost) {
+            cost = candidate_cost;
+            start = candidate.generation;
+            keyframe = &candidate;
+        }
+    };
+    const auto later = std::ranges::upper_bound(
+        keyframes_, target, {}, [](const Keyframe& frame) { return frame.generation; });
+    if (later != keyframes_.end()) {
+        consider(*later);
+    }
+    if (later != keyframes_.begin()) {
+        consider(*std::prev(later));
+    }
+    if (keyframe) {
+        for (std::size_t i = 0; i < board.rows(); i++) {
+            unpackCells(keyframe->board.row(i), board.columns(), board.row(i));
+        }
+    }
+
+    for (auto g = start; g > target; g--) {
+        applyChanges(changesTo(g), board);
+    }
+    for (auto g = start; g < target; g++) {
+        applyChanges(changesTo(g + 1), board);
+    }
+    cursor_ = target;
+    return target;
+}
+
+void GenerationHistory::addKeyframe(const Grid& board, std::uint64_t generation) {
+    auto& keyframe = keyframes_.emplace_back(Keyframe{generation, PackedGrid{board}});
+    memory_usage_ += getKeyframeBytes(keyframe.board);
+}
+
+void GenerationHistory::dropOldest() {
+    memory_usage_ -= deltas_.front().size();
+    deltas_.pop_front();
+    base_++;
+    while (!keyframes_.empty() && keyframes_.front().generation < base_) {
+        memory_usage_ -= getKeyframeBytes(keyframes_.front().board);
+        keyframes_.pop_front();
+    }
+}
+
+std::size_t GenerationHistory::getWalkBytes(std::uint64_t from, std::uint64_t to) const {
+    std::size_t bytes = 0;
+    for (auto g = std::min(from, to); g < std::max(from, to); g++) {
+        bytes += changesTo(g + 1).size();
+    }
+    return bytes;
+}
+
+std::size_t GenerationHistory::getKeyframeBytes(const PackedGrid& board) {
+    return board.rows() * board.wordsPerRow() * sizeof(PackedGrid::Word);
+}
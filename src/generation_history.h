@@ -0,0 +1,86 @@
+#pragma once
+
+#include "grid.h"
+#include "packed_grid.h"
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+// Bounded history of the generations of a torus for stepping backwards and
+// scrubbing. Every generation is stored as the list of cells that changed
+// from the one before, as varint gaps between their row-major indices, and
+// every `keyframe_interval` generations the whole board is kept bit-packed.
+// A change list toggles a board either way, so seeking walks the lists from
+// the board at hand or starts from the nearest keyframe on either side of the
+// target, whichever touches fewer bytes. The oldest generations are dropped once the
+// history holds more than `memory_cap` bytes.
+class GenerationHistory {
+public:
+    static constexpr std::size_t default_keyframe_interval = 32;
+    static constexpr std::size_t default_memory_cap = 256 * 1024 * 1024;
+
+    explicit GenerationHistory(std::size_t keyframe_interval = default_keyframe_interval,
+                               std::size_t memory_cap = default_memory_cap);
+
+    // Records the step from `before` to `after`, which is generation
+    // `generation`. The generation of `before` has to be the one seek() last
+    // left the board at, or the history starts over from it; generations
+    // after it are forgotten.
+    void record(const Grid& before, const Grid& after, std::uint64_t generation);
+
+    // Forgets everything, for when the board was edited.
+    void clear();
+
+    bool empty() const { return !cursor_set_; }
+
+    // The range of generations seek() can reach, valid unless empty().
+    std::uint64_t oldest() const { return base_; }
+    std::uint64_t newest() const { return base_ + deltas_.size(); }
+    // The generation the board was last recorded or sought at.
+    std::uint64_t cursor() const { return cursor_; }
+
+    // Turns `board`, the board at cursor(), into generation `generation`,
+    // clamped to [oldest(), newest()]. Returns the generation reached.
+    std::uint64_t seek(std::uint64_t generation, Grid& board);
+
+    // Bytes held for change lists and keyframes.
+    std::size_t memoryUsage() const { return memory_usage_; }
+    std::size_t keyframeCount() const { return keyframes_.size(); }
+
+private:
+    struct Keyframe {
+        std::uint64_t generation;
+        PackedGrid board;
+    };
+
+    // Changes from generation base_ + i to base_ + i + 1.
+    const std::vector<std::uint8_t>& changesTo(std::uint64_t generation) const {
+        return deltas_[generation - base_ - 1];
+    }
+
+    void addKeyframe(const Grid& board, std::uint64_t generation);
+    void dropOldest();
+    // Bytes of the change lists between two generations, in either order.
+    std::size_t getWalkBytes(std::uint64_t from, std::uint64_t to) const;
+
+    static std::size_t getKeyframeBytes(const PackedGrid& board);
+
+    std::size_t keyframe_interval_;
+    std::size_t memory_cap_;
+
+    bool cursor_set_ = false;
+    std::uint64_t base_ = 0;
+    std::uint64_t cursor_ = 0;
+    std::deque<std::vector<std::uint8_t>> deltas_;
+    // Ordered by generation, none older than base_.
+    std::deque<Keyframe> keyframes_;
+    std::size_t memory_usage_ = 0;
+};
+
+// Appends the changes between two boards of the same size as varint gaps.
+void encodeChanges(const Grid& before, const Grid& after, std::vector<std::uint8_t>& out);
+
+// Toggles the cells listed by encodeChanges(), which turns either board into
+// the other.
+void applyChanges(const std::vector<std::uint8_t>& changes, Grid& board);
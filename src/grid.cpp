@@ -0,0 +1,79 @@
+#include "grid.h"
+#include "packed_grid.h"
+#include "step_kernels.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+bool Grid::checkCell(Index ind, const Rule& rule) const {
+    unsigned sum = 0;
+
+    const auto row = static_cast<int>(ind.row);
+    const auto col = static_cast<int>(ind.col);
+
+    for (int i = row - 1; i <= row + 1; i++) {
+        for (int j = col - 1; j <= col + 1; j++) {
+            sum += at(getPeriodicIndex(i, j)).data;
+        }
+    }
+
+    return rule.getNextState(at(ind).data, sum);
+}
+
+void Grid::step(Grid& next,
+                std::size_t first_row,
+                std::size_t last_row,
+                const Rule& rule) const {
+    stepRows(*this, next, first_row, last_row, getDefaultKernel(rule).compute_row, rule);
+}
+
+void fillRect(Grid& grid, Index origin, Index extent, bool alive) {
+    forEachSpan(
+        grid.getSize(), origin, extent, [&](Index cell, Index, std::size_t count) {
+            std::fill_n(grid.row(cell.row) + cell.col, count, Cell{alive});
+        });
+}
+
+void fillRandom(Grid& grid,
+                Index origin,
+                Index extent,
+                double density,
+                std::uint64_t seed) {
+    constexpr unsigned precision_bits = 16;
+    const auto threshold = static_cast<std::uint64_t>(
+        std::llround(std::clamp(density, 0.0, 1.0) * (1 << precision_bits)));
+    if (threshold == 0 || threshold == 1 << precision_bits) {
+        fillRect(grid, origin, extent, threshold != 0);
+        return;
+    }
+
+    // Each bit of the threshold, lowest first, either ORs or ANDs in a word
+    // of fair random bits, which leaves every bit set with probability
+    // threshold / 2^16. Zero bits below the lowest set one would AND into
+    // nothing and are skipped. Up to 16 words per 64 cells are drawn, so the
+    // words come from splitmix64, the mixer of the Zobrist keys, which is
+    // several times faster than std::mt19937_64.
+    auto state = seed;
+    const auto gen = [&state] {
+        auto word = state += 0x9e3779b97f4a7c15ULL;
+        word = (word ^ (word >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        word = (word ^ (word >> 27)) * 0x94d049bb133111ebULL;
+        return word ^ (word >> 31);
+    };
+    const auto getWord = [&] {
+        PackedGrid::Word word = 0;
+        for (auto bit = static_cast<unsigned>(std::countr_zero(threshold));
+             bit < precision_bits;
+             bit++) {
+            word = (threshold >> bit) & 1 ? word | gen() : word & gen();
+        }
+        return word;
+    };
+    std::vector<PackedGrid::Word> words;
+    forEachSpan(
+        grid.getSize(), origin, extent, [&](Index cell, Index, std::size_t count) {
+            words.resize((count + PackedGrid::word_bits - 1) / PackedGrid::word_bits);
+            std::ranges::generate(words, getWord);
+            unpackCells(words.data(), count, grid.row(cell.row) + cell.col);
+        });
+}
\ No newline at end of file
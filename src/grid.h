@@ -0,0 +1,103 @@
+#pragma once
+
+#include "rule.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+struct Index {
+    std::size_t row;
+    std::size_t col;
+};
+
+struct Cell {
+    bool data;
+};
+
+class Grid {
+public:
+    Grid(std::size_t rows, std::size_t columns)
+        : grid_{rows, std::vector(columns, Cell{false})} {
+        assert(columns > 0 && rows > 0);
+    }
+
+    std::size_t rows() const { return grid_.size(); }
+
+    std::size_t columns() const { return grid_[0].size(); }
+
+    Index getSize() const { return {.row = rows(), .col = columns()}; }
+
+    Cell at(Index ind) const { return grid_[ind.row][ind.col]; }
+    Cell& at(Index ind) { return grid_[ind.row][ind.col]; }
+
+    const Cell* row(std::size_t ind) const { return grid_[ind].data(); }
+    Cell* row(std::size_t ind) { return grid_[ind].data(); }
+
+    Index getPeriodicIndex(int row, int col) const {
+        if (row < 0) {
+            row = static_cast<int>(rows() - (-row) % rows());
+        }
+        if (col < 0) {
+            col = static_cast<int>(columns() - (-col) % columns());
+        }
+        return {.row = row % rows(), .col = col % columns()};
+    }
+
+    bool checkCell(Index ind, const Rule& rule = life_rule) const;
+
+    // Writes rows [first_row, last_row) of the next generation into `next`,
+    // which must have the same size. Rows only read from `*this`, so disjoint
+    // row ranges can be computed concurrently. Uses the fastest step kernel
+    // the CPU supports for `rule`.
+    void step(Grid& next,
+              std::size_t first_row,
+              std::size_t last_row,
+              const Rule& rule = life_rule) const;
+    void step(Grid& next, const Rule& rule = life_rule) const {
+        step(next, 0, rows(), rule);
+    }
+
+private:
+    std::vector<std::vector<Cell>> grid_;
+};
+
+// Calls `span(cell, offset, count)` for every run of `count` cells of the
+// rectangle of `extent` cells with its upper left corner at `origin` on a
+// torus of `size`: `cell` is the first cell of the run on the torus, `offset`
+// its position in the rectangle. The rectangle wraps around the edges, so a
+// row of it is one or two runs, and is clipped to the size of the torus.
+template <typename Span>
+void forEachSpan(Index size, Index origin, Index extent, Span&& span) {
+    const auto rows = std::min(extent.row, size.row);
+    const auto columns = std::min(extent.col, size.col);
+    const auto first_col = origin.col % size.col;
+    const auto head = std::min(columns, size.col - first_col);
+    for (std::size_t i = 0; i < rows; i++) {
+        const auto row = (origin.row + i) % size.row;
+        if (head > 0) {
+            span(Index{row, first_col}, Index{i, 0}, head);
+        }
+        if (columns > head) {
+            span(Index{row, 0}, Index{i, head}, columns - head);
+        }
+    }
+}
+
+// Batch edits of a rectangle of the grid as laid out by forEachSpan(). Every
+// run of cells is written in one go, so an edit costs one pass over the
+// rectangle however large it is.
+void fillRect(Grid& grid, Index origin, Index extent, bool alive);
+
+// Overwrites every cell of the rectangle with a live one with probability
+// `density`, the same cells for the same seed. Cells are drawn 64 at a time
+// from whole random words, the density is rounded to a multiple of 2^-16.
+void fillRandom(Grid& grid,
+                Index origin,
+                Index extent,
+                double density,
+                std::uint64_t seed);
+inline void fillRandom(Grid& grid, double density, std::uint64_t seed) {
+    fillRandom(grid, {0, 0}, grid.getSize(), density, seed);
+}
@@ -0,0 +1,211 @@
+#include "grid_engine.h"
+#include "step_kernels.h"
+#include "zobrist.h"
+#include <atomic>
+#include <cassert>
+#include <mutex>
+#include <vector>
+
+void GridEngine::step(std::uint64_t generations) {
+    const auto& kernel = getDefaultKernel(rule_);
+
+    for (std::uint64_t gen = 0; gen < generations; gen++) {
+        const auto& current = generations_.current();
+        auto& next = generations_.next();
+        const auto rows = current.rows();
+        const auto columns = current.columns();
+        std::atomic<std::uint64_t> changes = 0;
+        std::mutex counts_mutex;
+        BoardStatistics counts;
+        thread_pool_.parallelFor(rows, [&](std::size_t begin, std::size_t end) {
+            if (is_counting_) {
+                BoardStatistics band_counts;
+                for (auto i = begin; i < end; i++) {
+                    RowCounts row_counts;
+                    kernel.compute_counted_row(current.row(i == 0 ? rows - 1 : i - 1),
+                                               current.row(i),
+                                               current.row(i == rows - 1 ? 0 : i + 1),
+                                               next.row(i),
+                                               columns,
+                                               0,
+                                               columns,
+                                               rule_,
+                                               row_counts);
+                    addRowCounts(row_counts, next.row(i), 0, columns, i, band_counts);
+                }
+                const std::lock_guard lock{counts_mutex};
+                counts.merge(band_counts);
+            } else {
+                stepRows(current, next, begin, end, kernel.compute_row, rule_);
+            }
+            if (is_hashing_) {
+                std::uint64_t band_changes = 0;
+                for (auto i = begin; i < end; i++) {
+                    band_changes ^= hashRowChanges(current.row(i),
+                                                   next.row(i),
+                                                   0,
+                                                   columns,
+                                                   static_cast<std::int64_t>(i));
+                }
+                changes.fetch_xor(band_changes, std::memory_order_relaxed);
+            }
+        });
+        hash_ ^= changes.load(std::memory_order_relaxed);
+        generations_.flip();
+        generation_++;
+        if (is_counting_) {
+            statistics_ = counts;
+            are_bounds_stale_ = false;
+            statistics_.generation = generation_;
+        }
+    }
+}
+
+void GridEngine::set(Index ind, bool alive) {
+    auto& cell = generations_.current().at(ind);
+    if (is_hashing_ && cell.data != alive) {
+        hash_ ^= getCellKey(static_cast<std::int64_t>(ind.col),
+                            static_cast<std::int64_t>(ind.row));
+    }
+    if (is_counting_ && cell.data != alive) {
+        if (alive) {
+            statistics_.population++;
+            statistics_.includeBounds(ind, {ind.row + 1, ind.col + 1});
+        } else {
+            statistics_.population--;
+            markBoundsKilled(ind, {ind.row + 1, ind.col + 1});
+        }
+    }
+    cell.data = alive;
+}
+
+void GridEngine::edit(Index origin,
+                      Index extent,
+                      const std::function<void(Grid&)>& edit) {
+    auto& grid = generations_.current();
+    // Hashing the live cells of the rectangle before and after the edit
+    // takes them out of the hash and puts the new ones in.
+    const auto hashRectangle = [&] {
+        const std::vector<Cell> dead(grid.columns(), Cell{false});
+        std::uint64_t hash = 0;
+        forEachSpan(
+            grid.getSize(), origin, extent, [&](Index cell, Index, std::size_t count) {
+                hash ^= hashRowChanges(dead.data(),
+                                       grid.row(cell.row),
+                                       cell.col,
+                                       cell.col + count,
+                                       static_cast<std::int64_t>(cell.row));
+            });
+        return hash;
+    };
+    // Live cells of the rectangle, and its bounding box after the edit.
+    const auto countRectangle = [&] {
+        BoardStatistics counts;
+        forEachSpan(
+            grid.getSize(), origin, extent, [&](Index cell, Index, std::size_t count) {
+                countRowChanges(grid.row(cell.row),
+                                grid.row(cell.row),
+                                cell.col,
+                                cell.col + count,
+                                cell.row,
+                                counts);
+            });
+        return counts;
+    };
+    if (is_hashing_) {
+        hash_ ^= hashRectangle();
+    }
+    BoardStatistics before;
+    if (is_counting_) {
+        before = countRectangle();
+        statistics_.population -= before.population;
+    }
+    edit(grid);
+    if (is_hashing_) {
+        hash_ ^= hashRectangle();
+    }
+    if (is_counting_) {
+        const auto counts = countRectangle();
+        statistics_.population += counts.population;
+        if (before.hasBounds()) {
+            markBoundsKilled(before.first, before.last);
+        }
+        statistics_.includeBounds(counts.first, counts.last);
+    }
+    markEdited(origin, extent);
+}
+
+bool GridEngine::trackHash() {
+    if (!is_hashing_) {
+        is_hashing_ = true;
+        hash_ = hashGrid(current());
+    }
+    return true;
+}
+
+bool GridEngine::trackStatistics() {
+    if (!is_counting_) {
+        is_counting_ = true;
+        statistics_ = countGrid(current());
+        are_bounds_stale_ = false;
+        statistics_.generation = generation_;
+    }
+    return true;
+}
+
+BoardStatistics GridEngine::boardStatistics() const {
+    if (are_bounds_stale_) {
+        const auto counts = countGrid(current());
+        statistics_.first = counts.first;
+        statistics_.last = counts.last;
+        are_bounds_stale_ = false;
+    }
+    return statistics_;
+}
+
+void GridEngine::markBoundsKilled(Index first, Index last) {
+    if (statistics_.population == 0) {
+        statistics_.first = {0, 0};
+        statistics_.last = {0, 0};
+        are_bounds_stale_ = false;
+    } else if (statistics_.reachesBounds(first, last)) {
+        are_bounds_stale_ = true;
+    }
+}
+
+std::size_t GridEngine::memoryUsage() const {
+    const auto size = current().getSize();
+    return 2 * size.row * (size.col * sizeof(Cell) + sizeof(std::vector<Cell>));
+}
+
+std::uint64_t GridEngine::population() const {
+    if (is_counting_) {
+        return statistics_.population;
+    }
+    std::uint64_t result = 0;
+    for (std::size_t i = 0; i < current().rows(); i++) {
+        const auto* row = current().row(i);
+        for (std::size_t j = 0; j < current().columns(); j++) {
+            result += row[j].data;
+        }
+    }
+    return result;
+}
+
+void GridEngine::load(const Grid& grid) {
+    assert(grid.rows() == current().rows() && grid.columns() == current().columns());
+    generations_.current() = grid;
+    if (is_hashing_) {
+        hash_ = hashGrid(grid);
+    }
+    if (is_counting_) {
+        statistics_ = countGrid(grid);
+        are_bounds_stale_ = false;
+        statistics_.generation = generation_;
+    }
+}
+
+void GridEngine::save(Grid& grid) const {
+    assert(grid.rows() == current().rows() && grid.columns() == current().columns());
+    grid = current();
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "double_buffer.h"
+#include "engine.h"
+#include "grid.h"
+#include "thread_pool.h"
+#include <functional>
+
+// The plain engine: a double-buffered byte-per-cell torus stepped in row
+// bands on a thread pool.
+class GridEngine : public Engine {
+public:
+    GridEngine(std::size_t rows,
+               std::size_t columns,
+               std::size_t threads = 1,
+               const Rule& rule = life_rule)
+        : generations_{rows, columns}
+        , thread_pool_{threads}
+        , rule_{rule} {}
+
+    std::string_view name() const override { return "grid"; }
+
+    void step(std::uint64_t generations) override;
+    std::uint64_t generation() const override { return generation_; }
+
+    bool get(Index ind) const override { return current().at(ind).data; }
+    void set(Index ind, bool alive) override;
+
+    std::uint64_t population() const override;
+    std::size_t memoryUsage() const override;
+
+    bool trackHash() override;
+    std::uint64_t hash() const override { return hash_; }
+
+    // Edits keep the counts exact. Killing cells on the edge of the bounding
+    // box takes a pass over the board to shrink it, once it is asked for.
+    bool trackStatistics() override;
+    BoardStatistics boardStatistics() const override;
+
+    void load(const Grid& grid) override;
+    void save(Grid& grid) const override;
+
+    // Lets `edit` change the current generation in place, as long as it only
+    // changes the rectangle at `origin` of `extent` cells laid out by
+    // forEachSpan(). The hash and the bookkeeping of derived engines are only
+    // updated for that rectangle.
+    void edit(Index origin, Index extent, const std::function<void(Grid&)>& edit);
+
+    // Read access to the current generation. Edits go through set(), load()
+    // and edit() so derived engines can keep track of them.
+    const Grid& current() const { return generations_.current(); }
+    // The generation current() was stepped from, until the board is edited.
+    const Grid& previous() const { return generations_.next(); }
+
+    std::size_t threadCount() const { return thread_pool_.threadCount(); }
+
+    const Rule& rule() const { return rule_; }
+
+protected:
+    // Called when the live cells within [first, last) may have died, with the
+    // population already counted down.
+    void markBoundsKilled(Index first, Index last);
+
+    // Called after edit() changed cells of the rectangle.
+    virtual void markEdited(Index /*origin*/, Index /*extent*/) {}
+
+    DoubleBuffer<Grid> generations_;
+    ThreadPool thread_pool_;
+    Rule rule_;
+
+    std::uint64_t generation_ = 0;
+
+    bool is_hashing_ = false;
+    std::uint64_t hash_ = 0;
+
+    bool is_counting_ = false;
+    mutable BoardStatistics statistics_;
+    // Set when an edit killed cells on the edge of the bounding box.
+    mutable bool are_bounds_stale_ = false;
+};
@@ -0,0 +1,430 @@
+#include "hashlife.h"
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <stdexcept>
+
+namespace {
+
+constexpr unsigned initial_level = 3;
+
+}  // namespace
+
+std::size_t HashLifeEngine::NodeKeyHash::operator()(const NodeKey& key) const {
+    std::size_t hash = 0;
+    for (const auto* child : {key.nw, key.ne, key.sw, key.se}) {
+        hash = hash * 0x9e3779b97f4a7c15ULL + std::hash<const Node*>{}(child);
+    }
+    return hash ^ (hash >> 29);
+}
+
+HashLifeEngine::HashLifeEngine(std::size_t node_limit, const Rule& rule)
+    : dead_leaf_{.nw = nullptr,
+                 .ne = nullptr,
+                 .sw = nullptr,
+                 .se = nullptr,
+                 .population = 0,
+                 .result = nullptr,
+                 .level = 0,
+                 .result_exponent = -1,
+                 .block = 0,
+                 .marked = false}
+    , alive_leaf_{dead_leaf_}
+    , node_limit_{node_limit}
+    , next_collection_{node_limit}
+    , rule_{rule} {
+    // With B0 empty space comes alive, the plane would be infinitely full.
+    if (rule.birth & 1) {
+        throw std::runtime_error("HashLife does not support rules with B0");
+    }
+    alive_leaf_.population = 1;
+    empty_nodes_.push_back(&dead_leaf_);
+
+    root_ = getEmptyNode(initial_level);
+    origin_x_ = -(Coord{1} << (initial_level - 1));
+    origin_y_ = origin_x_;
+}
+
+HashLifeEngine::Node* HashLifeEngine::makeNode(Node* nw, Node* ne, Node* sw, Node* se) {
+    const NodeKey key{nw, ne, sw, se};
+    if (const auto it = table_.find(key); it != table_.end()) {
+        return it->second;
+    }
+
+    if (free_nodes_.empty()) {
+        allocateBlock();
+    }
+    Node* node = free_nodes_.back();
+    free_nodes_.pop_back();
+
+    *node = {.nw = nw,
+             .ne = ne,
+             .sw = sw,
+             .se = se,
+             .population = nw->population + ne->population + sw->population
+                           + se->population,
+             .result = nullptr,
+             .level = nw->level + 1,
+             .result_exponent = -1,
+             .block = node->block,
+             .marked = false};
+    table_.emplace(key, node);
+    return node;
+}
+
+void HashLifeEngine::allocateBlock() {
+    auto slot = std::ranges::find_if(blocks_, [](const auto& block) { return !block; });
+    if (slot == blocks_.end()) {
+        slot = blocks_.emplace(slot);
+    }
+    // Value-initialized, so every node starts out free at level 0.
+    *slot = std::make_unique<Node[]>(block_nodes);
+    const auto block = static_cast<std::uint32_t>(slot - blocks_.begin());
+    for (auto i = block_nodes; i-- > 0;) {
+        (*slot)[i].block = block;
+        free_nodes_.push_back(&(*slot)[i]);
+    }
+}
+
+HashLifeEngine::Node* HashLifeEngine::getEmptyNode(unsigned level) {
+    while (empty_nodes_.size() <= level) {
+        auto* child = empty_nodes_.back();
+        empty_nodes_.push_back(makeNode(child, child, child, child));
+    }
+    return empty_nodes_[level];
+}
+
+HashLifeEngine::Node* HashLifeEngine::getCentre(const Node* node) {
+    return makeNode(node->nw->se, node->ne->sw, node->sw->ne, node->se->nw);
+}
+
+HashLifeEngine::Node* HashLifeEngine::getHorizontalCentre(const Node* west,
+                                                          const Node* east) {
+    return makeNode(west->ne, east->nw, west->se, east->sw);
+}
+
+HashLifeEngine::Node* HashLifeEngine::getVerticalCentre(const Node* north,
+                                                        const Node* south) {
+    return makeNode(north->sw, north->se, south->nw, south->ne);
+}
+
+HashLifeEngine::Node* HashLifeEngine::computeLevel2Result(const Node* node) {
+    // Gather the 4x4 block into bits, row-major with bit 0 at the upper left.
+    unsigned bits = 0;
+    const Node* quadrants[] = {node->nw, node->ne, node->sw, node->se};
+    for (unsigned q = 0; q < 4; q++) {
+        const Node* leaves[] = {
+            quadrants[q]->nw, quadrants[q]->ne, quadrants[q]->sw, quadrants[q]->se};
+        for (unsigned l = 0; l < 4; l++) {
+            const auto x = (q % 2) * 2 + l % 2;
+            const auto y = (q / 2) * 2 + l / 2;
+            bits |= static_cast<unsigned>(leaves[l]->population) << (y * 4 + x);
+        }
+    }
+
+    const auto computeCell = [this, bits](unsigned x, unsigned y) {
+        unsigned sum = 0;
+        for (unsigned i = y - 1; i <= y + 1; i++) {
+            for (unsigned j = x - 1; j <= x + 1; j++) {
+                sum += (bits >> (i * 4 + j)) & 1;
+            }
+        }
+        const bool alive = (bits >> (y * 4 + x)) & 1;
+        return rule_.getNextState(alive, sum);
+    };
+
+    const auto leaf = [this](bool alive) { return alive ? &alive_leaf_ : &dead_leaf_; };
+    return makeNode(leaf(computeCell(1, 1)),
+                    leaf(computeCell(2, 1)),
+                    leaf(computeCell(1, 2)),
+                    leaf(computeCell(2, 2)));
+}
+
+HashLifeEngine::Node* HashLifeEngine::computeResult(Node* node, unsigned exponent) {
+    // A node of level k can be advanced by at most 2^(k - 2) generations.
+    const auto level = node->level;
+    const auto effective = std::min(exponent, level - 2);
+
+    if (node->population == 0) {
+        return getEmptyNode(level - 1);
+    }
+    if (node->result != nullptr
+        && node->result_exponent == static_cast<int>(effective)) {
+        return node->result;
+    }
+
+    // Every node this result is built from is pinned until it is done, so
+    // collecting garbage here or further down the recursion keeps them.
+    const auto pinned = pinned_.size();
+    pinned_.push_back(node);
+    collectIfFull();
+
+    Node* result = nullptr;
+    if (level == 2) {
+        result = computeLevel2Result(node);
+    } else {
+        Node* parts[3][3] = {
+            {node->nw, getHorizontalCentre(node->nw, node->ne), node->ne},
+            {getVerticalCentre(node->nw, node->sw),
+             getCentre(node),
+             getVerticalCentre(node->ne, node->se)},
+            {node->sw, getHorizontalCentre(node->sw, node->se), node->se},
+        };
+        for (const auto& row : parts) {
+            pinned_.insert(pinned_.end(), std::begin(row), std::end(row));
+        }
+
+        // At full speed both halves of the jump advance the parts, otherwise
+        // the first half only crops them to their centres.
+        for (auto& row : parts) {
+            for (auto& part : row) {
+                part = effective == level - 2 ? computeResult(part, exponent)
+                                              : getCentre(part);
+                pinned_.push_back(part);
+            }
+        }
+
+        const auto advance = [&](unsigned i, unsigned j) {
+            auto* quarter = computeResult(makeNode(parts[i][j],
+                                                   parts[i][j + 1],
+                                                   parts[i + 1][j],
+                                                   parts[i + 1][j + 1]),
+                                          exponent);
+            pinned_.push_back(quarter);
+            return quarter;
+        };
+        auto* nw = advance(0, 0);
+        auto* ne = advance(0, 1);
+        auto* sw = advance(1, 0);
+        auto* se = advance(1, 1);
+        result = makeNode(nw, ne, sw, se);
+    }
+    pinned_.resize(pinned);
+
+    node->result = result;
+    node->result_exponent = static_cast<int>(effective);
+    return result;
+}
+
+void HashLifeEngine::expand() {
+    const auto level = root_->level;
+    auto* empty = getEmptyNode(level - 1);
+
+    root_ = makeNode(makeNode(empty, empty, empty, root_->nw),
+                     makeNode(empty, empty, root_->ne, empty),
+                     makeNode(empty, root_->sw, empty, empty),
+                     makeNode(root_->se, empty, empty, empty));
+
+    origin_x_ -= Coord{1} << (level - 1);
+    origin_y_ -= Coord{1} << (level - 1);
+}
+
+bool HashLifeEngine::isPaddedFor(unsigned exponent) const {
+    // The result only covers the centre half of the root, and the pattern
+    // grows by at most one cell per generation. Keeping it inside the centre
+    // quarter with a root of level exponent + 3 leaves enough margin.
+    if (root_->level < exponent + 3) {
+        return false;
+    }
+    const auto inner_population = root_->nw->se->se->population
+                                  + root_->ne->sw->sw->population
+                                  + root_->sw->ne->ne->population
+                                  + root_->se->nw->nw->population;
+    return inner_population == root_->population;
+}
+
+void HashLifeEngine::step(std::uint64_t generations) {
+    for (unsigned exponent = 0; generations != 0; exponent++, generations >>= 1) {
+        if (generations & 1) {
+            stepPowerOfTwo(exponent);
+        }
+    }
+}
+
+void HashLifeEngine::stepPowerOfTwo(unsigned exponent) {
+    assert(exponent <= max_step_exponent);
+
+    collectIfFull();
+
+    while (!isPaddedFor(exponent)) {
+        expand();
+    }
+
+    const auto level = root_->level;
+    root_ = computeResult(root_, exponent);
+    origin_x_ += Coord{1} << (level - 2);
+    origin_y_ += Coord{1} << (level - 2);
+    generation_ += std::uint64_t{1} << exponent;
+}
+
+bool HashLifeEngine::getCell(Coord x, Coord y) const {
+    const auto size = Coord{1} << root_->level;
+    if (x < origin_x_ || y < origin_y_ || x >= origin_x_ + size
+        || y >= origin_y_ + size) {
+        return false;
+    }
+
+    auto rel_x = static_cast<std::uint64_t>(x - origin_x_);
+    auto rel_y = static_cast<std::uint64_t>(y - origin_y_);
+    const Node* node = root_;
+    while (node->level > 0 && node->population > 0) {
+        const auto half = std::uint64_t{1} << (node->level - 1);
+        const bool east = rel_x >= half;
+        const bool south = rel_y >= half;
+        node = south ? (east ? node->se : node->sw) : (east ? node->ne : node->nw);
+        rel_x -= east ? half : 0;
+        rel_y -= south ? half : 0;
+    }
+    return node->population > 0;
+}
+
+void HashLifeEngine::setCell(Coord x, Coord y, bool alive) {
+    const auto isInside = [&] {
+        const auto size = Coord{1} << root_->level;
+        return x >= origin_x_ && y >= origin_y_ && x < origin_x_ + size
+               && y < origin_y_ + size;
+    };
+    while (!isInside()) {
+        expand();
+    }
+
+    root_ = setCell(root_,
+                    static_cast<std::uint64_t>(x - origin_x_),
+                    static_cast<std::uint64_t>(y - origin_y_),
+                    alive);
+}
+
+void HashLifeEngine::load(const Grid& grid) {
+    // Setting dead cells in an empty universe would only build empty nodes.
+    if (population() != 0) {
+        Engine::load(grid);
+        return;
+    }
+    for (std::size_t i = 0; i < grid.rows(); i++) {
+        for (std::size_t j = 0; j < grid.columns(); j++) {
+            if (grid.at({i, j}).data) {
+                set({i, j}, true);
+            }
+        }
+    }
+}
+
+HashLifeEngine::Node*
+HashLifeEngine::setCell(Node* node, std::uint64_t x, std::uint64_t y, bool alive) {
+    if (node->level == 0) {
+        return alive ? &alive_leaf_ : &dead_leaf_;
+    }
+
+    const auto half = std::uint64_t{1} << (node->level - 1);
+    const bool east = x >= half;
+    const bool south = y >= half;
+    const auto child_x = east ? x - half : x;
+    const auto child_y = south ? y - half : y;
+
+    auto* nw = node->nw;
+    auto* ne = node->ne;
+    auto* sw = node->sw;
+    auto* se = node->se;
+    auto*& child = south ? (east ? se : sw) : (east ? ne : nw);
+    child = setCell(child, child_x, child_y, alive);
+    return makeNode(nw, ne, sw, se);
+}
+
+std::size_t HashLifeEngine::memoryUsage() const {
+    // Every table entry is a separately allocated hash node holding the key,
+    // the value, a next pointer and the cached hash.
+    constexpr auto entry_size
+        = sizeof(NodeKey) + sizeof(Node*) + sizeof(void*) + sizeof(std::size_t);
+    const auto blocks = std::ranges::count_if(
+        blocks_, [](const auto& block) { return block != nullptr; });
+    return static_cast<std::size_t>(blocks) * block_nodes * sizeof(Node)
+           + table_.bucket_count() * sizeof(void*) + table_.size() * entry_size;
+}
+
+void HashLifeEngine::printStatistics(std::ostream& out) const {
+    out << "nodes: " << nodeCount() << '\n'
+        << "memory: " << memoryUsage() / (1024 * 1024) << " MiB\n";
+}
+
+void HashLifeEngine::collectGarbage() {
+    sweep();
+
+    if (nodeCount() > node_limit_ / 2) {
+        for (auto& [key, node] : table_) {
+            node->result = nullptr;
+            node->result_exponent = -1;
+        }
+        sweep();
+    }
+    releaseEmptyBlocks();
+    next_collection_ = std::max(node_limit_, 2 * nodeCount());
+}
+
+void HashLifeEngine::collectIfFull() {
+    if (nodeCount() > next_collection_) {
+        collectGarbage();
+    }
+}
+
+void HashLifeEngine::markNode(Node* node) {
+    if (node == nullptr || node->marked || node->level == 0) {
+        return;
+    }
+    node->marked = true;
+    markNode(node->nw);
+    markNode(node->ne);
+    markNode(node->sw);
+    markNode(node->se);
+    markNode(node->result);
+}
+
+void HashLifeEngine::sweep() {
+    markNode(root_);
+    for (auto* node : empty_nodes_) {
+        markNode(node);
+    }
+    for (auto* node : pinned_) {
+        markNode(node);
+    }
+
+    for (auto it = table_.begin(); it != table_.end();) {
+        auto* node = it->second;
+        if (node->marked) {
+            node->marked = false;
+            ++it;
+        } else {
+            node->level = 0;
+            it = table_.erase(it);
+        }
+    }
+}
+
+void HashLifeEngine::releaseEmptyBlocks() {
+    std::vector<std::size_t> live(blocks_.size(), 0);
+    for (const auto& [key, node] : table_) {
+        live[node->block]++;
+    }
+
+    // Free nodes are handed out from the fullest blocks first, which drains
+    // the emptier ones so a later collection can release them as well.
+    std::vector<std::uint32_t> kept;
+    for (std::uint32_t block = 0; block < blocks_.size(); block++) {
+        if (live[block] == 0) {
+            blocks_[block].reset();
+        } else if (blocks_[block] != nullptr) {
+            kept.push_back(block);
+        }
+    }
+    std::ranges::sort(kept, {}, [&](std::uint32_t block) { return live[block]; });
+
+    free_nodes_.clear();
+    for (const auto block : kept) {
+        for (std::size_t i = block_nodes; i-- > 0;) {
+            auto* node = &blocks_[block][i];
+            if (node->level == 0) {
+                free_nodes_.push_back(node);
+            }
+        }
+    }
+    free_nodes_.shrink_to_fit();
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "engine.h"
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Gosper's HashLife on an unbounded plane: the universe is a quadtree of
+// hash-consed canonical nodes, and the RESULT of every node (its centre half
+// advanced by a power of two generations) is memoized on the node itself, so
+// repetitive patterns can be advanced by 2^k generations per call.
+//
+// Cells are addressed by signed plane coordinates, Index maps to the
+// non-negative quadrant with `row` as y and `col` as x.
+class HashLifeEngine : public Engine {
+public:
+    using Coord = std::int64_t;
+
+    static constexpr std::size_t default_node_limit = std::size_t{1} << 22;
+    static constexpr unsigned max_step_exponent = 56;
+
+    // Garbage is collected once more than `node_limit` nodes are alive, also
+    // in the middle of a jump, between the results of one level and the next.
+    // Throws for rules with B0, which fill the empty plane.
+    explicit HashLifeEngine(std::size_t node_limit = default_node_limit,
+                            const Rule& rule = life_rule);
+
+    HashLifeEngine(const HashLifeEngine&) = delete;
+    HashLifeEngine& operator=(const HashLifeEngine&) = delete;
+
+    std::string_view name() const override { return "hashlife"; }
+
+    void step(std::uint64_t generations) override;
+    std::uint64_t generation() const override { return generation_; }
+
+    // Advances the universe by 2^exponent generations in a single jump.
+    void stepPowerOfTwo(unsigned exponent);
+
+    bool get(Index ind) const override {
+        return getCell(static_cast<Coord>(ind.col), static_cast<Coord>(ind.row));
+    }
+    void set(Index ind, bool alive) override {
+        setCell(static_cast<Coord>(ind.col), static_cast<Coord>(ind.row), alive);
+    }
+
+    bool getCell(Coord x, Coord y) const;
+    void setCell(Coord x, Coord y, bool alive);
+
+    std::uint64_t population() const override { return root_->population; }
+
+    void load(const Grid& grid) override;
+
+    void printStatistics(std::ostream& out) const override;
+
+    std::size_t nodeCount() const { return table_.size(); }
+    std::size_t nodeLimit() const { return node_limit_; }
+
+    // Approximate heap usage of the node blocks and the hash table.
+    std::size_t memoryUsage() const override;
+
+    // Frees every node that is not reachable from the current universe or a
+    // result being computed. If that is not enough to get well below the
+    // limit, memoized results are dropped too. Blocks of nodes left without a
+    // live one are given back to the system.
+    void collectGarbage();
+
+private:
+    struct Node {
+        Node* nw;
+        Node* ne;
+        Node* sw;
+        Node* se;
+        std::uint64_t population;
+        Node* result;
+        unsigned level;
+        int result_exponent;
+        // Index into `blocks_`. Free nodes have level 0, like the leaves,
+        // which are never stored in a block.
+        std::uint32_t block;
+        bool marked;
+    };
+
+    struct NodeKey {
+        const Node* nw;
+        const Node* ne;
+        const Node* sw;
+        const Node* se;
+
+        bool operator==(const NodeKey&) const = default;
+    };
+
+    struct NodeKeyHash {
+        std::size_t operator()(const NodeKey& key) const;
+    };
+
+    Node* makeNode(Node* nw, Node* ne, Node* sw, Node* se);
+    Node* getEmptyNode(unsigned level);
+
+    Node* getCentre(const Node* node);
+    Node* getHorizontalCentre(const Node* west, const Node* east);
+    Node* getVerticalCentre(const Node* north, const Node* south);
+
+    Node* computeLevel2Result(const Node* node);
+    Node* computeResult(Node* node, unsigned exponent);
+
+    Node* setCell(Node* node, std::uint64_t x, std::uint64_t y, bool alive);
+
+    void expand();
+    bool isPaddedFor(unsigned exponent) const;
+
+    // Collects garbage if the table grew past the next collection.
+    void collectIfFull();
+    void markNode(Node* node);
+    void sweep();
+    void releaseEmptyBlocks();
+    void allocateBlock();
+
+    static constexpr std::size_t block_nodes = 4096;
+
+    // Nodes are allocated in blocks, so a block can be freed once garbage
+    // collection left none of its nodes alive. Released blocks leave a null
+    // slot behind, which keeps the index of every other block.
+    std::vector<std::unique_ptr<Node[]>> blocks_;
+    std::vector<Node*> free_nodes_;
+    std::unordered_map<NodeKey, Node*, NodeKeyHash> table_;
+    std::vector<Node*> empty_nodes_;
+
+    Node dead_leaf_;
+    Node alive_leaf_;
+
+    Node* root_;
+    // Nodes of the results in progress during a jump, which are only
+    // reachable from the recursion.
+    std::vector<Node*> pinned_;
+    Coord origin_x_;
+    Coord origin_y_;
+
+    std::size_t node_limit_;
+    // Node count that triggers the next collection. After one that could not
+    // get below the limit it is twice the nodes left, so a jump needing more
+    // than the limit does not collect over and over.
+    std::size_t next_collection_;
+    Rule rule_;
+    std::uint64_t generation_ = 0;
+};
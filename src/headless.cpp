@@ -0,0 +1,254 @@
+#include "headless.h"
+#include "control_server.h"
+#include "domain.h"
+#include "ensemble.h"
+#include "pattern.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+Grid makeInitialBoard(const RunOptions& options) {
+    if (!options.pattern.empty()) {
+        const auto pattern = readPattern(options.pattern);
+        Grid board{std::max<std::size_t>(options.board_height, pattern.rows()),
+                   std::max<std::size_t>(options.board_width, pattern.columns())};
+        placePatternCentred(pattern, board);
+        return board;
+    }
+
+    Grid board{options.board_height, options.board_width};
+    fillRandom(board, options.density, options.seed);
+    return board;
+}
+
+HeadlessReport runHeadless(Engine& engine,
+                           std::uint64_t generations,
+                           std::uint64_t cells,
+                           std::optional<HeadlessCheckpoints> checkpoints,
+                           bool stop_on_cycle,
+                           std::optional<HeadlessExport> frames,
+                           std::optional<HeadlessStatistics> statistics) {
+    const auto start = std::chrono::steady_clock::now();
+
+    const bool has_checkpoints = checkpoints && checkpoints->every > 0;
+    std::optional<Grid> board;
+    if (has_checkpoints) {
+        board.emplace(checkpoints->board_size.row, checkpoints->board_size.col);
+    }
+    const auto first_generation = has_checkpoints ? checkpoints->first_generation : 0;
+
+    std::optional<CycleDetector> detector;
+    if (stop_on_cycle && engine.trackHash()) {
+        detector.emplace();
+        detector->update(0, engine.hash());
+    }
+    std::optional<Cycle> cycle;
+
+    const bool has_frames = frames && frames->every > 0;
+    if (has_frames) {
+        frames->exporter.exportFrame(engine);
+    }
+
+    const auto writeStatistics = [&](std::uint64_t done) {
+        auto counts = engine.boardStatistics();
+        counts.generation = statistics->first_generation + done;
+        writeStatisticsCsvRow(statistics->csv, counts);
+    };
+    if (statistics) {
+        writeStatisticsCsvHeader(statistics->csv);
+        writeStatistics(0);
+    }
+
+    // Generations of the run done so far.
+    std::uint64_t done = 0;
+    while (done < generations) {
+        auto steps = generations - done;
+        if (detector || statistics) {
+            steps = 1;
+        } else {
+            if (has_checkpoints) {
+                const auto every = checkpoints->every;
+                steps = std::min(steps, every - (first_generation + done) % every);
+            }
+            if (has_frames) {
+                steps = std::min(steps, frames->every - done % frames->every);
+            }
+        }
+        engine.step(steps);
+        done += steps;
+
+        if (detector) {
+            cycle = detector->update(done, engine.hash());
+            if (cycle) {
+                // Whole periods lead back to the same board.
+                done += (generations - done) / cycle->period * cycle->period;
+                detector.reset();
+            }
+        }
+        if (has_checkpoints && (first_generation + done) % checkpoints->every == 0) {
+            engine.save(*board);
+            checkpoints->writer.save(*board, first_generation + done);
+        }
+        if (has_frames && done % frames->every == 0) {
+            frames->exporter.exportFrame(engine);
+        }
+        if (statistics) {
+            writeStatistics(done);
+        }
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    return {.generations = generations,
+            .seconds = std::chrono::duration<double>(elapsed).count(),
+            .cells = cells,
+            .population = engine.population(),
+            .cycle = cycle};
+}
+
+void printReport(std::ostream& out, const Engine& engine, const HeadlessReport& report) {
+    printReport(out, engine.name(), report);
+    engine.printStatistics(out);
+}
+
+void printReport(std::ostream& out,
+                 std::string_view engine_name,
+                 const HeadlessReport& report) {
+    out << "engine: " << engine_name << '\n'
+        << "generations: " << report.generations << '\n'
+        << "time: " << report.seconds << " s\n"
+        << "generations/sec: " << report.generationsPerSecond() << '\n'
+        << "cell updates/sec: " << report.cellUpdatesPerSecond() << '\n'
+        << "final population: " << report.population << '\n';
+    if (report.cycle) {
+        out << "stabilized at generation " << report.cycle->start << " with period "
+            << report.cycle->period << '\n';
+    }
+}
+
+void serveHeadless(const RunOptions& options) {
+    if (options.engine != "grid") {
+        std::cerr << "the control server steps the grid engine, or the sparse one with "
+                     "--plane\n";
+    }
+    auto [board, first_generation] = options.resume.empty()
+                                         ? Snapshot{makeInitialBoard(options), 0}
+                                         : readCheckpoint(options.resume);
+    Simulation simulation{board.rows(),
+                          board.columns(),
+                          options.threads,
+                          options.rule,
+                          options.plane ? Topology::plane : Topology::torus};
+    // There is no stepping back without a window.
+    simulation.post(Simulation::SetHistoryLimit{0});
+    simulation.post(Simulation::LoadPattern{std::move(board), first_generation});
+    if (options.checkpoint_every > 0) {
+        simulation.post(Simulation::SetCheckpoints{.path = options.checkpoint_file,
+                                                   .every = options.checkpoint_every});
+    }
+
+    ControlServer server{simulation, options.control};
+    std::cout << "serving on " << server.path() << '\n' << std::flush;
+    server.waitForShutdown();
+}
+
+void runHeadless(const RunOptions& options) {
+    if (!options.control.empty()) {
+        serveHeadless(options);
+        return;
+    }
+    const bool is_domain_run = options.domains_across > 0 && options.domains_down > 0;
+    const bool is_single_run = options.ensemble == 0 && !is_domain_run;
+    if (!options.export_path.empty() && !is_single_run) {
+        std::cerr << "frame export is not supported by ensemble and domain runs\n";
+    }
+    if (!options.stats_csv.empty() && !is_single_run) {
+        std::cerr << "statistics are not supported by ensemble and domain runs\n";
+    }
+    if (options.ensemble > 0) {
+        runEnsemble(options);
+        return;
+    }
+    if (is_domain_run) {
+        runDomains(options);
+        return;
+    }
+    const auto [board, first_generation] = options.resume.empty()
+                                               ? Snapshot{makeInitialBoard(options), 0}
+                                               : readCheckpoint(options.resume);
+    auto engine
+        = makeEngine(options.engine, board.getSize(), options.threads, options.rule);
+    engine->load(board);
+
+    std::optional<CheckpointWriter> writer;
+    std::optional<HeadlessCheckpoints> checkpoints;
+    if (options.checkpoint_every > 0) {
+        writer.emplace(options.checkpoint_file);
+        checkpoints.emplace(HeadlessCheckpoints{.writer = *writer,
+                                                .every = options.checkpoint_every,
+                                                .board_size = board.getSize(),
+                                                .first_generation = first_generation});
+    }
+
+    std::optional<FrameExporter> exporter;
+    std::optional<HeadlessExport> frames;
+    if (!options.export_path.empty()) {
+        exporter.emplace(options.export_path,
+                         board.getSize(),
+                         getFrameFormat(options.export_format, options.export_path));
+        frames.emplace(
+            HeadlessExport{.exporter = *exporter, .every = options.export_every});
+    }
+    // Frames streamed to stdout leave the report to stderr.
+    auto& out = options.export_path == "-" ? std::cerr : std::cout;
+
+    if (options.stop_on_cycle && !engine->trackHash()) {
+        std::cerr << "cycle detection is not supported by the " << engine->name()
+                  << " engine\n";
+    }
+
+    std::ofstream csv;
+    std::optional<HeadlessStatistics> statistics;
+    if (!options.stats_csv.empty() && !engine->trackStatistics()) {
+        std::cerr << "statistics are not supported by the " << engine->name()
+                  << " engine\n";
+    } else if (!options.stats_csv.empty()) {
+        csv.open(options.stats_csv);
+        if (!csv) {
+            throw std::runtime_error("could not open statistics file "
+                                     + options.stats_csv);
+        }
+        statistics.emplace(
+            HeadlessStatistics{.csv = csv, .first_generation = first_generation});
+    }
+    const auto report = runHeadless(*engine,
+                                    options.generations,
+                                    board.rows() * board.columns(),
+                                    checkpoints,
+                                    options.stop_on_cycle,
+                                    frames,
+                                    statistics);
+    printReport(out, *engine, report);
+    if (writer) {
+        writer->flush();
+        writer->printStatistics(out);
+        out << "checkpoint share of run time: "
+            << report.percentOfRunTime(writer->statistics().stall_seconds) << " %\n";
+    }
+    if (statistics && !csv.flush()) {
+        throw std::runtime_error("could not write statistics file " + options.stats_csv);
+    }
+    if (exporter) {
+        exporter->flush();
+        exporter->printStatistics(out);
+        out << "export share of run time: "
+            << report.percentOfRunTime(exporter->statistics().stall_seconds) << " %\n";
+    }
+
+    if (!options.dump.empty()) {
+        Grid final_board{board.rows(), board.columns()};
+        engine->save(final_board);
+        writePattern(options.dump, final_board, options.rule);
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "checkpoint.h"
+#include "cycle_detector.h"
+#include "engine.h"
+#include "frame_export.h"
+#include "options.h"
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string_view>
+
+struct HeadlessReport {
+    std::uint64_t generations;
+    double seconds;
+    std::uint64_t cells;
+    std::uint64_t population;
+    // The repeating board found when stopping on cycles, in generations
+    // counted from the start of the run.
+    std::optional<Cycle> cycle;
+
+    // Rates and shares are 0 for a run that took no measurable time, such as
+    // one of 0 generations.
+    double generationsPerSecond() const { return perSecond(generations); }
+    double cellUpdatesPerSecond() const { return perSecond(generations * cells); }
+    // Percentage of the run time that `part_seconds` took.
+    double percentOfRunTime(double part_seconds) const {
+        return seconds > 0 ? 100 * part_seconds / seconds : 0;
+    }
+
+private:
+    double perSecond(double count) const { return seconds > 0 ? count / seconds : 0; }
+};
+
+// Builds the initial board described by `options`: the pattern file in the
+// middle of the board if one is given, a random board otherwise. The board
+// grows to fit a pattern larger than the requested size.
+Grid makeInitialBoard(const RunOptions& options);
+
+// Checkpoints written while a headless run steps, whenever the generation is a
+// multiple of `every`.
+struct HeadlessCheckpoints {
+    CheckpointWriter& writer;
+    std::uint64_t every;
+    Index board_size;
+    // Generation of the board the run starts from.
+    std::uint64_t first_generation;
+};
+
+// Frames exported while a headless run steps: the board the run starts from,
+// then every `every` generations of the run.
+struct HeadlessExport {
+    FrameExporter& exporter;
+    std::uint64_t every;
+};
+
+// Counts of every generation of a headless run written as CSV rows, see
+// board_statistics.h, the board the run starts from included. The engine
+// has to track them.
+struct HeadlessStatistics {
+    std::ostream& csv;
+    // Generation of the board the run starts from.
+    std::uint64_t first_generation;
+};
+
+// Steps `engine` by `generations`. With `stop_on_cycle`, an engine that can
+// track its hash is stepped one generation at a time until the board
+// repeats; the remaining whole periods are then skipped, so the final board
+// is the same as without. Checkpoints and frames of skipped generations are
+// not written. Writing statistics steps one generation at a time.
+HeadlessReport runHeadless(Engine& engine,
+                           std::uint64_t generations,
+                           std::uint64_t cells,
+                           std::optional<HeadlessCheckpoints> checkpoints = std::nullopt,
+                           bool stop_on_cycle = false,
+                           std::optional<HeadlessExport> frames = std::nullopt,
+                           std::optional<HeadlessStatistics> statistics = std::nullopt);
+
+void printReport(std::ostream& out, const Engine& engine, const HeadlessReport& report);
+void printReport(std::ostream& out,
+                 std::string_view engine_name,
+                 const HeadlessReport& report);
+
+// Steps the board of `options` in the background and serves the control socket
+// it names until a client sends "shutdown", without a window.
+void serveHeadless(const RunOptions& options);
+
+// Runs a whole headless session: set up or resume the board, step it while
+// writing checkpoints, frames and statistics, print the report and dump the
+// final board if requested. If `options` asks for an ensemble, sub-domains or
+// a control socket, runs the ensemble or the domain processes or serves the
+// socket instead.
+void runHeadless(const RunOptions& options);
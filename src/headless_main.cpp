@@ -0,0 +1,9 @@
+#include "headless.h"
+#include "options.h"
+#include <cstdlib>
+
+int main(int argc, char** argv) {
+    runHeadless(parseOptions(argc, argv));
+
+    return EXIT_SUCCESS;
+}
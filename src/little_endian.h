@@ -0,0 +1,20 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// File formats store 64-bit words little-endian, whatever the host byte order.
+inline std::uint64_t toLittleEndian(std::uint64_t word) {
+    if constexpr (std::endian::native == std::endian::big) {
+        return std::byteswap(word);
+    }
+    return word;
+}
+
+inline std::uint64_t readLittleEndian(const std::byte* data) {
+    std::uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+    return toLittleEndian(word);
+}
@@ -1,10 +1,15 @@
-﻿#include "options.h"
+﻿#include "headless.h"
+#include "options.h"
 #include "utility.h"
 #include <cstdlib>
 
 int main(int argc, char** argv) {
     const auto options = parseOptions(argc, argv);
-    runGame(options);
+    if (options.headless) {
+        runHeadless(options);
+    } else {
+        runGame(options);
+    }
 
     return EXIT_SUCCESS;
 }
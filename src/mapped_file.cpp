@@ -0,0 +1,98 @@
+#include "mapped_file.h"
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::string& path) {
+    file_ = CreateFileA(path.c_str(),
+                        GENERIC_READ,
+                        FILE_SHARE_READ,
+                        nullptr,
+                        OPEN_EXISTING,
+                        FILE_FLAG_SEQUENTIAL_SCAN,
+                        nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("could not open " + path);
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size)) {
+        CloseHandle(file_);
+        throw std::runtime_error("could not read the size of " + path);
+    }
+    size_ = static_cast<std::size_t>(size.QuadPart);
+    if (size_ == 0) {
+        return;
+    }
+
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ == nullptr) {
+        CloseHandle(file_);
+        throw std::runtime_error("could not map " + path);
+    }
+    data_ = static_cast<const std::byte*>(
+        MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (data_ == nullptr) {
+        CloseHandle(mapping_);
+        CloseHandle(file_);
+        throw std::runtime_error("could not map " + path);
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_ != nullptr) {
+        CloseHandle(mapping_);
+    }
+    CloseHandle(file_);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("could not open " + path);
+    }
+
+    struct stat status {};
+    if (fstat(fd, &status) != 0) {
+        close(fd);
+        throw std::runtime_error("could not read the size of " + path);
+    }
+    size_ = static_cast<std::size_t>(status.st_size);
+    if (size_ == 0) {
+        close(fd);
+        return;
+    }
+
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file alive on its own.
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("could not map " + path);
+    }
+    madvise(data, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const std::byte*>(data);
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        munmap(const_cast<std::byte*>(data_), size_);
+    }
+}
+
+#endif
@@ -0,0 +1,128 @@
+#include "metrics.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+constexpr std::array<Scope, scope_count> all_scopes = {Scope::step,
+                                                      Scope::publish,
+                                                      Scope::seek,
+                                                      Scope::events,
+                                                      Scope::imgui,
+                                                      Scope::render,
+                                                      Scope::frame};
+constexpr std::array<Counter, counter_count> all_counters = {Counter::generation,
+                                                            Counter::population,
+                                                            Counter::engine_bytes,
+                                                            Counter::frame_bytes};
+
+}  // namespace
+
+std::string_view toString(Scope scope) {
+    switch (scope) {
+    case Scope::step:
+        return "step";
+    case Scope::publish:
+        return "publish";
+    case Scope::seek:
+        return "seek";
+    case Scope::events:
+        return "events";
+    case Scope::imgui:
+        return "imgui";
+    case Scope::render:
+        return "render";
+    case Scope::frame:
+        return "frame";
+    }
+    return "unknown";
+}
+
+std::string_view toString(Counter counter) {
+    switch (counter) {
+    case Counter::generation:
+        return "generation";
+    case Counter::population:
+        return "population";
+    case Counter::engine_bytes:
+        return "engine_bytes";
+    case Counter::frame_bytes:
+        return "frame_bytes";
+    }
+    return "unknown";
+}
+
+TimingSummary Metrics::summarize(Scope scope) const {
+    const auto values = timings(scope);
+    if (values.empty()) {
+        return {.samples = 0, .mean_ms = 0, .max_ms = 0};
+    }
+    const auto sum = std::accumulate(values.begin(), values.end(), std::uint64_t{0});
+    const auto count = static_cast<double>(values.size());
+    return {.samples = values.size(),
+            .mean_ms = static_cast<double>(sum) / count / 1e6,
+            .max_ms = static_cast<double>(std::ranges::max(values)) / 1e6};
+}
+
+double RateMeter::update(std::uint64_t count, Clock::time_point now) {
+    if (!is_started_ || count < start_count_) {
+        is_started_ = true;
+        start_count_ = count;
+        start_time_ = now;
+        return rate_;
+    }
+    const auto elapsed = now - start_time_;
+    if (elapsed >= interval_) {
+        rate_ = static_cast<double>(count - start_count_)
+                / std::chrono::duration<double>(elapsed).count();
+        start_count_ = count;
+        start_time_ = now;
+    }
+    return rate_;
+}
+
+void writeMetricsCsv(std::ostream& out, const Metrics& metrics) {
+    out << "kind,name,index,value\n";
+    for (const auto scope : all_scopes) {
+        const auto values = metrics.timings(scope);
+        for (std::size_t i = 0; i < values.size(); i++) {
+            out << "timing," << toString(scope) << ',' << i << ',' << values[i] << '\n';
+        }
+    }
+    for (const auto counter : all_counters) {
+        out << "counter," << toString(counter) << ",," << metrics.get(counter) << '\n';
+    }
+}
+
+void writeMetricsJson(std::ostream& out, const Metrics& metrics) {
+    out << "{\n  \"timings_ns\": {";
+    for (std::size_t s = 0; s < all_scopes.size(); s++) {
+        out << (s == 0 ? "\n" : ",\n") << "    \"" << toString(all_scopes[s]) << "\": [";
+        const auto values = metrics.timings(all_scopes[s]);
+        for (std::size_t i = 0; i < values.size(); i++) {
+            out << (i == 0 ? "" : ", ") << values[i];
+        }
+        out << ']';
+    }
+    out << "\n  },\n  \"counters\": {";
+    for (std::size_t c = 0; c < all_counters.size(); c++) {
+        out << (c == 0 ? "\n" : ",\n") << "    \"" << toString(all_counters[c])
+            << "\": " << metrics.get(all_counters[c]);
+    }
+    out << "\n  }\n}\n";
+}
+
+void writeMetrics(const std::string& path, const Metrics& metrics) {
+    std::ofstream out{path};
+    if (!out) {
+        throw std::runtime_error("could not open metrics file " + path);
+    }
+    if (std::filesystem::path{path}.extension() == ".json") {
+        writeMetricsJson(out, metrics);
+    } else {
+        writeMetricsCsv(out, metrics);
+    }
+}
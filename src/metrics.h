@@ -0,0 +1,117 @@
+#pragma once
+
+#include "sample_ring.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Timed parts of the program. The simulation thread times steps and
+// publishing frames, the render thread everything else, a whole frame
+// included.
+enum class Scope { step, publish, seek, events, imgui, render, frame };
+inline constexpr std::size_t scope_count = 7;
+
+// Values sampled by the simulation thread.
+enum class Counter { generation, population, engine_bytes, frame_bytes };
+inline constexpr std::size_t counter_count = 4;
+
+std::string_view toString(Scope scope);
+std::string_view toString(Counter counter);
+
+struct TimingSummary {
+    std::size_t samples;
+    double mean_ms;
+    double max_ms;
+};
+
+// Timings of the latest runs of every scope plus a few counters. Each scope
+// and counter has a single writer thread, reading is allowed from any thread
+// and nothing ever locks. Recording a timing costs two clock reads and two
+// atomic stores, cheap enough to leave on for every step.
+class Metrics {
+public:
+    static constexpr std::size_t timings_kept = 256;
+
+    void record(Scope scope, std::chrono::nanoseconds duration) {
+        timings_[static_cast<std::size_t>(scope)].push(
+            static_cast<std::uint64_t>(duration.count()));
+    }
+    void set(Counter counter, std::uint64_t value) {
+        counters_[static_cast<std::size_t>(counter)].store(value,
+                                                          std::memory_order_relaxed);
+    }
+
+    // The latest durations of a scope in nanoseconds, oldest first.
+    std::vector<std::uint64_t> timings(Scope scope) const {
+        return timings_[static_cast<std::size_t>(scope)].latest();
+    }
+    // Number of times a scope was ever timed.
+    std::uint64_t timingCount(Scope scope) const {
+        return timings_[static_cast<std::size_t>(scope)].count();
+    }
+    TimingSummary summarize(Scope scope) const;
+
+    std::uint64_t get(Counter counter) const {
+        return counters_[static_cast<std::size_t>(counter)].load(
+            std::memory_order_relaxed);
+    }
+
+private:
+    std::array<SampleRing<timings_kept>, scope_count> timings_;
+    std::array<std::atomic<std::uint64_t>, counter_count> counters_{};
+};
+
+// Times the enclosing block.
+class ScopedTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    ScopedTimer(Metrics& metrics, Scope scope)
+        : metrics_{metrics}
+        , scope_{scope}
+        , start_{Clock::now()} {}
+    ~ScopedTimer() { metrics_.record(scope_, Clock::now() - start_); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Metrics& metrics_;
+    Scope scope_;
+    Clock::time_point start_;
+};
+
+// Rate of a growing count per second, averaged over at least `interval` so
+// that it does not jitter from frame to frame.
+class RateMeter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::chrono::milliseconds default_interval{500};
+
+    RateMeter() = default;
+    explicit RateMeter(std::chrono::milliseconds interval) : interval_{interval} {}
+
+    // Returns the latest rate, 0 until the first interval is over.
+    double update(std::uint64_t count, Clock::time_point now);
+
+private:
+    std::chrono::milliseconds interval_ = default_interval;
+    bool is_started_ = false;
+    std::uint64_t start_count_ = 0;
+    Clock::time_point start_time_;
+    double rate_ = 0;
+};
+
+// One row per value: "timing,<scope>,<index>,<nanoseconds>" for the kept
+// timings and "counter,<name>,,<value>" for the counters.
+void writeMetricsCsv(std::ostream& out, const Metrics& metrics);
+// {"timings_ns": {"<scope>": [...]}, "counters": {"<name>": value}}
+void writeMetricsJson(std::ostream& out, const Metrics& metrics);
+// Writes JSON for a .json file and CSV for any other.
+void writeMetrics(const std::string& path, const Metrics& metrics);
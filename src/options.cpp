@@ -1,6 +1,7 @@
 #include "options.h"
 #include <cstdlib>
 #include <cxxopts.hpp>
+#include <stdexcept>
 #include <tuple>
 
 std::pair<unsigned, unsigned>
@@ -11,6 +12,23 @@ getScreenDimensionsFromOption(std::string_view window_size) {
     return std::make_pair(std::stoul(width_str), std::stoul(height_str));
 }
 
+std::vector<double> parseDensities(std::string_view densities) {
+    std::vector<double> result;
+    while (!densities.empty()) {
+        const auto split_pos = densities.find(',');
+        const auto text = std::string(densities.substr(0, split_pos));
+        char* end = nullptr;
+        const auto density = std::strtod(text.c_str(), &end);
+        if (text.empty() || *end != '\0' || density < 0 || density > 1) {
+            throw std::runtime_error("invalid density: " + text);
+        }
+        result.push_back(density);
+        densities = split_pos == std::string_view::npos ? std::string_view{}
+                                                        : densities.substr(split_pos + 1);
+    }
+    return result;
+}
+
 RunOptions parseOptions(int argc, char** argv) {
     cxxopts::Options options("game_of_life",
                              "Conway's Game of Life - cellular automata simulator");
@@ -18,6 +36,84 @@ RunOptions parseOptions(int argc, char** argv) {
         ("f,fullscreen", "Run in fullscreen", cxxopts::value<bool>()->default_value("false"))
         ("w,window", "Window size", cxxopts::value<std::string>()->default_value("1280x800"))
         ("c,cell", "Grid cell size in pixels", cxxopts::value<unsigned>()->default_value("50"))
+        ("plane",
+         "Play on an unbounded plane that can be moved around with WASD "
+         "instead of a torus",
+         cxxopts::value<bool>()->default_value("false"))
+        ("t,threads",
+         "Simulation threads, 0 for one per hardware thread",
+         cxxopts::value<unsigned>()->default_value("0"))
+        ("headless",
+         "Run the simulation without a window and report its speed",
+         cxxopts::value<bool>()->default_value("false"))
+        ("s,size",
+         "Board size, by default as large as the window fits",
+         cxxopts::value<std::string>()->default_value("1024x1024"))
+        ("seed",
+         "Seed of the random headless board",
+         cxxopts::value<std::uint64_t>()->default_value("0"))
+        ("density",
+         "Alive cell density of the random headless board",
+         cxxopts::value<double>()->default_value("0.5"))
+        ("p,pattern",
+         "Pattern file (.cells, .rle or .gol snapshot) placed in the middle "
+         "of the board instead",
+         cxxopts::value<std::string>()->default_value(""))
+        ("g,generations",
+         "Generations to run in headless mode",
+         cxxopts::value<std::uint64_t>()->default_value("1000"))
+        ("dump",
+         "File to write the final headless board to, in the format of its extension; "
+         "hashlife and sparse runs only save the board-sized window at the origin",
+         cxxopts::value<std::string>()->default_value(""))
+        ("e,engine",
+         "Stepping engine: grid, tiled, active, sparse or hashlife",
+         cxxopts::value<std::string>()->default_value("grid"))
+        ("stop-on-cycle",
+         "Detect when the headless board repeats and skip the remaining periods",
+         cxxopts::value<bool>()->default_value("false"))
+        ("ensemble",
+         "Run N random boards per density headless until they repeat and "
+         "print a CSV row for each",
+         cxxopts::value<std::uint64_t>()->default_value("0"))
+        ("ensemble-densities",
+         "Comma separated densities of the ensemble boards, by default --density",
+         cxxopts::value<std::string>()->default_value(""))
+        ("domains",
+         "Split the headless board into AxD sub-domains, each stepped by its own process",
+         cxxopts::value<std::string>()->default_value(""))
+        ("r,rule",
+         "Life-like rule in B/S notation, such as B36/S23 for HighLife",
+         cxxopts::value<std::string>()->default_value("B3/S23"))
+        ("export",
+         "Stream the headless run as a frame sequence to a file, - for stdout",
+         cxxopts::value<std::string>()->default_value(""))
+        ("export-format",
+         "Frame format, pbm or y4m, by default from the extension of --export",
+         cxxopts::value<std::string>()->default_value(""))
+        ("export-every",
+         "Export every Nth generation",
+         cxxopts::value<std::uint64_t>()->default_value("1"))
+        ("stats-csv",
+         "Write the population, births, deaths and bounding box of every headless "
+         "generation to a CSV file",
+         cxxopts::value<std::string>()->default_value(""))
+        ("control",
+         "Serve requests to drive the simulation on a Unix domain socket; headless, "
+         "serve until a client sends shutdown",
+         cxxopts::value<std::string>()->default_value(""))
+        ("history-mib",
+         "Memory for stepping back through past generations in the window, 0 to disable",
+         cxxopts::value<std::size_t>()->default_value("256"))
+        ("checkpoint-every",
+         "Write a checkpoint every N generations, 0 to disable",
+         cxxopts::value<std::uint64_t>()->default_value("0"))
+        ("checkpoint-file",
+         "File the checkpoints are written to",
+         cxxopts::value<std::string>()->default_value("game_of_life.ckpt"))
+        ("resume",
+         "Checkpoint file to resume a run from",
+         cxxopts::value<std::string>()->default_value(""))
         ("help", "Print application usage");
 
     try {
@@ -32,10 +128,57 @@ RunOptions parseOptions(int argc, char** argv) {
         std::tie(result.screen_width, result.screen_height)
             = getScreenDimensionsFromOption(opts_result["window"].as<std::string>());
         result.cell_size = opts_result["cell"].as<unsigned>();
+        result.threads = opts_result["threads"].as<unsigned>();
+        result.plane = opts_result["plane"].as<bool>();
+
+        result.ensemble = opts_result["ensemble"].as<std::uint64_t>();
+        result.ensemble_densities
+            = parseDensities(opts_result["ensemble-densities"].as<std::string>());
+        const auto domains = opts_result["domains"].as<std::string>();
+        if (!domains.empty()) {
+            std::tie(result.domains_across, result.domains_down)
+                = getScreenDimensionsFromOption(domains);
+        }
+        result.headless = opts_result["headless"].as<bool>() || result.ensemble > 0
+                          || !domains.empty();
+        std::tie(result.board_width, result.board_height)
+            = getScreenDimensionsFromOption(opts_result["size"].as<std::string>());
+        if (!result.headless && opts_result.count("size") == 0) {
+            result.board_width = 0;
+            result.board_height = 0;
+        }
+        result.seed = opts_result["seed"].as<std::uint64_t>();
+        result.density = opts_result["density"].as<double>();
+        result.pattern = opts_result["pattern"].as<std::string>();
+        result.generations = opts_result["generations"].as<std::uint64_t>();
+        result.dump = opts_result["dump"].as<std::string>();
+        result.engine = opts_result["engine"].as<std::string>();
+        result.stop_on_cycle = opts_result["stop-on-cycle"].as<bool>();
+        result.rule = parseRule(opts_result["rule"].as<std::string>());
+
+        result.export_path = opts_result["export"].as<std::string>();
+        result.export_format = opts_result["export-format"].as<std::string>();
+        result.export_every = opts_result["export-every"].as<std::uint64_t>();
+        if (result.export_every == 0) {
+            throw std::runtime_error("--export-every has to be at least 1");
+        }
+
+        result.stats_csv = opts_result["stats-csv"].as<std::string>();
+
+        result.control = opts_result["control"].as<std::string>();
+
+        result.history_mib = opts_result["history-mib"].as<std::size_t>();
+
+        result.checkpoint_every = opts_result["checkpoint-every"].as<std::uint64_t>();
+        result.checkpoint_file = opts_result["checkpoint-file"].as<std::string>();
+        result.resume = opts_result["resume"].as<std::string>();
 
         return result;
     } catch (const cxxopts::OptionParseException& e) {
         std::cout << "Error: " << e.what();
         std::exit(EXIT_FAILURE);
+    } catch (const std::runtime_error& e) {
+        std::cout << "Error: " << e.what();
+        std::exit(EXIT_FAILURE);
     }
 }
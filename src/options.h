@@ -1,15 +1,63 @@
 #pragma once
 
+#include "rule.h"
+#include <cstdint>
 #include <string>
 #include <utility>
+#include <vector>
 
 struct RunOptions {
     bool fullscreen;
     unsigned screen_width;
     unsigned screen_height;
     unsigned cell_size;
+    unsigned threads;
+    bool plane;
+
+    bool headless;
+    // 0 x 0 in a window unless given, which fits the board to the window.
+    unsigned board_width;
+    unsigned board_height;
+    std::uint64_t seed;
+    double density;
+    std::string pattern;
+    std::uint64_t generations;
+    std::string dump;
+    std::string engine;
+    bool stop_on_cycle;
+    Rule rule;
+    // Random boards per density, a headless ensemble run if non-zero.
+    std::uint64_t ensemble;
+    // Densities of the ensemble, just `density` if empty.
+    std::vector<double> ensemble_densities;
+    // Sub-domains across and down the board, each stepped by its own process
+    // in a headless run if both are non-zero.
+    unsigned domains_across;
+    unsigned domains_down;
+
+    // Frame sequence of a headless run, "-" for stdout, none if empty. The
+    // format is "pbm" or "y4m", or taken from the extension if empty.
+    std::string export_path;
+    std::string export_format;
+    std::uint64_t export_every;
+    // CSV file of the counts of every generation of a headless run, none if
+    // empty.
+    std::string stats_csv;
+
+    // Unix domain socket a control server listens on, none if empty.
+    std::string control;
+
+    // Memory cap of the generation history in the window, 0 disables it.
+    std::size_t history_mib;
+
+    std::uint64_t checkpoint_every;
+    std::string checkpoint_file;
+    std::string resume;
 };
 
 std::pair<unsigned, unsigned> getScreenDimensionsFromOption(std::string_view window_size);
 
+// Comma separated densities such as "0.1,0.35", each in [0, 1].
+std::vector<double> parseDensities(std::string_view densities);
+
 RunOptions parseOptions(int argc, char** argv);
@@ -0,0 +1,141 @@
+#include "packed_grid.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+namespace {
+
+using Word = PackedGrid::Word;
+
+// Bit i of `west`/`east` holds the cell to the west/east of bit i of `centre`.
+struct RowWords {
+    Word west;
+    Word centre;
+    Word east;
+};
+
+RowWords getRowWords(const Word* words,
+                     std::size_t ind,
+                     std::size_t words_count,
+                     std::size_t columns) {
+    const auto last = words_count - 1;
+    const auto last_bit = (columns - 1) % PackedGrid::word_bits;
+
+    // Row ends wrap around: the west neighbour of the first word is the last
+    // column and the east neighbour of the last column is the first one.
+    const Word west_carry = ind > 0 ? words[ind - 1] >> (PackedGrid::word_bits - 1)
+                                    : (words[last] >> last_bit) & 1;
+    const Word east_carry = ind < last ? words[ind + 1] << (PackedGrid::word_bits - 1)
+                                       : (words[0] & 1) << last_bit;
+
+    return {.west = (words[ind] << 1) | west_carry,
+            .centre = words[ind],
+            .east = (words[ind] >> 1) | east_carry};
+}
+
+void addFull(Word a, Word b, Word c, Word& sum, Word& carry) {
+    const Word half = a ^ b;
+    sum = half ^ c;
+    carry = (a & b) | (half & c);
+}
+
+// Computes B3/S23 for 64 cells at once with bit-sliced adders.
+Word computeWord(RowWords up, RowWords mid, RowWords down) {
+    Word s1, c1, s2, c2;
+    addFull(up.west, up.centre, up.east, s1, c1);
+    addFull(mid.west, mid.east, down.west, s2, c2);
+    const Word s3 = down.centre ^ down.east;
+    const Word c3 = down.centre & down.east;
+
+    Word ones, c4;
+    addFull(s1, s2, s3, ones, c4);
+
+    // The neighbour count is `ones + 2 * (c1 + c2 + c3 + c4)`, so it is 2 or 3
+    // exactly when one of the four carries is set.
+    const Word one_carry = (c1 ^ c2 ^ c3 ^ c4) & ~((c1 & c2) | (c3 & c4));
+    return one_carry & (ones | mid.centre);
+}
+
+// One byte per cell for each byte of packed cells, so cells are unpacked
+// eight at a time.
+static_assert(sizeof(Cell) == 1);
+constexpr auto unpacked_bytes = [] {
+    std::array<std::array<unsigned char, 8>, 256> table{};
+    for (std::size_t bits = 0; bits < table.size(); bits++) {
+        for (std::size_t j = 0; j < 8; j++) {
+            table[bits][j] = (bits >> j) & 1;
+        }
+    }
+    return table;
+}();
+
+}  // namespace
+
+void packCells(const Cell* cells, std::size_t count, Word* words) {
+    constexpr auto word_bits = PackedGrid::word_bits;
+    std::fill_n(words, (count + word_bits - 1) / word_bits, 0);
+
+    std::size_t j = 0;
+    if constexpr (std::endian::native == std::endian::little) {
+        // Eight cells are eight bytes of 0 or 1. The multiplication gathers
+        // the low bit of byte i into bit 56 + i without any carries.
+        for (; j + 8 <= count; j += 8) {
+            std::uint64_t bytes;
+            std::memcpy(&bytes, cells + j, sizeof(bytes));
+            const Word bits = (bytes * 0x0102040810204080) >> 56;
+            words[j / word_bits] |= bits << (j % word_bits);
+        }
+    }
+    for (; j < count; j++) {
+        words[j / word_bits] |= Word{cells[j].data} << (j % word_bits);
+    }
+}
+
+void unpackCells(const Word* words, std::size_t count, Cell* cells) {
+    constexpr auto word_bits = PackedGrid::word_bits;
+
+    std::size_t j = 0;
+    for (; j + 8 <= count; j += 8) {
+        const auto bits = (words[j / word_bits] >> (j % word_bits)) & 0xff;
+        std::memcpy(cells + j, unpacked_bytes[bits].data(), 8);
+    }
+    for (; j < count; j++) {
+        cells[j].data = (words[j / word_bits] >> (j % word_bits)) & 1;
+    }
+}
+
+PackedGrid::PackedGrid(const Grid& grid) : PackedGrid(grid.rows(), grid.columns()) {
+    for (std::size_t i = 0; i < rows_; i++) {
+        packCells(grid.row(i), columns_, row(i));
+    }
+}
+
+Grid PackedGrid::toGrid() const {
+    Grid grid{rows_, columns_};
+    for (std::size_t i = 0; i < rows_; i++) {
+        unpackCells(row(i), columns_, grid.row(i));
+    }
+    return grid;
+}
+
+void PackedGrid::step(PackedGrid& next) const {
+    assert(next.rows() == rows_ && next.columns() == columns_);
+
+    const auto tail_bits = columns_ % word_bits;
+    const Word last_mask = tail_bits == 0 ? ~Word{0} : (Word{1} << tail_bits) - 1;
+
+    for (std::size_t i = 0; i < rows_; i++) {
+        const Word* up = row(i == 0 ? rows_ - 1 : i - 1);
+        const Word* mid = row(i);
+        const Word* down = row(i == rows_ - 1 ? 0 : i + 1);
+        Word* out = next.row(i);
+
+        for (std::size_t w = 0; w < words_per_row_; w++) {
+            out[w] = computeWord(getRowWords(up, w, words_per_row_, columns_),
+                                 getRowWords(mid, w, words_per_row_, columns_),
+                                 getRowWords(down, w, words_per_row_, columns_));
+        }
+        out[words_per_row_ - 1] &= last_mask;
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "grid.h"
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+// Bit-packed alternative to Grid: 64 cells per word, one contiguous row-major
+// buffer. Each row starts on a word boundary, the unused high bits of the last
+// word of a row are always kept at zero.
+class PackedGrid {
+public:
+    using Word = std::uint64_t;
+    static constexpr std::size_t word_bits = 64;
+
+    PackedGrid(std::size_t rows, std::size_t columns)
+        : rows_{rows}
+        , columns_{columns}
+        , words_per_row_{(columns + word_bits - 1) / word_bits}
+        , words_(rows * words_per_row_, 0) {
+        assert(columns > 0 && rows > 0);
+    }
+
+    explicit PackedGrid(const Grid& grid);
+
+    std::size_t rows() const { return rows_; }
+
+    std::size_t columns() const { return columns_; }
+
+    std::size_t wordsPerRow() const { return words_per_row_; }
+
+    Index getSize() const { return {.row = rows(), .col = columns()}; }
+
+    bool get(Index ind) const {
+        return (row(ind.row)[ind.col / word_bits] >> (ind.col % word_bits)) & 1;
+    }
+
+    void set(Index ind, bool value) {
+        const auto mask = Word{1} << (ind.col % word_bits);
+        auto& word = row(ind.row)[ind.col / word_bits];
+        word = value ? (word | mask) : (word & ~mask);
+    }
+
+    const Word* row(std::size_t ind) const { return words_.data() + ind * words_per_row_; }
+    Word* row(std::size_t ind) { return words_.data() + ind * words_per_row_; }
+
+    Grid toGrid() const;
+
+    // Writes the next B3/S23 generation into `next`, which must have the same
+    // size. The bit-sliced adder is built for Life only.
+    void step(PackedGrid& next) const;
+
+private:
+    std::size_t rows_;
+    std::size_t columns_;
+    std::size_t words_per_row_;
+
+    std::vector<Word> words_;
+};
+
+// Packs `count` cells into the first (count + 63) / 64 words in the PackedGrid
+// row layout, the unused high bits of the last word are cleared.
+void packCells(const Cell* cells, std::size_t count, PackedGrid::Word* words);
+
+// Unpacks `count` cells packed by packCells().
+void unpackCells(const PackedGrid::Word* words, std::size_t count, Cell* cells);
@@ -0,0 +1,252 @@
+#include "pattern.h"
+#include "snapshot.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::size_t readRleSize(const std::string& value, const std::string& line) {
+    std::size_t size = 0;
+    const auto* end = value.data() + value.size();
+    const auto [ptr, error] = std::from_chars(value.data(), end, size);
+    if (error != std::errc{} || ptr != end) {
+        throw std::runtime_error("RLE header has an invalid pattern size: " + line);
+    }
+    return size;
+}
+
+// Patterns with more cells are rejected before their grid is allocated, a
+// header a few digits off would otherwise take all memory.
+constexpr std::size_t max_rle_cells = std::size_t{1} << 32;
+
+// Parses the `x = 3, y = 3, rule = B3/S23` header of an RLE file.
+Index readRleHeader(const std::string& line) {
+    std::size_t rows = 0;
+    std::size_t columns = 0;
+
+    std::string field;
+    std::istringstream fields{line};
+    while (std::getline(fields, field, ',')) {
+        std::erase_if(field, [](unsigned char c) { return std::isspace(c); });
+        const auto split_pos = field.find('=');
+        if (split_pos == std::string::npos) {
+            continue;
+        }
+        const auto key = field.substr(0, split_pos);
+        const auto value = field.substr(split_pos + 1);
+        if (key == "x") {
+            columns = readRleSize(value, line);
+        } else if (key == "y") {
+            rows = readRleSize(value, line);
+        }
+    }
+
+    if (rows == 0 || columns == 0) {
+        throw std::runtime_error("RLE header has no pattern size: " + line);
+    }
+    if (rows > max_rle_cells / columns) {
+        throw std::runtime_error("RLE header has a pattern size that is too large: "
+                                 + line);
+    }
+    return {.row = rows, .col = columns};
+}
+
+std::string getExtension(const std::string& path) {
+    auto extension = std::filesystem::path{path}.extension().string();
+    std::ranges::transform(extension, extension.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return extension;
+}
+
+}  // namespace
+
+Grid readPlaintext(std::istream& in) {
+    std::vector<std::string> lines;
+    std::size_t columns = 0;
+
+    for (std::string line; std::getline(in, line);) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty() && line.front() == '!') {
+            continue;
+        }
+        columns = std::max(columns, line.size());
+        lines.push_back(std::move(line));
+    }
+
+    if (lines.empty() || columns == 0) {
+        throw std::runtime_error("plaintext pattern is empty");
+    }
+
+    Grid grid{lines.size(), columns};
+    for (std::size_t i = 0; i < lines.size(); i++) {
+        for (std::size_t j = 0; j < lines[i].size(); j++) {
+            grid.at({i, j}).data = lines[i][j] == 'O' || lines[i][j] == '*';
+        }
+    }
+    return grid;
+}
+
+void writePlaintext(std::ostream& out, const Grid& grid) {
+    for (std::size_t i = 0; i < grid.rows(); i++) {
+        for (std::size_t j = 0; j < grid.columns(); j++) {
+            out << (grid.at({i, j}).data ? 'O' : '.');
+        }
+        out << '\n';
+    }
+}
+
+Grid readRle(std::istream& in) {
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.front() != '#') {
+            break;
+        }
+    }
+    if (line.empty() || line.front() != 'x') {
+        throw std::runtime_error("RLE pattern has no header");
+    }
+
+    const auto size = readRleHeader(line);
+    Grid grid{size.row, size.col};
+
+    std::size_t row = 0;
+    std::size_t col = 0;
+    std::size_t count = 0;
+    for (char c; in.get(c) && c != '!';) {
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            count = count * 10 + static_cast<std::size_t>(c - '0');
+            continue;
+        }
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            continue;
+        }
+
+        const auto run = std::max<std::size_t>(count, 1);
+        count = 0;
+        if (c == '$') {
+            row += run;
+            col = 0;
+        } else if (c == 'b' || c == '.') {
+            col += run;
+        } else {
+            // 'o' and the state letters of multi-state patterns are all alive.
+            if (row >= grid.rows() || col + run > grid.columns()) {
+                throw std::runtime_error("RLE pattern exceeds the size of its header");
+            }
+            std::fill_n(grid.row(row) + col, run, Cell{true});
+            col += run;
+        }
+    }
+    return grid;
+}
+
+void writeRle(std::ostream& out, const Grid& grid, const Rule& rule) {
+    constexpr std::size_t max_line_length = 70;
+
+    out << "x = " << grid.columns() << ", y = " << grid.rows()
+        << ", rule = " << toString(rule) << '\n';
+
+    std::size_t line_length = 0;
+    const auto writeRun = [&](std::size_t run, char tag) {
+        auto token = run > 1 ? std::to_string(run) : std::string{};
+        token += tag;
+        if (line_length + token.size() > max_line_length) {
+            out << '\n';
+            line_length = 0;
+        }
+        out << token;
+        line_length += token.size();
+    };
+
+    // Dead cells at the end of a row and empty rows at the end of the pattern
+    // are implied by the header.
+    std::size_t pending_rows = 0;
+    for (std::size_t i = 0; i < grid.rows(); i++) {
+        const auto* row = grid.row(i);
+        const auto* end = row + grid.columns();
+        while (end != row && !end[-1].data) {
+            --end;
+        }
+        if (i > 0) {
+            pending_rows++;
+        }
+        if (end == row) {
+            continue;
+        }
+
+        if (pending_rows > 0) {
+            writeRun(pending_rows, '$');
+            pending_rows = 0;
+        }
+        for (const auto* cell = row; cell != end;) {
+            const auto* run_end = std::find_if(
+                cell, end, [alive = cell->data](Cell c) { return c.data != alive; });
+            writeRun(static_cast<std::size_t>(run_end - cell), cell->data ? 'o' : 'b');
+            cell = run_end;
+        }
+    }
+    writeRun(1, '!');
+    out << '\n';
+}
+
+Grid readPattern(const std::string& path) {
+    const auto extension = getExtension(path);
+    if (extension == ".gol") {
+        return readSnapshot(path).grid;
+    }
+
+    std::ifstream in{path};
+    if (!in) {
+        throw std::runtime_error("could not open pattern file " + path);
+    }
+    return extension == ".rle" ? readRle(in) : readPlaintext(in);
+}
+
+void writePattern(const std::string& path, const Grid& grid, const Rule& rule) {
+    const auto extension = getExtension(path);
+    if (extension == ".gol") {
+        writeSnapshot(path, grid);
+        return;
+    }
+
+    std::ofstream out{path};
+    if (!out) {
+        throw std::runtime_error("could not open pattern file " + path);
+    }
+    if (extension == ".rle") {
+        writeRle(out, grid, rule);
+    } else {
+        writePlaintext(out, grid);
+    }
+}
+
+void placePattern(const Grid& pattern, Grid& target, Index offset) {
+    forEachSpan(target.getSize(),
+                offset,
+                pattern.getSize(),
+                [&](Index cell, Index from, std::size_t count) {
+                    std::copy_n(pattern.row(from.row) + from.col,
+                                count,
+                                target.row(cell.row) + cell.col);
+                });
+}
+
+void placePatternCentred(const Grid& pattern, Grid& target) {
+    const auto centre = [](std::size_t target_size, std::size_t pattern_size) {
+        return target_size > pattern_size ? (target_size - pattern_size) / 2 : 0;
+    };
+    placePattern(pattern,
+                 target,
+                 {centre(target.rows(), pattern.rows()),
+                  centre(target.columns(), pattern.columns())});
+}
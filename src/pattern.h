@@ -0,0 +1,35 @@
+#pragma once
+
+#include "grid.h"
+#include <istream>
+#include <ostream>
+#include <string>
+
+// Reads a pattern in the plaintext `.cells` format: lines starting with '!'
+// are comments, 'O' or '*' marks an alive cell and any other character a dead
+// one. The returned grid is the bounding box of the lines.
+Grid readPlaintext(std::istream& in);
+
+void writePlaintext(std::ostream& out, const Grid& grid);
+
+// Reads a pattern in the run length encoded `.rle` format. The grid has the
+// size given by the `x = ..., y = ...` header line, the rule is ignored.
+Grid readRle(std::istream& in);
+
+// Writes `rule` into the header, it is only informational.
+void writeRle(std::ostream& out, const Grid& grid, const Rule& rule = life_rule);
+
+// Reads or writes a pattern file in the format given by its extension: `.rle`,
+// `.gol` binary snapshots (see snapshot.h) or plaintext for anything else.
+Grid readPattern(const std::string& path);
+void writePattern(const std::string& path,
+                  const Grid& grid,
+                  const Rule& rule = life_rule);
+
+// Copies `pattern` into `target` with its upper left corner at `offset`,
+// wrapping around the edges of `target`. A pattern larger than `target` is
+// cut off at its size.
+void placePattern(const Grid& pattern, Grid& target, Index offset);
+
+// Copies `pattern` into the middle of `target`.
+void placePatternCentred(const Grid& pattern, Grid& target);
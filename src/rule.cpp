@@ -0,0 +1,62 @@
+#include "rule.h"
+#include <cctype>
+#include <stdexcept>
+
+namespace {
+
+// Parses the neighbour counts of one half of a rule into a bit mask.
+std::uint16_t parseCounts(std::string_view counts, std::string_view notation) {
+    std::uint16_t mask = 0;
+    for (const char c : counts) {
+        if (c < '0' || c > '8') {
+            throw std::runtime_error("invalid rule: " + std::string(notation));
+        }
+        mask |= static_cast<std::uint16_t>(1u << (c - '0'));
+    }
+    return mask;
+}
+
+}  // namespace
+
+Rule parseRule(std::string_view notation) {
+    const auto split_pos = notation.find('/');
+    if (split_pos == std::string_view::npos) {
+        throw std::runtime_error("invalid rule: " + std::string(notation));
+    }
+    const auto first = notation.substr(0, split_pos);
+    const auto second = notation.substr(split_pos + 1);
+
+    const auto getPrefix = [](std::string_view part) {
+        return part.empty() ? '\0' : static_cast<char>(std::toupper(part.front()));
+    };
+    const auto first_prefix = getPrefix(first);
+    const auto second_prefix = getPrefix(second);
+
+    if (first_prefix == 'B' && second_prefix == 'S') {
+        return {.birth = parseCounts(first.substr(1), notation),
+                .survival = parseCounts(second.substr(1), notation)};
+    }
+    if (first_prefix == 'S' && second_prefix == 'B') {
+        return {.birth = parseCounts(second.substr(1), notation),
+                .survival = parseCounts(first.substr(1), notation)};
+    }
+    // S/B notation without letters, survival first.
+    return {.birth = parseCounts(second, notation),
+            .survival = parseCounts(first, notation)};
+}
+
+std::string toString(const Rule& rule) {
+    const auto appendCounts = [](std::string& out, std::uint16_t mask) {
+        for (char n = 0; n <= 8; n++) {
+            if ((mask >> n) & 1) {
+                out += static_cast<char>('0' + n);
+            }
+        }
+    };
+
+    std::string result = "B";
+    appendCounts(result, rule.birth);
+    result += "/S";
+    appendCounts(result, rule.survival);
+    return result;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// A Life-like rule in B/S notation: bit n of `birth` is set if a dead cell with
+// n live neighbours comes alive, bit n of `survival` if a live cell with n live
+// neighbours stays alive.
+struct Rule {
+    std::uint16_t birth;
+    std::uint16_t survival;
+
+    // The next state of a cell whose 3x3 block, the cell itself included,
+    // holds `sum` live cells. This is the sum the step kernels count.
+    constexpr bool getNextState(bool alive, unsigned sum) const {
+        if (alive) {
+            return sum > 0 && ((survival >> (sum - 1)) & 1) != 0;
+        }
+        return ((birth >> sum) & 1) != 0;
+    }
+
+    friend constexpr bool operator==(const Rule&, const Rule&) = default;
+};
+
+inline constexpr Rule life_rule{.birth = 0b1000, .survival = 0b1100};
+inline constexpr Rule highlife_rule{.birth = 0b1001000, .survival = 0b1100};
+inline constexpr Rule day_and_night_rule{.birth = 0b111001000,
+                                         .survival = 0b111011000};
+inline constexpr Rule seeds_rule{.birth = 0b100, .survival = 0};
+
+// Parses B/S notation such as "B3/S23" or "b36/s23", in either order, and the
+// older S/B notation such as "23/3". Throws on anything else.
+Rule parseRule(std::string_view notation);
+
+// The rule in B/S notation, "B3/S23" for Life.
+std::string toString(const Rule& rule);
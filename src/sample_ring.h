@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Keeps the latest `capacity` values written by one thread for any thread to
+// read, without locking. The writer never waits: a reader racing with it
+// drops the values that may have been overwritten while it copied them.
+template <std::size_t capacity>
+class SampleRing {
+public:
+    static_assert(capacity > 1);
+
+    // Writer side.
+    void push(std::uint64_t value) {
+        const auto count = count_.load(std::memory_order_relaxed);
+        // Released so that a reader seeing the new value also sees the count
+        // of the write before, and thereby knows the old value is gone.
+        values_[count % capacity].store(value, std::memory_order_release);
+        count_.store(count + 1, std::memory_order_release);
+    }
+
+    // Number of values ever pushed.
+    std::uint64_t count() const { return count_.load(std::memory_order_acquire); }
+
+    // The latest values, oldest first.
+    std::vector<std::uint64_t> latest() const {
+        const auto last = count();
+        const auto first = last > capacity ? last - capacity : 0;
+        std::vector<std::uint64_t> values;
+        values.reserve(last - first);
+        for (auto i = first; i < last; i++) {
+            values.push_back(values_[i % capacity].load(std::memory_order_relaxed));
+        }
+
+        // The writer may be filling the slot after the last count seen, so
+        // only values more than a full ring behind it are certainly intact.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const auto now = count_.load(std::memory_order_relaxed);
+        const auto first_intact = now >= capacity ? now - capacity + 1 : 0;
+        values.erase(values.begin(),
+                     values.begin() + static_cast<std::ptrdiff_t>(
+                         std::min(last, std::max(first, first_intact)) - first));
+        return values;
+    }
+
+private:
+    std::array<std::atomic<std::uint64_t>, capacity> values_{};
+    std::atomic<std::uint64_t> count_ = 0;
+};
@@ -0,0 +1,378 @@
+#include "simulation.h"
+#include "pattern.h"
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+
+Simulation::Simulation(std::size_t rows,
+                       std::size_t columns,
+                       std::size_t threads,
+                       const Rule& rule,
+                       Topology topology)
+    : torus_{topology == Topology::torus
+                 ? std::make_unique<GridEngine>(rows, columns, threads, rule)
+                 : nullptr}
+    , plane_{topology == Topology::plane
+                 ? std::make_unique<SparseTileEngine>(threads, rule)
+                 : nullptr}
+    , engine_{torus_ ? static_cast<Engine&>(*torus_) : *plane_}
+    , rule_{rule}
+    , frames_{rows, columns}
+    , view_size_{rows, columns}
+    , view_cells_{rows, columns}
+    , thread_{[this] { run(); }} {}
+
+Simulation::~Simulation() {
+    {
+        const std::lock_guard lock{mutex_};
+        stopping_ = true;
+    }
+    commands_cv_.notify_one();
+    thread_.join();
+}
+
+void Simulation::post(Command command) {
+    {
+        const std::lock_guard lock{mutex_};
+        commands_.push_back(std::move(command));
+    }
+    commands_cv_.notify_one();
+}
+
+void Simulation::run() {
+    using Clock = std::chrono::steady_clock;
+
+    auto next_step = Clock::now();
+    std::vector<Command> pending;
+    engine_.trackHash();
+    is_counting_ = engine_.trackStatistics();
+    restartCycleSearch();
+
+    while (true) {
+        {
+            std::unique_lock lock{mutex_};
+            const auto is_woken = [this] { return stopping_ || !commands_.empty(); };
+            // Generations of a Step are taken one per pass without waiting.
+            if (pending_steps_ == 0 && paused_) {
+                commands_cv_.wait(lock, is_woken);
+            } else if (pending_steps_ == 0 && !unthrottled_) {
+                commands_cv_.wait_until(lock, next_step, is_woken);
+            }
+            if (stopping_) {
+                return;
+            }
+            pending.swap(commands_);
+        }
+
+        for (const auto& command : pending) {
+            apply(command);
+        }
+        pending.clear();
+
+        const auto now = Clock::now();
+        if (pending_steps_ > 0) {
+            advance();
+            pending_steps_--;
+            if (pending_steps_ == 0) {
+                acknowledgePending();
+            }
+        } else if (!paused_ && (unthrottled_ || now >= next_step)) {
+            advance();
+            next_step = now + step_delay_;
+        }
+
+        // Unthrottled or working off a Step, the engine outruns the display by
+        // far, so a generation is only copied out once the previous one has
+        // been picked up.
+        const bool is_racing = pending_steps_ > 0 || (unthrottled_ && !paused_);
+        const bool is_frame_wanted = !is_racing || !frames_.hasUnreadFrame();
+        if (has_unpublished_changes_ && is_frame_wanted) {
+            publish();
+        }
+    }
+}
+
+void Simulation::advance() {
+    {
+        const ScopedTimer timer{metrics_, Scope::step};
+        engine_.step(1);
+    }
+    if (torus_ && history_limit_ > 0) {
+        history_.record(torus_->previous(), torus_->current(), generation());
+    }
+    has_unpublished_changes_ = true;
+    if (!cycle_) {
+        cycle_ = cycle_detector_.update(generation(), engine_.hash());
+    }
+    if (checkpoints_ && generation() % checkpoint_every_ == 0) {
+        saveCheckpoint();
+    }
+}
+
+void Simulation::apply(const Command& command) {
+    std::visit(
+        [this](const auto& cmd) {
+            using T = std::decay_t<decltype(cmd)>;
+            if constexpr (std::is_same_v<T, SetPaused>) {
+                paused_ = cmd.paused;
+                if (paused_ && pending_steps_ > 0) {
+                    pending_steps_ = 0;
+                    acknowledgePending();
+                }
+            } else if constexpr (std::is_same_v<T, SetStepDelay>) {
+                step_delay_ = cmd.delay;
+            } else if constexpr (std::is_same_v<T, SetUnthrottled>) {
+                unthrottled_ = cmd.unthrottled;
+            } else if constexpr (std::is_same_v<T, Step>) {
+                pending_steps_ += cmd.generations;
+            } else if constexpr (std::is_same_v<T, ToggleCell>) {
+                if (plane_) {
+                    const auto x = view_x_ + static_cast<std::int64_t>(cmd.cell.col);
+                    const auto y = view_y_ + static_cast<std::int64_t>(cmd.cell.row);
+                    plane_->setCell(x, y, !plane_->getCell(x, y));
+                } else {
+                    engine_.set(cmd.cell, !engine_.get(cmd.cell));
+                }
+                markEdited();
+            } else if constexpr (std::is_same_v<T, SetCells>) {
+                for (const auto cell : cmd.cells) {
+                    if (plane_) {
+                        plane_->setCell(view_x_ + static_cast<std::int64_t>(cell.col),
+                                        view_y_ + static_cast<std::int64_t>(cell.row),
+                                        cmd.alive);
+                    } else {
+                        engine_.set(cell, cmd.alive);
+                    }
+                }
+                markEdited();
+            } else if constexpr (std::is_same_v<T, FillCells>) {
+                editCells(cmd.origin, cmd.extent, [&](Grid& cells, Index origin) {
+                    fillRect(cells, origin, cmd.extent, cmd.alive);
+                });
+            } else if constexpr (std::is_same_v<T, RandomFillCells>) {
+                editCells(cmd.origin, cmd.extent, [&](Grid& cells, Index origin) {
+                    fillRandom(cells, origin, cmd.extent, cmd.density, cmd.seed);
+                });
+            } else if constexpr (std::is_same_v<T, PastePattern>) {
+                const auto paste = [&](Grid& cells, Index origin) {
+                    placePattern(cmd.pattern, cells, origin);
+                };
+                editCells(cmd.origin, cmd.pattern.getSize(), paste);
+            } else if constexpr (std::is_same_v<T, ClearBoard>) {
+                if (plane_) {
+                    plane_->clear();
+                    markEdited();
+                } else {
+                    editCells({0, 0}, view_size_, [](Grid& cells, Index) {
+                        fillRect(cells, {0, 0}, cells.getSize(), false);
+                    });
+                }
+            } else if constexpr (std::is_same_v<T, PanView>) {
+                if (plane_) {
+                    view_x_ += cmd.columns;
+                    view_y_ += cmd.rows;
+                    has_unpublished_changes_ = true;
+                }
+            } else if constexpr (std::is_same_v<T, LoadPattern>) {
+                loadPattern(cmd.pattern);
+                first_generation_ = cmd.generation - engine_.generation();
+                markEdited();
+            } else if constexpr (std::is_same_v<T, SetCheckpoints>) {
+                checkpoints_.reset();
+                checkpoint_every_ = cmd.every;
+                if (cmd.every > 0 && plane_) {
+                    std::cerr << "checkpoints disabled: they need a torus board\n";
+                } else if (cmd.every > 0) {
+                    checkpoints_ = std::make_unique<CheckpointWriter>(cmd.path);
+                }
+            } else if constexpr (std::is_same_v<T, SeekGeneration>) {
+                seek(cmd.generation);
+            } else if constexpr (std::is_same_v<T, StepBack>) {
+                seek(generation() - std::min(cmd.generations, generation()));
+            } else if constexpr (std::is_same_v<T, SetHistoryLimit>) {
+                history_limit_ = cmd.bytes;
+                history_ = GenerationHistory{GenerationHistory::default_keyframe_interval,
+                                             cmd.bytes};
+            } else if constexpr (std::is_same_v<T, Acknowledge>) {
+                if (cmd.waits_for_steps && pending_steps_ > 0) {
+                    pending_acknowledgements_.push_back(cmd);
+                } else {
+                    acknowledge(cmd);
+                }
+            }
+        },
+        command);
+}
+
+void Simulation::loadPattern(const Grid& pattern) {
+    if (torus_) {
+        Grid board{view_size_.row, view_size_.col};
+        placePatternCentred(pattern, board);
+        torus_->load(board);
+        return;
+    }
+
+    // On the plane a pattern larger than the view sticks out on all sides.
+    const auto centre = [](std::size_t view_size, std::size_t pattern_size) {
+        return (static_cast<std::int64_t>(view_size)
+                - static_cast<std::int64_t>(pattern_size))
+               / 2;
+    };
+    plane_->clear();
+    plane_->load(pattern,
+                 view_x_ + centre(view_size_.col, pattern.columns()),
+                 view_y_ + centre(view_size_.row, pattern.rows()));
+}
+
+void Simulation::editCells(Index origin,
+                           Index extent,
+                           const std::function<void(Grid& cells, Index origin)>& edit) {
+    if (extent.row == 0 || extent.col == 0) {
+        return;
+    }
+    if (torus_) {
+        torus_->edit(origin, extent, [&](Grid& board) { edit(board, origin); });
+    } else {
+        // The rectangle does not wrap on the plane, copying it out and back
+        // in only touches the tiles under it.
+        const auto x = view_x_ + static_cast<std::int64_t>(origin.col);
+        const auto y = view_y_ + static_cast<std::int64_t>(origin.row);
+        Grid cells{extent.row, extent.col};
+        plane_->save(cells, x, y);
+        edit(cells, {0, 0});
+        plane_->load(cells, x, y);
+    }
+    markEdited();
+}
+
+void Simulation::markEdited() {
+    history_.clear();
+    restartCycleSearch();
+    has_unpublished_changes_ = true;
+}
+
+void Simulation::publish() {
+    const ScopedTimer timer{metrics_, Scope::publish};
+    auto& frame = frames_.back();
+    if (torus_) {
+        frame.densities.update(frame.grid, torus_->current());
+    } else {
+        plane_->save(view_cells_, view_x_, view_y_);
+        frame.densities.update(frame.grid, view_cells_);
+    }
+    frame.generation = generation();
+    frame.view_x = view_x_;
+    frame.view_y = view_y_;
+    frame.cycle = cycle_;
+    frame.history_oldest = history_.empty() ? generation() : history_.oldest();
+    frame.history_newest = history_.empty() ? generation() : history_.newest();
+    frame.statistics.reset();
+    if (is_counting_) {
+        frame.statistics = engine_.boardStatistics();
+        frame.statistics->generation = generation();
+    }
+    frames_.publish();
+    has_unpublished_changes_ = false;
+    packed_view_.reset();
+
+    metrics_.set(Counter::generation, generation());
+    if (const auto now = std::chrono::steady_clock::now(); now >= next_counters_update_) {
+        updateCounters();
+        next_counters_update_ = now + counters_interval;
+    }
+}
+
+void Simulation::acknowledge(const Acknowledge& acknowledge) {
+    const auto snapshot = publishSnapshot(acknowledge.ticket, acknowledge.with_cells);
+    if (acknowledge.on_published) {
+        acknowledge.on_published(snapshot);
+    }
+}
+
+void Simulation::acknowledgePending() {
+    for (const auto& pending : pending_acknowledgements_) {
+        acknowledge(pending);
+    }
+    pending_acknowledgements_.clear();
+}
+
+std::shared_ptr<const SimulationSnapshot>
+Simulation::publishSnapshot(std::uint64_t ticket, bool with_cells) {
+    const ScopedTimer timer{metrics_, Scope::publish};
+    // A new snapshot every time, readers may still hold the last one.
+    auto snapshot = std::make_shared<SimulationSnapshot>();
+    snapshot->generation = generation();
+    snapshot->ticket = ticket;
+    if (is_counting_) {
+        snapshot->statistics = engine_.boardStatistics();
+        snapshot->statistics->generation = generation();
+    }
+    snapshot->population = snapshot->statistics ? snapshot->statistics->population
+                                                : engine_.population();
+    if (with_cells) {
+        snapshot->cells = packedView();
+    }
+    // The previous snapshot ends up in `published` and is freed after the lock
+    // is released, if no reader holds on to it.
+    std::shared_ptr<const SimulationSnapshot> published = snapshot;
+    {
+        const std::lock_guard lock{snapshot_mutex_};
+        snapshot_.swap(published);
+    }
+    return snapshot;
+}
+
+std::shared_ptr<const PackedGrid> Simulation::packedView() {
+    if (has_unpublished_changes_) {
+        publish();
+    }
+    if (!packed_view_) {
+        // Nothing changed since the publish, so these are the frame's cells.
+        // publish() already copied the plane's out.
+        const auto& cells = torus_ ? torus_->current() : view_cells_;
+        packed_view_ = std::make_shared<const PackedGrid>(cells);
+    }
+    return packed_view_;
+}
+
+void Simulation::seek(std::uint64_t generation) {
+    if (!torus_ || history_.empty()) {
+        return;
+    }
+    // One copy of the board each way per seek, however far it goes.
+    const ScopedTimer timer{metrics_, Scope::seek};
+    Grid board{view_size_.row, view_size_.col};
+    torus_->save(board);
+    const auto reached = history_.seek(generation, board);
+    torus_->load(board);
+    first_generation_ = reached - engine_.generation();
+    restartCycleSearch();
+    has_unpublished_changes_ = true;
+}
+
+void Simulation::restartCycleSearch() {
+    cycle_detector_.reset();
+    cycle_ = cycle_detector_.update(generation(), engine_.hash());
+}
+
+void Simulation::updateCounters() {
+    // All three frames are the same size.
+    const auto& frame = frames_.back();
+    const auto& grid = frame.grid;
+    const auto row_bytes = grid.columns() * sizeof(Cell) + sizeof(std::vector<Cell>);
+    const auto frame_bytes = grid.rows() * row_bytes + frame.densities.memoryUsage();
+    metrics_.set(Counter::population, engine_.population());
+    metrics_.set(Counter::engine_bytes, engine_.memoryUsage());
+    metrics_.set(Counter::frame_bytes, 3 * frame_bytes);
+}
+
+void Simulation::saveCheckpoint() {
+    try {
+        checkpoints_->save(torus_->current(), generation());
+    } catch (const std::exception& e) {
+        std::cerr << "checkpoints disabled: " << e.what() << '\n';
+        checkpoints_.reset();
+    }
+}
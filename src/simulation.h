@@ -0,0 +1,296 @@
+#pragma once
+
+#include "board_statistics.h"
+#include "checkpoint.h"
+#include "cycle_detector.h"
+#include "density_pyramid.h"
+#include "generation_history.h"
+#include "grid.h"
+#include "grid_engine.h"
+#include "metrics.h"
+#include "packed_grid.h"
+#include "sparse_tile_engine.h"
+#include "triple_buffer.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+// The shape of the board: a torus the size of the view, or an unbounded plane
+// the view can be moved across.
+enum class Topology { torus, plane };
+
+// A generation as seen by the render thread.
+struct SimulationFrame {
+    SimulationFrame(std::size_t rows, std::size_t columns)
+        : grid{rows, columns}
+        , densities{rows, columns} {}
+
+    // The cells in view, the whole board on a torus.
+    Grid grid;
+    // Kept up to date with `grid` on the simulation thread, so drawing the
+    // board zoomed out does not have to touch every cell.
+    DensityPyramid densities;
+    std::uint64_t generation = 0;
+    // Plane coordinates of the upper left cell in view.
+    std::int64_t view_x = 0;
+    std::int64_t view_y = 0;
+    // Set once the board repeats, until it is edited.
+    std::optional<Cycle> cycle;
+    // Generations the history can seek to, both `generation` without one.
+    std::uint64_t history_oldest = 0;
+    std::uint64_t history_newest = 0;
+    // Counts of the generation, if the engine keeps them while stepping.
+    std::optional<BoardStatistics> statistics;
+};
+
+// The board as of an Acknowledge command, for readers other than the render
+// thread. Snapshots are never changed once published, so any number of
+// readers can hold on to one while the simulation steps on.
+struct SimulationSnapshot {
+    std::uint64_t generation = 0;
+    // Of the whole board, the whole plane on one.
+    std::uint64_t population = 0;
+    std::optional<BoardStatistics> statistics;
+    std::uint64_t ticket = 0;
+    // The cells in view, only if the Acknowledge asked for them. They are
+    // packed from the last published frame and shared with later snapshots
+    // until the next frame is published.
+    std::shared_ptr<const PackedGrid> cells;
+};
+
+// Steps an engine on a thread of its own. Completed generations are
+// published through a triple buffer, so the render thread never blocks on a
+// step and a slow step never holds up a frame. Everything that changes the
+// board or the pace goes through post() and is applied between steps.
+class Simulation {
+public:
+    struct SetPaused {
+        bool paused;
+    };
+    struct SetStepDelay {
+        std::chrono::milliseconds delay;
+    };
+    // Steps as fast as possible, ignoring the step delay.
+    struct SetUnthrottled {
+        bool unthrottled;
+    };
+    // Steps the given number of generations right away, paused or not, one
+    // per pass of the simulation thread so other commands still get through.
+    // Pausing drops the generations left.
+    struct Step {
+        std::uint64_t generations;
+    };
+    // The cell is given relative to the view.
+    struct ToggleCell {
+        Index cell;
+    };
+    // Sets every one of `cells` to `alive`, relative to the view.
+    struct SetCells {
+        std::vector<Index> cells;
+        bool alive;
+    };
+    // Bulk edits of the rectangle of `extent` cells with its upper left corner
+    // at `origin` relative to the view, each applied in one pass over it. On a
+    // torus the rectangle wraps around the edges like forEachSpan().
+    struct FillCells {
+        Index origin;
+        Index extent;
+        bool alive;
+    };
+    struct RandomFillCells {
+        Index origin;
+        Index extent;
+        double density;
+        std::uint64_t seed;
+    };
+    // Copies the pattern over the board without clearing the rest of it.
+    struct PastePattern {
+        Grid pattern;
+        Index origin;
+    };
+    // Kills every cell, of the whole plane if it is one.
+    struct ClearBoard {};
+    // Moves the view across the plane, ignored on a torus.
+    struct PanView {
+        std::int64_t columns;
+        std::int64_t rows;
+    };
+    // Clears the board and places the pattern in the middle of the view,
+    // counting generations on from `generation`.
+    struct LoadPattern {
+        Grid pattern;
+        std::uint64_t generation = 0;
+    };
+    // Writes a checkpoint every `every` generations, 0 stops checkpointing.
+    // Only supported on a torus.
+    struct SetCheckpoints {
+        std::string path;
+        std::uint64_t every;
+    };
+    // Turns the board back into a recorded generation, or as close as the
+    // history reaches. Only supported on a torus.
+    struct SeekGeneration {
+        std::uint64_t generation;
+    };
+    struct StepBack {
+        std::uint64_t generations;
+    };
+    // Bytes the generation history may hold, 0 stops recording it.
+    struct SetHistoryLimit {
+        std::size_t bytes;
+    };
+    // Publishes a snapshot carrying `ticket` once every command posted before
+    // it has been applied, then hands it to `on_published` on the simulation
+    // thread. Only `with_cells` is the view packed into it. With
+    // `waits_for_steps` it is held back until every Step is done, otherwise
+    // it is published between the generations of one.
+    struct Acknowledge {
+        std::uint64_t ticket;
+        std::function<void(const std::shared_ptr<const SimulationSnapshot>&)>
+            on_published;
+        bool with_cells = false;
+        bool waits_for_steps = false;
+    };
+    using Command = std::variant<SetPaused,
+                                 SetStepDelay,
+                                 SetUnthrottled,
+                                 Step,
+                                 ToggleCell,
+                                 SetCells,
+                                 FillCells,
+                                 RandomFillCells,
+                                 PastePattern,
+                                 ClearBoard,
+                                 PanView,
+                                 LoadPattern,
+                                 SetCheckpoints,
+                                 SeekGeneration,
+                                 StepBack,
+                                 SetHistoryLimit,
+                                 Acknowledge>;
+
+    // Starts paused with a view of `rows` x `columns` cells. The torus is as
+    // large as the view, the plane starts with the view at the origin.
+    Simulation(std::size_t rows,
+               std::size_t columns,
+               std::size_t threads = 1,
+               const Rule& rule = life_rule,
+               Topology topology = Topology::torus);
+    ~Simulation();
+
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    void post(Command command);
+
+    // Picks up the newest published generation, returns whether frame()
+    // changed. Must be called from a single reader thread.
+    bool updateFrame() { return frames_.update(); }
+    const SimulationFrame& frame() const { return frames_.front(); }
+
+    // The snapshot of the last Acknowledge command, none before the first.
+    // Safe to call from any thread, the lock is only held to copy the pointer.
+    std::shared_ptr<const SimulationSnapshot> snapshot() const {
+        const std::lock_guard lock{snapshot_mutex_};
+        return snapshot_;
+    }
+
+    // Step and publish timings are recorded by the simulation thread, the
+    // render thread may add its own scopes.
+    Metrics& metrics() { return metrics_; }
+    const Metrics& metrics() const { return metrics_; }
+
+    const Rule& rule() const { return rule_; }
+    Topology topology() const { return plane_ ? Topology::plane : Topology::torus; }
+    Index viewSize() const { return view_size_; }
+
+private:
+    void run();
+    void apply(const Command& command);
+    // Steps one generation and records it.
+    void advance();
+    void loadPattern(const Grid& pattern);
+    // Applies `edit` to the board, which may only change the rectangle at
+    // `origin` of `extent` cells in view. On the plane it is handed a copy of
+    // the cells in the rectangle, with `origin` at {0, 0}.
+    void editCells(Index origin,
+                   Index extent,
+                   const std::function<void(Grid& cells, Index origin)>& edit);
+    // Forgets what the board was before an edit.
+    void markEdited();
+    void publish();
+    void acknowledge(const Acknowledge& acknowledge);
+    // Acknowledges the commands that waited for a Step to be done.
+    void acknowledgePending();
+    std::shared_ptr<const SimulationSnapshot> publishSnapshot(std::uint64_t ticket,
+                                                              bool with_cells);
+    // The cells of the last published frame, publishing one first if the
+    // board changed since.
+    std::shared_ptr<const PackedGrid> packedView();
+    void updateCounters();
+    // Starts looking for a repeating board from the current generation.
+    void restartCycleSearch();
+
+    static constexpr std::chrono::milliseconds counters_interval{250};
+    void saveCheckpoint();
+    void seek(std::uint64_t generation);
+
+    std::uint64_t generation() const { return first_generation_ + engine_.generation(); }
+
+    // Exactly one of the engines exists, `engine_` refers to it.
+    std::unique_ptr<GridEngine> torus_;
+    std::unique_ptr<SparseTileEngine> plane_;
+    Engine& engine_;
+    Rule rule_;
+    TripleBuffer<SimulationFrame> frames_;
+    mutable std::mutex snapshot_mutex_;
+    std::shared_ptr<const SimulationSnapshot> snapshot_;
+    // Packed by the first snapshot that needs the cells after a publish.
+    std::shared_ptr<const PackedGrid> packed_view_;
+    Metrics metrics_;
+
+    std::mutex mutex_;
+    std::condition_variable commands_cv_;
+    std::vector<Command> commands_;
+    bool stopping_ = false;
+
+    // Only touched by the simulation thread.
+    bool paused_ = true;
+    bool unthrottled_ = false;
+    std::chrono::milliseconds step_delay_{0};
+    Index view_size_;
+    // The cells in view on the plane, copied out before publishing.
+    Grid view_cells_;
+    std::int64_t view_x_ = 0;
+    std::int64_t view_y_ = 0;
+    bool has_unpublished_changes_ = false;
+    // Generations of Step commands still to go, and the Acknowledge commands
+    // waiting for them to be done.
+    std::uint64_t pending_steps_ = 0;
+    std::vector<Acknowledge> pending_acknowledgements_;
+    bool is_counting_ = false;
+    // Generation of the loaded pattern minus the engine's count at the time.
+    std::uint64_t first_generation_ = 0;
+    // Boards are hashed as they are stepped to spot when they repeat. The
+    // hash depends on where cells are, so a spaceship never repeats.
+    CycleDetector cycle_detector_;
+    std::optional<Cycle> cycle_;
+    std::unique_ptr<CheckpointWriter> checkpoints_;
+    std::uint64_t checkpoint_every_ = 0;
+    // Past generations of the torus, recorded after every step.
+    GenerationHistory history_;
+    std::size_t history_limit_ = GenerationHistory::default_memory_cap;
+    // Counting the population takes a pass over the board on engines that do
+    // not track it, so the counters are only refreshed a few times a second.
+    std::chrono::steady_clock::time_point next_counters_update_;
+
+    std::thread thread_;
+};
@@ -0,0 +1,84 @@
+#include "snapshot.h"
+#include "little_endian.h"
+#include "mapped_file.h"
+#include "packed_grid.h"
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using Word = PackedGrid::Word;
+constexpr std::size_t word_bits = PackedGrid::word_bits;
+constexpr std::string_view magic = "GOLSNAP1";
+constexpr std::size_t header_words = 4;
+
+}  // namespace
+
+void writeSnapshot(const std::string& path, const Grid& grid, std::uint64_t generation) {
+    std::ofstream out{path, std::ios::binary};
+    if (!out) {
+        throw std::runtime_error("could not open snapshot file " + path);
+    }
+
+    const Word header[] = {
+        toLittleEndian(grid.rows()),
+        toLittleEndian(grid.columns()),
+        toLittleEndian(generation),
+    };
+    out.write(magic.data(), magic.size());
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    const auto words_per_row = (grid.columns() + word_bits - 1) / word_bits;
+    std::vector<Word> words(words_per_row);
+    for (std::size_t i = 0; i < grid.rows(); i++) {
+        packCells(grid.row(i), grid.columns(), words.data());
+        for (auto& word : words) {
+            word = toLittleEndian(word);
+        }
+        out.write(reinterpret_cast<const char*>(words.data()),
+                  static_cast<std::streamsize>(words.size() * sizeof(Word)));
+    }
+
+    if (!out) {
+        throw std::runtime_error("could not write snapshot file " + path);
+    }
+}
+
+Snapshot readSnapshot(const std::string& path) {
+    const MappedFile file{path};
+    const auto* data = file.data();
+
+    constexpr auto header_size = header_words * sizeof(Word);
+    if (file.size() < header_size
+        || std::memcmp(data, magic.data(), magic.size()) != 0) {
+        throw std::runtime_error(path + " is not a snapshot file");
+    }
+
+    const auto rows = readLittleEndian(data + sizeof(Word));
+    const auto columns = readLittleEndian(data + 2 * sizeof(Word));
+    const auto generation = readLittleEndian(data + 3 * sizeof(Word));
+    const auto words_per_row = (columns + word_bits - 1) / word_bits;
+    const auto max_words = (std::numeric_limits<std::size_t>::max() - header_size)
+                           / sizeof(Word);
+    if (rows == 0 || columns == 0 || words_per_row > max_words / rows
+        || file.size() != header_size + rows * words_per_row * sizeof(Word)) {
+        throw std::runtime_error("snapshot file " + path + " is corrupted");
+    }
+
+    Grid grid{rows, columns};
+    std::vector<Word> words(words_per_row);
+    const auto* row_data = data + header_size;
+    for (std::size_t i = 0; i < rows; i++) {
+        for (auto& word : words) {
+            word = readLittleEndian(row_data);
+            row_data += sizeof(Word);
+        }
+        unpackCells(words.data(), columns, grid.row(i));
+    }
+
+    return {std::move(grid), generation};
+}
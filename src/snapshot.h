@@ -0,0 +1,23 @@
+#pragma once
+
+#include "grid.h"
+#include <cstdint>
+#include <string>
+
+// Compact binary board snapshots, `.gol` files. A 32 byte header of the magic
+// "GOLSNAP1" and three little-endian 64-bit words (rows, columns, generation)
+// is followed by the cells in the PackedGrid layout: each row is a whole
+// number of little-endian 64-bit words and column j is bit j % 64 of word
+// j / 64. A 16k x 16k board takes 32 MiB.
+struct Snapshot {
+    Grid grid;
+    std::uint64_t generation;
+};
+
+void writeSnapshot(const std::string& path,
+                   const Grid& grid,
+                   std::uint64_t generation = 0);
+
+// Maps the file into memory and unpacks it straight into the rows of the
+// returned grid, without reading it through a stream first.
+Snapshot readSnapshot(const std::string& path);
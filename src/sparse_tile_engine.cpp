@@ -0,0 +1,329 @@
+#include "sparse_tile_engine.h"
+#include "zobrist.h"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+constexpr std::size_t padded_size = SparseTileEngine::tile_size + 2;
+
+// Where row or column `i` of the neighbour `delta` tiles away lands in the
+// padded copy of a tile.
+std::size_t getPaddedPosition(std::size_t i, SparseTileEngine::Coord delta) {
+    using Coord = SparseTileEngine::Coord;
+    constexpr auto tile_size = static_cast<Coord>(SparseTileEngine::tile_size);
+    return static_cast<std::size_t>(static_cast<Coord>(i + 1) + delta * tile_size);
+}
+
+}  // namespace
+
+std::size_t SparseTileEngine::TileKeyHash::operator()(const TileKey& key) const {
+    const auto hash = static_cast<std::uint64_t>(key.x) * 0x9e3779b97f4a7c15ULL
+                      ^ static_cast<std::uint64_t>(key.y);
+    return std::hash<std::uint64_t>{}(hash ^ (hash >> 29));
+}
+
+SparseTileEngine::SparseTileEngine(std::size_t threads, const Rule& rule)
+    : thread_pool_{threads}
+    , rule_{rule}
+    , kernel_{getDefaultKernel(rule).compute_row} {
+    // With B0 empty space comes alive, there would be no end to the tiles.
+    if (rule.birth & 1) {
+        throw std::runtime_error("the sparse engine does not support rules with B0");
+    }
+}
+
+void SparseTileEngine::step(std::uint64_t generations) {
+    for (std::uint64_t gen = 0; gen < generations; gen++) {
+        addBorderTiles();
+
+        step_tiles_.clear();
+        for (const auto& [key, tile] : tiles_) {
+            step_tiles_.push_back(tile.get());
+        }
+
+        // The map is only read while the tiles are computed, each tile only
+        // writes its own next generation.
+        thread_pool_.parallelFor(
+            step_tiles_.size(), [this](std::size_t begin, std::size_t end) {
+                std::vector<Cell> padded(padded_size * padded_size);
+                std::vector<Cell> row(padded_size);
+                for (auto i = begin; i < end; i++) {
+                    computeTile(*step_tiles_[i], padded.data(), row.data());
+                }
+            });
+
+        current_ ^= 1;
+        for (auto* tile : step_tiles_) {
+            tile->population = tile->next_population;
+            hash_ ^= tile->hash_changes;
+        }
+        removeDeadTiles();
+        trimPool();
+        generation_++;
+    }
+}
+
+void SparseTileEngine::computeTile(Tile& tile, Cell* padded, Cell* row) const {
+    // Gather the tile with a one cell frame from its neighbours, missing
+    // neighbours are dead.
+    std::fill_n(padded, padded_size * padded_size, Cell{false});
+    for (Coord dy = -1; dy <= 1; dy++) {
+        for (Coord dx = -1; dx <= 1; dx++) {
+            const auto* neighbour = findTile({tile.x + dx, tile.y + dy});
+            if (neighbour == nullptr || neighbour->population == 0) {
+                continue;
+            }
+            // The part of the neighbour that lands inside the frame, in its
+            // own coordinates.
+            const auto first_row = dy < 0 ? tile_size - 1 : 0;
+            const auto last_row = dy > 0 ? 1 : tile_size;
+            const auto first_col = dx < 0 ? tile_size - 1 : 0;
+            const auto last_col = dx > 0 ? 1 : tile_size;
+            const auto& cells = neighbour->cells[current_];
+            const auto padded_col = getPaddedPosition(first_col, dx);
+            for (auto i = first_row; i < last_row; i++) {
+                std::copy(cells.data() + i * tile_size + first_col,
+                          cells.data() + i * tile_size + last_col,
+                          padded + getPaddedPosition(i, dy) * padded_size + padded_col);
+            }
+        }
+    }
+
+    // The frame columns are never written, so the kernels' wrap-around at
+    // the row ends does not matter.
+    const auto& cells = tile.cells[current_];
+    auto& next = tile.cells[current_ ^ 1];
+    const auto tile_x = tile.x << tile_shift;
+    const auto tile_y = tile.y << tile_shift;
+    std::size_t population = 0;
+    std::uint64_t hash_changes = 0;
+    for (std::size_t i = 0; i < tile_size; i++) {
+        kernel_(padded + i * padded_size,
+                padded + (i + 1) * padded_size,
+                padded + (i + 2) * padded_size,
+                row,
+                padded_size,
+                1,
+                padded_size - 1,
+                rule_);
+        std::copy(row + 1, row + 1 + tile_size, next.data() + i * tile_size);
+        for (std::size_t j = 1; j <= tile_size; j++) {
+            population += row[j].data;
+        }
+        if (is_hashing_) {
+            hash_changes ^= hashRowChanges(cells.data() + i * tile_size,
+                                           next.data() + i * tile_size,
+                                           0,
+                                           tile_size,
+                                           tile_y + static_cast<Coord>(i),
+                                           tile_x);
+        }
+    }
+    tile.next_population = population;
+    tile.hash_changes = hash_changes;
+}
+
+void SparseTileEngine::addBorderTiles() {
+    std::vector<TileKey> missing;
+    for (const auto& [key, tile] : tiles_) {
+        if (tile->population == 0) {
+            continue;
+        }
+        const auto& cells = tile->cells[current_];
+        const auto isAlive = [&cells](std::size_t row, std::size_t col) {
+            return cells[row * tile_size + col].data;
+        };
+
+        bool north = false;
+        bool south = false;
+        bool west = false;
+        bool east = false;
+        for (std::size_t k = 0; k < tile_size; k++) {
+            north = north || isAlive(0, k);
+            south = south || isAlive(tile_size - 1, k);
+            west = west || isAlive(k, 0);
+            east = east || isAlive(k, tile_size - 1);
+        }
+        const bool corners[] = {isAlive(0, 0),
+                                isAlive(0, tile_size - 1),
+                                isAlive(tile_size - 1, 0),
+                                isAlive(tile_size - 1, tile_size - 1)};
+
+        const auto addIfMissing = [&](bool is_needed, Coord dx, Coord dy) {
+            const TileKey neighbour{key.x + dx, key.y + dy};
+            if (is_needed && !tiles_.contains(neighbour)) {
+                missing.push_back(neighbour);
+            }
+        };
+        addIfMissing(north, 0, -1);
+        addIfMissing(south, 0, 1);
+        addIfMissing(west, -1, 0);
+        addIfMissing(east, 1, 0);
+        addIfMissing(corners[0], -1, -1);
+        addIfMissing(corners[1], 1, -1);
+        addIfMissing(corners[2], -1, 1);
+        addIfMissing(corners[3], 1, 1);
+    }
+
+    for (const auto key : missing) {
+        getOrAddTile(key);
+    }
+}
+
+void SparseTileEngine::removeDeadTiles() {
+    for (auto it = tiles_.begin(); it != tiles_.end();) {
+        if (it->second->population != 0) {
+            ++it;
+            continue;
+        }
+        releaseTile(std::move(it->second));
+        it = tiles_.erase(it);
+    }
+}
+
+const SparseTileEngine::Tile* SparseTileEngine::findTile(TileKey key) const {
+    const auto it = tiles_.find(key);
+    return it == tiles_.end() ? nullptr : it->second.get();
+}
+
+SparseTileEngine::Tile& SparseTileEngine::getOrAddTile(TileKey key) {
+    auto& tile = tiles_[key];
+    if (tile != nullptr) {
+        return *tile;
+    }
+
+    if (free_tiles_.empty()) {
+        tile = std::make_unique<Tile>();
+    } else {
+        tile = std::move(free_tiles_.back());
+        free_tiles_.pop_back();
+    }
+    tile->x = key.x;
+    tile->y = key.y;
+    tile->cells[current_].fill(Cell{false});
+    tile->population = 0;
+    tile->next_population = 0;
+    return *tile;
+}
+
+void SparseTileEngine::releaseTile(std::unique_ptr<Tile> tile) {
+    free_tiles_.push_back(std::move(tile));
+}
+
+void SparseTileEngine::trimPool() {
+    const auto kept = std::max(min_pooled_tiles, tiles_.size() / 2);
+    if (free_tiles_.size() > kept) {
+        free_tiles_.resize(kept);
+        free_tiles_.shrink_to_fit();
+    }
+}
+
+bool SparseTileEngine::getCell(Coord x, Coord y) const {
+    const auto* tile = findTile(getTileKey(x, y));
+    return tile != nullptr && tile->cells[current_][getTileOffset(x, y)].data;
+}
+
+void SparseTileEngine::setCell(Coord x, Coord y, bool alive) {
+    const auto key = getTileKey(x, y);
+    if (!alive && !tiles_.contains(key)) {
+        return;
+    }
+    // A tile emptied here is dropped after the next step.
+    auto& tile = getOrAddTile(key);
+    auto& cell = tile.cells[current_][getTileOffset(x, y)];
+    if (cell.data != alive) {
+        cell.data = alive;
+        alive ? tile.population++ : tile.population--;
+        if (is_hashing_) {
+            hash_ ^= getCellKey(x, y);
+        }
+    }
+}
+
+std::uint64_t SparseTileEngine::population() const {
+    std::uint64_t result = 0;
+    for (const auto& [key, tile] : tiles_) {
+        result += tile->population;
+    }
+    return result;
+}
+
+void SparseTileEngine::load(const Grid& grid, Coord x, Coord y) {
+    for (std::size_t i = 0; i < grid.rows(); i++) {
+        const auto* row = grid.row(i);
+        for (std::size_t j = 0; j < grid.columns(); j++) {
+            setCell(x + static_cast<Coord>(j), y + static_cast<Coord>(i), row[j].data);
+        }
+    }
+}
+
+void SparseTileEngine::save(Grid& grid, Coord x, Coord y) const {
+    // Copies the grid one tile-wide span of a row at a time.
+    for (std::size_t i = 0; i < grid.rows(); i++) {
+        auto* row = grid.row(i);
+        const auto cell_y = y + static_cast<Coord>(i);
+        for (std::size_t j = 0; j < grid.columns();) {
+            const auto cell_x = x + static_cast<Coord>(j);
+            const auto offset = getTileOffset(cell_x, cell_y);
+            const auto span
+                = std::min(tile_size - offset % tile_size, grid.columns() - j);
+            const auto* tile = findTile(getTileKey(cell_x, cell_y));
+            if (tile != nullptr) {
+                const auto* cells = tile->cells[current_].data() + offset;
+                std::copy(cells, cells + span, row + j);
+            } else {
+                std::fill_n(row + j, span, Cell{false});
+            }
+            j += span;
+        }
+    }
+}
+
+void SparseTileEngine::clear() {
+    for (auto& [key, tile] : tiles_) {
+        releaseTile(std::move(tile));
+    }
+    tiles_.clear();
+    trimPool();
+    hash_ = 0;
+}
+
+bool SparseTileEngine::trackHash() {
+    if (is_hashing_) {
+        return true;
+    }
+    // Comparing against a dead row picks out the live cells.
+    is_hashing_ = true;
+    hash_ = 0;
+    const std::array<Cell, tile_size> dead_row{};
+    for (const auto& [key, tile] : tiles_) {
+        const auto& cells = tile->cells[current_];
+        for (std::size_t i = 0; i < tile_size; i++) {
+            hash_ ^= hashRowChanges(dead_row.data(),
+                                    cells.data() + i * tile_size,
+                                    0,
+                                    tile_size,
+                                    (key.y << tile_shift) + static_cast<Coord>(i),
+                                    key.x << tile_shift);
+        }
+    }
+    return true;
+}
+
+std::size_t SparseTileEngine::memoryUsage() const {
+    // Map entries are separately allocated nodes with a next pointer.
+    constexpr auto entry_size
+        = sizeof(std::pair<const TileKey, std::unique_ptr<Tile>>) + sizeof(void*);
+    return pooledTileCount() * sizeof(Tile) + tiles_.bucket_count() * sizeof(void*)
+           + tiles_.size() * entry_size
+           + (free_tiles_.capacity() + step_tiles_.capacity()) * sizeof(Tile*);
+}
+
+void SparseTileEngine::printStatistics(std::ostream& out) const {
+    out << "tiles: " << tileCount() << '\n'
+        << "pooled tiles: " << pooledTileCount() << '\n'
+        << "memory: " << memoryUsage() / 1024 << " KiB\n";
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "engine.h"
+#include "rule.h"
+#include "step_kernels.h"
+#include "thread_pool.h"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Engine on an unbounded plane made of square tiles that only exist where
+// there are live cells. Before every step the empty neighbours of tiles with
+// live cells on their border are added, so patterns can grow in any direction,
+// and tiles that died out are dropped after it. Gliders keep flying instead of
+// wrapping around, and memory follows the live cells rather than their
+// bounding box. Tiles come from a pool and are reused once freed, the pool
+// only keeps as many as the churn of tiles at the border of a pattern needs.
+//
+// Cells are addressed by signed plane coordinates, Index maps to the
+// non-negative quadrant with `row` as y and `col` as x.
+class SparseTileEngine : public Engine {
+public:
+    using Coord = std::int64_t;
+
+    static constexpr std::size_t tile_size = 64;
+    // Free tiles the pool keeps however few tiles are in use. Beyond that it
+    // keeps up to half as many as are in use, the rest is freed.
+    static constexpr std::size_t min_pooled_tiles = 64;
+
+    // Throws for rules with B0, which fill the empty plane.
+    explicit SparseTileEngine(std::size_t threads = 1, const Rule& rule = life_rule);
+
+    SparseTileEngine(const SparseTileEngine&) = delete;
+    SparseTileEngine& operator=(const SparseTileEngine&) = delete;
+
+    std::string_view name() const override { return "sparse"; }
+
+    void step(std::uint64_t generations) override;
+    std::uint64_t generation() const override { return generation_; }
+
+    bool get(Index ind) const override {
+        return getCell(static_cast<Coord>(ind.col), static_cast<Coord>(ind.row));
+    }
+    void set(Index ind, bool alive) override {
+        setCell(static_cast<Coord>(ind.col), static_cast<Coord>(ind.row), alive);
+    }
+
+    bool getCell(Coord x, Coord y) const;
+    void setCell(Coord x, Coord y, bool alive);
+
+    std::uint64_t population() const override;
+    std::size_t memoryUsage() const override;
+
+    bool trackHash() override;
+    std::uint64_t hash() const override { return hash_; }
+
+    void load(const Grid& grid) override { load(grid, 0, 0); }
+    void save(Grid& grid) const override { save(grid, 0, 0); }
+
+    // Overwrites or copies out the cells of `grid`'s size with the upper left
+    // corner at (x, y).
+    void load(const Grid& grid, Coord x, Coord y);
+    void save(Grid& grid, Coord x, Coord y) const;
+
+    // Kills every cell and returns the tiles to the pool.
+    void clear();
+
+    void printStatistics(std::ostream& out) const override;
+
+    std::size_t tileCount() const { return tiles_.size(); }
+    // Tiles allocated, in use or waiting in the pool.
+    std::size_t pooledTileCount() const { return tiles_.size() + free_tiles_.size(); }
+
+    const Rule& rule() const { return rule_; }
+
+private:
+    static constexpr std::size_t tile_cells = tile_size * tile_size;
+    static constexpr unsigned tile_shift = std::countr_zero(tile_size);
+    static_assert(std::has_single_bit(tile_size));
+
+    struct Tile {
+        // Position in tiles, the cell coordinates shifted by tile_shift.
+        Coord x;
+        Coord y;
+        // Row-major cells of the current and the next generation.
+        std::array<std::array<Cell, tile_cells>, 2> cells;
+        std::size_t population;
+        std::size_t next_population;
+        // Change of the hash from the current to the next generation.
+        std::uint64_t hash_changes;
+    };
+
+    struct TileKey {
+        Coord x;
+        Coord y;
+
+        bool operator==(const TileKey&) const = default;
+    };
+
+    struct TileKeyHash {
+        std::size_t operator()(const TileKey& key) const;
+    };
+
+    static TileKey getTileKey(Coord x, Coord y) {
+        return {.x = x >> tile_shift, .y = y >> tile_shift};
+    }
+    static std::size_t getTileOffset(Coord x, Coord y) {
+        const auto mask = static_cast<Coord>(tile_size - 1);
+        return static_cast<std::size_t>((y & mask) * tile_size + (x & mask));
+    }
+
+    const Tile* findTile(TileKey key) const;
+    Tile& getOrAddTile(TileKey key);
+    void releaseTile(std::unique_ptr<Tile> tile);
+    // Frees the pooled tiles past what the tiles in use may need.
+    void trimPool();
+
+    // Adds the missing neighbours a tile's border cells can give birth in.
+    void addBorderTiles();
+    void removeDeadTiles();
+
+    // Writes the next generation of `tile` from it and its eight neighbours.
+    // `padded` holds (tile_size + 2)^2 cells, `row` tile_size + 2.
+    void computeTile(Tile& tile, Cell* padded, Cell* row) const;
+
+    ThreadPool thread_pool_;
+    Rule rule_;
+    RowKernel kernel_;
+
+    std::vector<std::unique_ptr<Tile>> free_tiles_;
+    std::unordered_map<TileKey, std::unique_ptr<Tile>, TileKeyHash> tiles_;
+    std::vector<Tile*> step_tiles_;
+
+    // Which of a tile's cell buffers holds the current generation.
+    std::size_t current_ = 0;
+    std::uint64_t generation_ = 0;
+
+    bool is_hashing_ = false;
+    std::uint64_t hash_ = 0;
+};
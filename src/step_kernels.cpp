@@ -0,0 +1,628 @@
+#include "step_kernels.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GOL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(GOL_X86) && (defined(__GNUC__) || defined(__clang__))
+#define GOL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define GOL_TARGET(isa)
+#endif
+
+namespace {
+
+static_assert(sizeof(Cell) == 1, "kernels treat cells as bytes holding 0 or 1");
+
+struct Rows {
+    const std::uint8_t* up;
+    const std::uint8_t* mid;
+    const std::uint8_t* down;
+    std::uint8_t* out;
+};
+
+Rows toRows(const Cell* up, const Cell* mid, const Cell* down, Cell* out) {
+    return {.up = reinterpret_cast<const std::uint8_t*>(up),
+            .mid = reinterpret_cast<const std::uint8_t*>(mid),
+            .down = reinterpret_cast<const std::uint8_t*>(down),
+            .out = reinterpret_cast<std::uint8_t*>(out)};
+}
+
+// Template argument of the table-driven kernels, which look the rule passed at
+// run time up instead. No real rule has bits above 8 set.
+constexpr Rule table_rule{.birth = 0xffff, .survival = 0xffff};
+
+// Bit `2 * sum - alive` is the next state of a cell whose 3x3 block holds
+// `sum` live cells. The index is unique since a live cell counts itself, and
+// below transition_count since a dead cell has at most 8 live neighbours.
+constexpr unsigned transition_count = 18;
+
+constexpr std::uint32_t getTransitions(const Rule& rule) {
+    std::uint32_t transitions = 0;
+    for (unsigned sum = 0; sum <= 9; sum++) {
+        if (sum < 9 && rule.getNextState(false, sum)) {
+            transitions |= 1u << (2 * sum);
+        }
+        if (sum > 0 && rule.getNextState(true, sum)) {
+            transitions |= 1u << (2 * sum - 1);
+        }
+    }
+    return transitions;
+}
+// table_rule sets every transition there is.
+static_assert(getTransitions(table_rule) < 1u << transition_count);
+
+template <Rule rule>
+std::uint32_t getTransitions(const Rule& runtime_rule) {
+    if constexpr (rule == table_rule) {
+        return getTransitions(runtime_rule);
+    } else {
+        constexpr auto transitions = getTransitions(rule);
+        return transitions;
+    }
+}
+
+// The sum includes the cell itself, as in Grid::checkCell.
+template <Rule rule, bool is_counting>
+void computeColumns(const Rows& rows,
+                    std::size_t columns,
+                    std::size_t first_col,
+                    std::size_t last_col,
+                    const Rule& runtime_rule,
+                    RowCounts* counts) {
+    const auto transitions = getTransitions<rule>(runtime_rule);
+    // Counted in locals, `counts` could alias the cells as far as the
+    // compiler knows.
+    std::uint64_t population = 0;
+    std::uint64_t births = 0;
+    std::uint64_t deaths = 0;
+    for (std::size_t j = first_col; j < last_col; j++) {
+        const auto left = j == 0 ? columns - 1 : j - 1;
+        const auto right = j == columns - 1 ? 0 : j + 1;
+        const unsigned sum = rows.up[left] + rows.up[j] + rows.up[right]
+                             + rows.mid[left] + rows.mid[j] + rows.mid[right]
+                             + rows.down[left] + rows.down[j] + rows.down[right];
+        const auto next = (transitions >> (2 * sum - rows.mid[j])) & 1;
+        rows.out[j] = static_cast<std::uint8_t>(next);
+        if constexpr (is_counting) {
+            population += next;
+            births += next & ~rows.mid[j];
+            deaths += rows.mid[j] & ~next;
+        }
+    }
+    if constexpr (is_counting) {
+        counts->population += population;
+        counts->births += births;
+        counts->deaths += deaths;
+    }
+}
+
+template <Rule rule, bool is_counting>
+void computeRowScalar(const Cell* up,
+                      const Cell* mid,
+                      const Cell* down,
+                      Cell* out,
+                      std::size_t columns,
+                      std::size_t first_col,
+                      std::size_t last_col,
+                      const Rule& runtime_rule,
+                      RowCounts* counts) {
+    computeColumns<rule, is_counting>(
+        toRows(up, mid, down, out), columns, first_col, last_col, runtime_rule, counts);
+}
+
+#if defined(GOL_X86)
+
+// Vector kernels handle full blocks of the interior columns of the range and
+// leave the wrapping border columns and the remainder to computeColumns().
+std::size_t getFirstVectorColumn(std::size_t first_col) {
+    return first_col == 0 ? 1 : first_col;
+}
+
+// The SSE2 and AVX2 kernels count by summing the bytes of every eight cells
+// into a 64-bit lane with psadbw, which cannot overflow.
+std::uint64_t sumHalves(__m128i sums) {
+    alignas(16) std::uint64_t halves[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(halves), sums);
+    return halves[0] + halves[1];
+}
+
+// The specialized vector kernels OR together one comparison per neighbour sum
+// that leads to a live cell, masked by the current state where only one of the
+// states leads there. The recursion unrolls over the sums at compile time.
+// Lanes end up 0 for dead cells and 1 or 0xff for live ones.
+template <Rule rule, unsigned sum = 0>
+__m128i matchRuleSse2(__m128i sums, __m128i alive) {
+    if constexpr (sum > 9) {
+        return _mm_setzero_si128();
+    } else {
+        constexpr bool born = rule.getNextState(false, sum);
+        constexpr bool kept = rule.getNextState(true, sum);
+        auto next = matchRuleSse2<rule, sum + 1>(sums, alive);
+        if constexpr (born || kept) {
+            auto hit = _mm_cmpeq_epi8(sums, _mm_set1_epi8(static_cast<char>(sum)));
+            if constexpr (!kept) {
+                hit = _mm_andnot_si128(alive, hit);
+            } else if constexpr (!born) {
+                hit = _mm_and_si128(alive, hit);
+            }
+            next = _mm_or_si128(next, hit);
+        }
+        return next;
+    }
+}
+
+template <Rule rule, bool is_counting>
+void computeRowSse2(const Cell* up,
+                    const Cell* mid,
+                    const Cell* down,
+                    Cell* out,
+                    std::size_t columns,
+                    std::size_t first_col,
+                    std::size_t last_col,
+                    const Rule& runtime_rule,
+                    RowCounts* counts) {
+    constexpr std::size_t width = 16;
+    const auto rows = toRows(up, mid, down, out);
+
+    const auto one = _mm_set1_epi8(1);
+
+    // SSE2 has no byte shuffle, so the table-driven kernel compares the state
+    // index 2 * sum - alive against each index of the transitions that leads
+    // to a live cell.
+    const auto transitions = getTransitions<rule>(runtime_rule);
+    __m128i live_indices[transition_count];
+    std::size_t live_index_count = 0;
+    if constexpr (rule == table_rule) {
+        for (auto bits = transitions; bits != 0; bits &= bits - 1) {
+            live_indices[live_index_count++]
+                = _mm_set1_epi8(static_cast<char>(std::countr_zero(bits)));
+        }
+    }
+
+    const auto zero = _mm_setzero_si128();
+    auto alive_sums = zero;
+    auto born_sums = zero;
+    auto died_sums = zero;
+
+    const auto first_vector_col = getFirstVectorColumn(first_col);
+    auto j = first_vector_col;
+    for (; j + width < columns && j + width <= last_col; j += width) {
+        auto sum = _mm_setzero_si128();
+        for (const auto* row : {rows.up, rows.mid, rows.down}) {
+            for (const auto* ptr : {row + j - 1, row + j, row + j + 1}) {
+                sum = _mm_add_epi8(
+                    sum, _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)));
+            }
+        }
+        const auto alive
+            = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows.mid + j));
+
+        __m128i next;
+        if constexpr (rule == table_rule) {
+            const auto index = _mm_sub_epi8(_mm_add_epi8(sum, sum), alive);
+            next = _mm_setzero_si128();
+            for (std::size_t i = 0; i < live_index_count; i++) {
+                next = _mm_or_si128(next, _mm_cmpeq_epi8(index, live_indices[i]));
+            }
+        } else {
+            next = matchRuleSse2<rule>(sum, alive);
+        }
+        const auto cells = _mm_and_si128(next, one);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rows.out + j), cells);
+        if constexpr (is_counting) {
+            alive_sums = _mm_add_epi64(alive_sums, _mm_sad_epu8(cells, zero));
+            born_sums = _mm_add_epi64(born_sums,
+                                      _mm_sad_epu8(_mm_andnot_si128(alive, cells), zero));
+            died_sums = _mm_add_epi64(died_sums,
+                                      _mm_sad_epu8(_mm_andnot_si128(cells, alive), zero));
+        }
+    }
+    if constexpr (is_counting) {
+        counts->population += sumHalves(alive_sums);
+        counts->births += sumHalves(born_sums);
+        counts->deaths += sumHalves(died_sums);
+    }
+
+    computeColumns<rule, is_counting>(rows,
+                                      columns,
+                                      first_col,
+                                      std::min(first_vector_col, last_col),
+                                      runtime_rule,
+                                      counts);
+    computeColumns<rule, is_counting>(rows, columns, j, last_col, runtime_rule, counts);
+}
+
+// Next states by neighbour sum for dead and for live cells, 16 bytes each so
+// they can be used as byte shuffle tables.
+struct ShuffleTables {
+    alignas(16) std::uint8_t dead[16];
+    alignas(16) std::uint8_t alive[16];
+};
+
+ShuffleTables makeShuffleTables(const Rule& rule) {
+    ShuffleTables tables{};
+    for (unsigned sum = 0; sum <= 9; sum++) {
+        tables.dead[sum] = rule.getNextState(false, sum);
+        tables.alive[sum] = rule.getNextState(true, sum);
+    }
+    return tables;
+}
+
+template <Rule rule, unsigned sum = 0>
+GOL_TARGET("avx2")
+__m256i matchRuleAvx2(__m256i sums, __m256i alive) {
+    if constexpr (sum > 9) {
+        return _mm256_setzero_si256();
+    } else {
+        constexpr bool born = rule.getNextState(false, sum);
+        constexpr bool kept = rule.getNextState(true, sum);
+        auto next = matchRuleAvx2<rule, sum + 1>(sums, alive);
+        if constexpr (born || kept) {
+            auto hit
+                = _mm256_cmpeq_epi8(sums, _mm256_set1_epi8(static_cast<char>(sum)));
+            if constexpr (!kept) {
+                hit = _mm256_andnot_si256(alive, hit);
+            } else if constexpr (!born) {
+                hit = _mm256_and_si256(alive, hit);
+            }
+            next = _mm256_or_si256(next, hit);
+        }
+        return next;
+    }
+}
+
+GOL_TARGET("avx2")
+std::uint64_t sumQuarters(__m256i sums) {
+    return sumHalves(
+        _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1)));
+}
+
+template <Rule rule, bool is_counting>
+GOL_TARGET("avx2")
+void computeRowAvx2(const Cell* up,
+                    const Cell* mid,
+                    const Cell* down,
+                    Cell* out,
+                    std::size_t columns,
+                    std::size_t first_col,
+                    std::size_t last_col,
+                    const Rule& runtime_rule,
+                    RowCounts* counts) {
+    constexpr std::size_t width = 32;
+    const auto rows = toRows(up, mid, down, out);
+
+    const auto one = _mm256_set1_epi8(1);
+
+    // The table-driven kernel shuffles the next state out of a table per
+    // current state and keeps the one of the actual state.
+    __m256i dead_table = _mm256_setzero_si256();
+    __m256i alive_table = _mm256_setzero_si256();
+    if constexpr (rule == table_rule) {
+        const auto tables = makeShuffleTables(runtime_rule);
+        dead_table = _mm256_broadcastsi128_si256(
+            _mm_load_si128(reinterpret_cast<const __m128i*>(tables.dead)));
+        alive_table = _mm256_broadcastsi128_si256(
+            _mm_load_si128(reinterpret_cast<const __m128i*>(tables.alive)));
+    }
+
+    const auto zero = _mm256_setzero_si256();
+    auto alive_sums = zero;
+    auto born_sums = zero;
+    auto died_sums = zero;
+
+    const auto first_vector_col = getFirstVectorColumn(first_col);
+    auto j = first_vector_col;
+    for (; j + width < columns && j + width <= last_col; j += width) {
+        auto sum = _mm256_setzero_si256();
+        for (const auto* row : {rows.up, rows.mid, rows.down}) {
+            for (const auto* ptr : {row + j - 1, row + j, row + j + 1}) {
+                sum = _mm256_add_epi8(
+                    sum, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr)));
+            }
+        }
+        const auto alive
+            = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows.mid + j));
+
+        __m256i next;
+        if constexpr (rule == table_rule) {
+            next = _mm256_or_si256(
+                _mm256_and_si256(alive, _mm256_shuffle_epi8(alive_table, sum)),
+                _mm256_andnot_si256(alive, _mm256_shuffle_epi8(dead_table, sum)));
+        } else {
+            next = matchRuleAvx2<rule>(sum, alive);
+        }
+        const auto cells = _mm256_and_si256(next, one);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(rows.out + j), cells);
+        if constexpr (is_counting) {
+            alive_sums = _mm256_add_epi64(alive_sums, _mm256_sad_epu8(cells, zero));
+            born_sums = _mm256_add_epi64(
+                born_sums, _mm256_sad_epu8(_mm256_andnot_si256(alive, cells), zero));
+            died_sums = _mm256_add_epi64(
+                died_sums, _mm256_sad_epu8(_mm256_andnot_si256(cells, alive), zero));
+        }
+    }
+    if constexpr (is_counting) {
+        counts->population += sumQuarters(alive_sums);
+        counts->births += sumQuarters(born_sums);
+        counts->deaths += sumQuarters(died_sums);
+    }
+
+    computeColumns<rule, is_counting>(rows,
+                                      columns,
+                                      first_col,
+                                      std::min(first_vector_col, last_col),
+                                      runtime_rule,
+                                      counts);
+    computeColumns<rule, is_counting>(rows, columns, j, last_col, runtime_rule, counts);
+}
+
+// AVX-512 compares into masks, so the lanes are plain bits here.
+template <Rule rule, unsigned sum = 0>
+GOL_TARGET("avx512f,avx512bw")
+__mmask64 matchRuleAvx512(__m512i sums, __mmask64 alive) {
+    if constexpr (sum > 9) {
+        return 0;
+    } else {
+        constexpr bool born = rule.getNextState(false, sum);
+        constexpr bool kept = rule.getNextState(true, sum);
+        auto next = matchRuleAvx512<rule, sum + 1>(sums, alive);
+        if constexpr (born || kept) {
+            auto hit
+                = _mm512_cmpeq_epi8_mask(sums, _mm512_set1_epi8(static_cast<char>(sum)));
+            if constexpr (!kept) {
+                hit &= ~alive;
+            } else if constexpr (!born) {
+                hit &= alive;
+            }
+            next |= hit;
+        }
+        return next;
+    }
+}
+
+template <Rule rule, bool is_counting>
+GOL_TARGET("avx512f,avx512bw,popcnt")
+void computeRowAvx512(const Cell* up,
+                      const Cell* mid,
+                      const Cell* down,
+                      Cell* out,
+                      std::size_t columns,
+                      std::size_t first_col,
+                      std::size_t last_col,
+                      const Rule& runtime_rule,
+                      RowCounts* counts) {
+    constexpr std::size_t width = 64;
+    const auto rows = toRows(up, mid, down, out);
+
+    const auto one = _mm512_set1_epi8(1);
+
+    __m512i dead_table = _mm512_setzero_si512();
+    __m512i alive_table = _mm512_setzero_si512();
+    if constexpr (rule == table_rule) {
+        const auto tables = makeShuffleTables(runtime_rule);
+        const auto dead = _mm_load_si128(reinterpret_cast<const __m128i*>(tables.dead));
+        const auto alive
+            = _mm_load_si128(reinterpret_cast<const __m128i*>(tables.alive));
+        dead_table = _mm512_maskz_broadcast_i32x4(0xffff, dead);
+        alive_table = _mm512_maskz_broadcast_i32x4(0xffff, alive);
+    }
+
+    // Counting adds up the bits of the masks of the cells, one popcount per
+    // 64 cells.
+    std::uint64_t population = 0;
+    std::uint64_t births = 0;
+    std::uint64_t deaths = 0;
+
+    const auto first_vector_col = getFirstVectorColumn(first_col);
+    auto j = first_vector_col;
+    for (; j + width < columns && j + width <= last_col; j += width) {
+        auto sum = _mm512_setzero_si512();
+        for (const auto* row : {rows.up, rows.mid, rows.down}) {
+            for (const auto* ptr : {row + j - 1, row + j, row + j + 1}) {
+                sum = _mm512_add_epi8(sum, _mm512_loadu_si512(ptr));
+            }
+        }
+        const auto alive = _mm512_loadu_si512(rows.mid + j);
+        const auto alive_mask = _mm512_test_epi8_mask(alive, alive);
+
+        __mmask64 next_mask = 0;
+        if constexpr (rule == table_rule) {
+            const auto next
+                = _mm512_mask_blend_epi8(alive_mask,
+                                         _mm512_shuffle_epi8(dead_table, sum),
+                                         _mm512_shuffle_epi8(alive_table, sum));
+            _mm512_storeu_si512(rows.out + j, next);
+            if constexpr (is_counting) {
+                next_mask = _mm512_test_epi8_mask(next, next);
+            }
+        } else {
+            next_mask = matchRuleAvx512<rule>(sum, alive_mask);
+            _mm512_storeu_si512(rows.out + j, _mm512_maskz_mov_epi8(next_mask, one));
+        }
+        if constexpr (is_counting) {
+            population += std::popcount(next_mask);
+            births += std::popcount(next_mask & ~alive_mask);
+            deaths += std::popcount(alive_mask & ~next_mask);
+        }
+    }
+    if constexpr (is_counting) {
+        counts->population += population;
+        counts->births += births;
+        counts->deaths += deaths;
+    }
+
+    computeColumns<rule, is_counting>(rows,
+                                      columns,
+                                      first_col,
+                                      std::min(first_vector_col, last_col),
+                                      runtime_rule,
+                                      counts);
+    computeColumns<rule, is_counting>(rows, columns, j, last_col, runtime_rule, counts);
+}
+
+struct CpuFeatures {
+    bool sse2 = false;
+    bool avx2 = false;
+    bool avx512 = false;
+};
+
+CpuFeatures detectCpuFeatures() {
+    CpuFeatures features;
+#if defined(_MSC_VER)
+    int info[4] = {};
+    __cpuid(info, 0);
+    const int max_leaf = info[0];
+
+    __cpuid(info, 1);
+    features.sse2 = (info[3] & (1 << 26)) != 0;
+    const bool has_popcnt = (info[2] & (1 << 23)) != 0;
+    const bool has_osxsave = (info[2] & (1 << 27)) != 0;
+    if (max_leaf < 7 || !has_osxsave) {
+        return features;
+    }
+
+    // The OS has to save the YMM (and for AVX-512 also the ZMM) state.
+    const auto xcr0 = _xgetbv(0);
+    const bool ymm_enabled = (xcr0 & 0x6) == 0x6;
+    const bool zmm_enabled = (xcr0 & 0xe6) == 0xe6;
+
+    __cpuidex(info, 7, 0);
+    features.avx2 = ymm_enabled && (info[1] & (1 << 5)) != 0;
+    features.avx512 = zmm_enabled && (info[1] & (1 << 16)) != 0
+                      && (info[1] & (1 << 30)) != 0 && has_popcnt;
+#else
+    __builtin_cpu_init();
+    features.sse2 = __builtin_cpu_supports("sse2");
+    features.avx2 = __builtin_cpu_supports("avx2");
+    features.avx512 = __builtin_cpu_supports("avx512f")
+                      && __builtin_cpu_supports("avx512bw")
+                      && __builtin_cpu_supports("popcnt");
+#endif
+    return features;
+}
+
+#endif
+
+// Every kernel is written once for both signatures and only counts the
+// cells it computes when `is_counting` is set.
+template <auto kernel>
+void computeRow(const Cell* up,
+                const Cell* mid,
+                const Cell* down,
+                Cell* out,
+                std::size_t columns,
+                std::size_t first_col,
+                std::size_t last_col,
+                const Rule& rule) {
+    kernel(up, mid, down, out, columns, first_col, last_col, rule, nullptr);
+}
+
+template <auto kernel>
+void computeCountedRow(const Cell* up,
+                       const Cell* mid,
+                       const Cell* down,
+                       Cell* out,
+                       std::size_t columns,
+                       std::size_t first_col,
+                       std::size_t last_col,
+                       const Rule& rule,
+                       RowCounts& counts) {
+    kernel(up, mid, down, out, columns, first_col, last_col, rule, &counts);
+}
+
+template <auto plain_kernel, auto counting_kernel>
+StepKernel makeKernel(std::string_view name) {
+    return {name, computeRow<plain_kernel>, computeCountedRow<counting_kernel>};
+}
+
+template <Rule rule>
+std::vector<StepKernel> detectKernels() {
+    constexpr bool is_table = rule == table_rule;
+    std::vector<StepKernel> kernels = {
+        makeKernel<computeRowScalar<rule, false>, computeRowScalar<rule, true>>(
+            is_table ? "scalar-table" : "scalar")};
+#if defined(GOL_X86)
+    const auto features = detectCpuFeatures();
+    if (features.sse2) {
+        kernels.push_back(
+            makeKernel<computeRowSse2<rule, false>, computeRowSse2<rule, true>>(
+                is_table ? "sse2-table" : "sse2"));
+    }
+    if (features.avx2) {
+        kernels.push_back(
+            makeKernel<computeRowAvx2<rule, false>, computeRowAvx2<rule, true>>(
+                is_table ? "avx2-table" : "avx2"));
+    }
+    if (features.avx512) {
+        kernels.push_back(
+            makeKernel<computeRowAvx512<rule, false>, computeRowAvx512<rule, true>>(
+                is_table ? "avx512-table" : "avx512"));
+    }
+#endif
+    return kernels;
+}
+
+constexpr Rule specialized_rules[] = {
+    life_rule, highlife_rule, day_and_night_rule, seeds_rule};
+
+}  // namespace
+
+std::span<const Rule> getSpecializedRules() {
+    return specialized_rules;
+}
+
+const std::vector<StepKernel>& getAvailableKernels(const Rule& rule) {
+    static const std::vector<StepKernel> kernels[] = {
+        detectKernels<specialized_rules[0]>(),
+        detectKernels<specialized_rules[1]>(),
+        detectKernels<specialized_rules[2]>(),
+        detectKernels<specialized_rules[3]>(),
+    };
+    static_assert(std::size(kernels) == std::size(specialized_rules));
+
+    for (std::size_t i = 0; i < std::size(specialized_rules); i++) {
+        if (specialized_rules[i] == rule) {
+            return kernels[i];
+        }
+    }
+    return getTableKernels();
+}
+
+const std::vector<StepKernel>& getTableKernels() {
+    static const auto kernels = detectKernels<table_rule>();
+    return kernels;
+}
+
+const StepKernel& getDefaultKernel(const Rule& rule) {
+    return getAvailableKernels(rule).back();
+}
+
+void stepRows(const Grid& current,
+              Grid& next,
+              std::size_t first_row,
+              std::size_t last_row,
+              RowKernel kernel,
+              const Rule& rule) {
+    assert(next.rows() == current.rows() && next.columns() == current.columns());
+
+    const auto rows = current.rows();
+    for (std::size_t i = first_row; i < last_row; i++) {
+        kernel(current.row(i == 0 ? rows - 1 : i - 1),
+               current.row(i),
+               current.row(i == rows - 1 ? 0 : i + 1),
+               next.row(i),
+               current.columns(),
+               0,
+               current.columns(),
+               rule);
+    }
+}
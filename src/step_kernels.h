@@ -0,0 +1,71 @@
+#pragma once
+
+#include "grid.h"
+#include "rule.h"
+#include <cstdint>
+#include <cstdlib>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// Computes columns [first_col, last_col) of one row of the next generation
+// from the current rows above, at and below it, wrapping around the row ends.
+// Kernels specialized for a rule ignore `rule`.
+using RowKernel = void (*)(const Cell* up,
+                           const Cell* mid,
+                           const Cell* down,
+                           Cell* out,
+                           std::size_t columns,
+                           std::size_t first_col,
+                           std::size_t last_col,
+                           const Rule& rule);
+
+// Live cells of columns [first_col, last_col) of a computed row, and the
+// cells that came alive and died since the current generation.
+struct RowCounts {
+    std::uint64_t population = 0;
+    std::uint64_t births = 0;
+    std::uint64_t deaths = 0;
+};
+
+// Like RowKernel, and adds the counts of the columns it computed to `counts`
+// in the same pass, from the cells it already holds in registers.
+using CountingRowKernel = void (*)(const Cell* up,
+                                   const Cell* mid,
+                                   const Cell* down,
+                                   Cell* out,
+                                   std::size_t columns,
+                                   std::size_t first_col,
+                                   std::size_t last_col,
+                                   const Rule& rule,
+                                   RowCounts& counts);
+
+struct StepKernel {
+    std::string_view name;
+    RowKernel compute_row;
+    CountingRowKernel compute_counted_row;
+};
+
+// Rules with kernels specialized at compile time, so their inner loops compare
+// the neighbour sums against constants instead of looking the rule up.
+std::span<const Rule> getSpecializedRules();
+
+// Kernels for `rule` supported by the running CPU, from the plain scalar one
+// to the widest vector one. Rules without specialized kernels get the
+// table-driven ones.
+const std::vector<StepKernel>& getAvailableKernels(const Rule& rule = life_rule);
+
+// Kernels that look any rule up in a table of next states by neighbour sum.
+const std::vector<StepKernel>& getTableKernels();
+
+// The widest kernel for `rule` supported by the running CPU.
+const StepKernel& getDefaultKernel(const Rule& rule = life_rule);
+
+// Writes rows [first_row, last_row) of the next generation of `current` into
+// `next` with the given kernel.
+void stepRows(const Grid& current,
+              Grid& next,
+              std::size_t first_row,
+              std::size_t last_row,
+              RowKernel kernel,
+              const Rule& rule = life_rule);
@@ -0,0 +1,86 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(std::size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    workers_.reserve(threads - 1);
+    for (std::size_t i = 1; i < threads; i++) {
+        workers_.emplace_back([this, i] { runWorker(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        const std::lock_guard lock{mutex_};
+        stopping_ = true;
+    }
+    start_cv_.notify_all();
+
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(std::size_t count, const Task& task) {
+    if (workers_.empty()) {
+        if (count > 0) {
+            task(0, count);
+        }
+        return;
+    }
+
+    {
+        const std::lock_guard lock{mutex_};
+        task_ = &task;
+        count_ = count;
+        pending_ = workers_.size();
+        generation_++;
+    }
+    start_cv_.notify_all();
+
+    runBand(0);
+
+    std::unique_lock lock{mutex_};
+    done_cv_.wait(lock, [this] { return pending_ == 0; });
+    task_ = nullptr;
+}
+
+void ThreadPool::runWorker(std::size_t band) {
+    std::uint64_t seen_generation = 0;
+
+    while (true) {
+        {
+            std::unique_lock lock{mutex_};
+            start_cv_.wait(lock, [&] {
+                return stopping_ || generation_ != seen_generation;
+            });
+            if (stopping_) {
+                return;
+            }
+            seen_generation = generation_;
+        }
+
+        runBand(band);
+
+        bool is_last = false;
+        {
+            const std::lock_guard lock{mutex_};
+            is_last = --pending_ == 0;
+        }
+        if (is_last) {
+            done_cv_.notify_one();
+        }
+    }
+}
+
+void ThreadPool::runBand(std::size_t band) const {
+    const auto bands = threadCount();
+    const auto begin = count_ * band / bands;
+    const auto end = count_ * (band + 1) / bands;
+    if (begin != end) {
+        (*task_)(begin, end);
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent pool of worker threads for splitting a range of rows into bands.
+// The calling thread works on the first band itself, so a pool of one thread
+// owns no workers and runs everything inline.
+class ThreadPool {
+public:
+    using Task = std::function<void(std::size_t begin, std::size_t end)>;
+
+    // Zero threads means one per hardware thread.
+    explicit ThreadPool(std::size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t threadCount() const { return workers_.size() + 1; }
+
+    // Splits [0, count) into threadCount() contiguous bands, runs `task` on
+    // each of them and returns once every band is done.
+    void parallelFor(std::size_t count, const Task& task);
+
+private:
+    void runWorker(std::size_t band);
+    void runBand(std::size_t band) const;
+
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+
+    const Task* task_ = nullptr;
+    std::size_t count_ = 0;
+    std::uint64_t generation_ = 0;
+    std::size_t pending_ = 0;
+    bool stopping_ = false;
+};
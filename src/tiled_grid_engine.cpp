@@ -0,0 +1,119 @@
+#include "tiled_grid_engine.h"
+#include "zobrist.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <mutex>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+TiledGridEngine::TiledGridEngine(std::size_t rows,
+                                 std::size_t columns,
+                                 std::size_t threads,
+                                 Index tile_size,
+                                 const Rule& rule)
+    : GridEngine{rows, columns, threads, rule}
+    , tile_size_{tile_size.row > 0 && tile_size.col > 0
+                     ? tile_size
+                     : getAutoTileSize(getCacheSize(), columns)}
+    , tile_rows_{(rows + tile_size_.row - 1) / tile_size_.row}
+    , tile_columns_{(columns + tile_size_.col - 1) / tile_size_.col} {}
+
+std::size_t TiledGridEngine::getCacheSize() {
+    constexpr std::size_t fallback = 256 * 1024;
+#if defined(_SC_LEVEL2_CACHE_SIZE)
+    const auto size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (size > 0) {
+        return static_cast<std::size_t>(size);
+    }
+#endif
+    return fallback;
+}
+
+Index TiledGridEngine::getAutoTileSize(std::size_t cache_size, std::size_t columns) {
+    // Both generations of a tile fill about half of the cache. Square tiles
+    // read the fewest halo cells for that many cells, and a power-of-two
+    // width keeps the vector kernels on whole blocks, so the width is the
+    // largest power of two whose square fits.
+    const auto cells = std::max<std::size_t>(cache_size / 4, 1);
+    const auto square = std::size_t{1} << (std::bit_width(cells) - 1) / 2;
+    const auto width = std::max<std::size_t>(std::min(square, columns), 1);
+    // Narrow boards get taller tiles, which are still at least tall enough
+    // for the rows they share with the tiles above and below not to dominate.
+    return {std::max<std::size_t>(cells / width, min_auto_tile_rows), width};
+}
+
+void TiledGridEngine::step(std::uint64_t generations) {
+    const auto& kernel = getDefaultKernel(rule_);
+
+    for (std::uint64_t gen = 0; gen < generations; gen++) {
+        std::atomic<std::uint64_t> changes = 0;
+        std::mutex counts_mutex;
+        BoardStatistics counts;
+        thread_pool_.parallelFor(tileCount(), [&](std::size_t begin, std::size_t end) {
+            std::uint64_t band_changes = 0;
+            BoardStatistics band_counts;
+            for (auto tile = begin; tile < end; tile++) {
+                band_changes ^= computeTile(tile, kernel, band_counts);
+            }
+            changes.fetch_xor(band_changes, std::memory_order_relaxed);
+            if (is_counting_) {
+                const std::lock_guard lock{counts_mutex};
+                counts.merge(band_counts);
+            }
+        });
+        hash_ ^= changes.load(std::memory_order_relaxed);
+        generations_.flip();
+        generation_++;
+        if (is_counting_) {
+            statistics_ = counts;
+            are_bounds_stale_ = false;
+            statistics_.generation = generation_;
+        }
+    }
+}
+
+std::uint64_t TiledGridEngine::computeTile(std::size_t tile,
+                                           const StepKernel& kernel,
+                                           BoardStatistics& counts) {
+    const auto& current = generations_.current();
+    auto& next = generations_.next();
+    const auto rows = current.rows();
+    const auto columns = current.columns();
+
+    const auto first_row = tile / tile_columns_ * tile_size_.row;
+    const auto first_col = tile % tile_columns_ * tile_size_.col;
+    const auto last_row = std::min(first_row + tile_size_.row, rows);
+    const auto last_col = std::min(first_col + tile_size_.col, columns);
+
+    // The one-cell halo is read in place rather than copied: the rows above
+    // and below the tile are read from the board like its own, and the
+    // kernels wrap around at the ends of a row themselves.
+    std::uint64_t changes = 0;
+    for (auto i = first_row; i < last_row; i++) {
+        const auto* up = current.row(i == 0 ? rows - 1 : i - 1);
+        const auto* mid = current.row(i);
+        const auto* down = current.row(i == rows - 1 ? 0 : i + 1);
+        auto* out = next.row(i);
+        if (is_counting_) {
+            RowCounts row_counts;
+            kernel.compute_counted_row(
+                up, mid, down, out, columns, first_col, last_col, rule_, row_counts);
+            addRowCounts(row_counts, out, first_col, last_col, i, counts);
+        } else {
+            kernel.compute_row(up, mid, down, out, columns, first_col, last_col, rule_);
+        }
+        if (is_hashing_) {
+            changes ^= hashRowChanges(
+                mid, out, first_col, last_col, static_cast<std::int64_t>(i));
+        }
+    }
+    return changes;
+}
+
+void TiledGridEngine::printStatistics(std::ostream& out) const {
+    out << "tiles: " << tileCount() << " of " << tile_size_.row << "x" << tile_size_.col
+        << '\n';
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "grid_engine.h"
+#include "step_kernels.h"
+#include <cstdint>
+
+// Grid engine that steps the board in cache-sized square tiles instead of
+// whole rows, so the rows above and below a tile row, and the one-cell halo
+// around the tile, are still in L2 when they are read again however wide the
+// board is.
+// Tiles are also the unit the thread pool is handed.
+class TiledGridEngine : public GridEngine {
+public:
+    static constexpr std::size_t min_auto_tile_rows = 16;
+
+    // A tile size of 0 x 0 picks one from the L2 cache size and the width of
+    // the board.
+    TiledGridEngine(std::size_t rows,
+                    std::size_t columns,
+                    std::size_t threads = 1,
+                    Index tile_size = {0, 0},
+                    const Rule& rule = life_rule);
+
+    std::string_view name() const override { return "tiled"; }
+
+    void step(std::uint64_t generations) override;
+
+    void printStatistics(std::ostream& out) const override;
+
+    Index tileSize() const { return tile_size_; }
+    std::size_t tileCount() const { return tile_rows_ * tile_columns_; }
+
+    // Bytes of the L2 cache of the running CPU, or a conservative guess if
+    // the platform does not tell.
+    static std::size_t getCacheSize();
+
+    // Square tiles of a power-of-two width that fill half of a cache of
+    // `cache_size` bytes with both generations. On boards narrower than that
+    // they are as wide as the board and taller, but at least
+    // min_auto_tile_rows tall.
+    static Index getAutoTileSize(std::size_t cache_size, std::size_t columns);
+
+private:
+    // Computes tile `tile` of the next generation. Returns the change of the
+    // hash if it is tracked, and adds the cells of the tile to `counts` if
+    // they are.
+    std::uint64_t computeTile(std::size_t tile,
+                              const StepKernel& kernel,
+                              BoardStatistics& counts);
+
+    Index tile_size_;
+    std::size_t tile_rows_;
+    std::size_t tile_columns_;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+// Hands frames from one writer thread to one reader thread without locking.
+// The writer fills `back()` and `publish()` swaps it with the shared middle
+// slot. The reader's `update()` swaps the middle slot with `front()` whenever
+// a newer frame is waiting. Neither side ever waits for the other, and the
+// reader always sees the most recently published complete frame.
+template <typename Frame>
+class TripleBuffer {
+public:
+    template <typename... Args>
+    explicit TripleBuffer(const Args&... args)
+        : buffers_{Frame{args...}, Frame{args...}, Frame{args...}} {}
+
+    // Writer side.
+    Frame& back() { return buffers_[back_]; }
+
+    void publish() {
+        back_ = middle_.exchange(back_ | fresh_bit, std::memory_order_acq_rel)
+                & index_mask;
+    }
+
+    // Whether the last published frame has not been picked up by the reader
+    // yet. Lets the writer skip copying frames nobody is going to look at.
+    bool hasUnreadFrame() const {
+        return (middle_.load(std::memory_order_acquire) & fresh_bit) != 0;
+    }
+
+    // Reader side. Returns whether `front()` changed.
+    bool update() {
+        if (!hasUnreadFrame()) {
+            return false;
+        }
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & index_mask;
+        return true;
+    }
+
+    const Frame& front() const { return buffers_[front_]; }
+
+private:
+    static constexpr unsigned index_mask = 0b011;
+    static constexpr unsigned fresh_bit = 0b100;
+
+    std::array<Frame, 3> buffers_;
+
+    unsigned back_ = 0;
+    std::atomic<unsigned> middle_ = 1;
+    unsigned front_ = 2;
+};
@@ -1,6 +1,17 @@
 #include "utility.h"
+#include "checkpoint.h"
+#include "control_server.h"
+#include "pattern.h"
 #include <imgui-SFML.h>
 #include <imgui.h>
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 void handleEvent(sf::RenderWindow& window,
                  sf::Event& event,
@@ -15,11 +26,37 @@ void handleEvent(sf::RenderWindow& window,
                                               0.f,
                                               static_cast<float>(event.size.width),
                                               static_cast<float>(event.size.height)}});
-        game.handleResize(event.size.width, event.size.height, window);
+        game.handleResize(event.size.width, event.size.height);
     } else if (!settings.in_menu && event.type == sf::Event::MouseButtonPressed
                && event.mouseButton.button == sf::Mouse::Left) {
-        game.handleClick({static_cast<unsigned>(event.mouseButton.x),
-                          static_cast<unsigned>(event.mouseButton.y)});
+        game.beginStroke({static_cast<unsigned>(event.mouseButton.x),
+                          static_cast<unsigned>(event.mouseButton.y)},
+                         static_cast<unsigned>(settings.brush_size));
+    } else if (event.type == sf::Event::MouseButtonReleased
+               && event.mouseButton.button == sf::Mouse::Left) {
+        game.endStroke();
+    } else if (event.type == sf::Event::MouseButtonPressed
+               && event.mouseButton.button != sf::Mouse::Left
+               && !ImGui::GetIO().WantCaptureMouse) {
+        settings.drag_position = {event.mouseButton.x, event.mouseButton.y};
+    } else if (event.type == sf::Event::MouseButtonReleased
+               && event.mouseButton.button != sf::Mouse::Left) {
+        settings.drag_position.reset();
+    } else if (event.type == sf::Event::MouseMoved && settings.drag_position) {
+        const auto position = sf::Vector2i{event.mouseMove.x, event.mouseMove.y};
+        game.dragCamera(position.x - settings.drag_position->x,
+                        position.y - settings.drag_position->y);
+        settings.drag_position = position;
+    } else if (event.type == sf::Event::MouseMoved && game.isPainting()) {
+        // Moves off the left or top edge of the window come in negative.
+        game.continueStroke({static_cast<unsigned>(std::max(event.mouseMove.x, 0)),
+                             static_cast<unsigned>(std::max(event.mouseMove.y, 0))});
+    } else if (event.type == sf::Event::MouseWheelScrolled
+               && event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel
+               && !ImGui::GetIO().WantCaptureMouse) {
+        game.zoomCamera(static_cast<int>(event.mouseWheelScroll.delta),
+                        {static_cast<unsigned>(event.mouseWheelScroll.x),
+                         static_cast<unsigned>(event.mouseWheelScroll.y)});
     } else if (event.type == sf::Event::KeyPressed) {
         switch (event.key.code) {
         case sf::Keyboard::Escape:
@@ -27,13 +64,39 @@ void handleEvent(sf::RenderWindow& window,
             break;
         case sf::Keyboard::Enter:
             settings.paused = !settings.paused;
+            game.setPaused(settings.paused);
             break;
         case sf::Keyboard::Left:
             settings.increaseSpeed();
+            game.setStepDelay(settings.step_delta_ms);
             break;
         case sf::Keyboard::Right:
             settings.decreaseSpeed();
+            game.setStepDelay(settings.step_delta_ms);
+            break;
+        case sf::Keyboard::BackSpace:
+            // Stepping back pauses, or the simulation would step forward again.
+            if (ImGui::GetIO().WantCaptureKeyboard) {
+                break;
+            }
+            settings.paused = true;
+            game.setPaused(true);
+            game.stepBack(event.key.shift ? Settings::step_back_fast : 1);
+            break;
+        case sf::Keyboard::W:
+        case sf::Keyboard::A:
+        case sf::Keyboard::S:
+        case sf::Keyboard::D: {
+            // Letters typed into the menu's text fields must not move the view.
+            if (ImGui::GetIO().WantCaptureKeyboard) {
+                break;
+            }
+            const auto key = event.key.code;
+            const int columns = (key == sf::Keyboard::D) - (key == sf::Keyboard::A);
+            const int rows = (key == sf::Keyboard::S) - (key == sf::Keyboard::W);
+            game.panView(columns * Settings::pan_cells, rows * Settings::pan_cells);
             break;
+        }
         default:
             break;
         }
@@ -41,7 +104,7 @@ void handleEvent(sf::RenderWindow& window,
 }
 
 void drawMenu(sf::RenderWindow& window, GameOfLife& game, Settings& settings) {
-    ImGui::SetNextWindowSize(ImVec2{400, 240});
+    ImGui::SetNextWindowSize(ImVec2{400, 715});
 
     const auto center = ImGui::GetMainViewport()->GetCenter();
     ImGui::SetNextWindowPos(center, ImGuiCond_None, ImVec2{0.5f, 0.5f});
@@ -62,6 +125,7 @@ void drawMenu(sf::RenderWindow& window, GameOfLife& game, Settings& settings) {
     if (ImGui::Button(settings.paused ? "Continue##pause" : "Pause##pause",
                       button_width)) {
         settings.paused = !settings.paused;
+        game.setPaused(settings.paused);
     }
     if (ImGui::Button("Exit", button_width)) {
         window.close();
@@ -83,43 +147,265 @@ void drawMenu(sf::RenderWindow& window, GameOfLife& game, Settings& settings) {
     ImGui::ColorEdit3("Background", settings.background_color.data());
     ImGui::Unindent();
 
-    ImGui::SliderInt("Step Delay (ms)",
-                     &settings.step_delta_ms,
-                     Settings::min_update_ms,
-                     Settings::max_update_ms,
-                     "%d",
+    if (ImGui::SliderInt("Step Delay (ms)",
+                         &settings.step_delta_ms,
+                         Settings::min_update_ms,
+                         Settings::max_update_ms,
+                         "%d",
+                         ImGuiSliderFlags_AlwaysClamp)) {
+        game.setStepDelay(settings.step_delta_ms);
+    }
+    if (ImGui::Checkbox("Unthrottled", &settings.unthrottled)) {
+        game.setUnthrottled(settings.unthrottled);
+    }
+
+    ImGui::Separator();
+    ImGui::TextUnformatted("Pattern file (.cells, .rle or .gol):");
+    ImGui::InputText("##pattern",
+                     settings.pattern_path.data(),
+                     settings.pattern_path.size());
+    try {
+        if (ImGui::Button("Load")) {
+            game.loadPattern(readPattern(settings.pattern_path.data()));
+            settings.pattern_status = "Loaded";
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Paste")) {
+            game.pastePattern(readPattern(settings.pattern_path.data()));
+            settings.pattern_status = "Pasted";
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Save")) {
+            game.savePattern(settings.pattern_path.data());
+            settings.pattern_status = "Saved";
+        }
+    } catch (const std::runtime_error& e) {
+        settings.pattern_status = e.what();
+    }
+    if (!settings.pattern_status.empty()) {
+        ImGui::TextWrapped("%s", settings.pattern_status.c_str());
+    }
+
+    ImGui::Separator();
+    ImGui::TextUnformatted("Editing (left drag to paint):");
+    ImGui::SliderInt("Brush",
+                     &settings.brush_size,
+                     1,
+                     Settings::max_brush_size,
+                     "%d cells",
                      ImGuiSliderFlags_AlwaysClamp);
+    ImGui::SliderFloat("Density",
+                       &settings.fill_density,
+                       0.f,
+                       1.f,
+                       "%.2f",
+                       ImGuiSliderFlags_AlwaysClamp);
+    if (ImGui::Button("Random Fill")) {
+        game.randomFill(settings.fill_density, settings.fill_seed++);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Clear")) {
+        game.clearBoard();
+    }
+
+    ImGui::Separator();
+    ImGui::Text("Rule: %s", toString(game.rule()).c_str());
+    if (game.topology() == Topology::plane) {
+        ImGui::Text("View: %lld, %lld (WASD to move)",
+                    static_cast<long long>(game.viewX()),
+                    static_cast<long long>(game.viewY()));
+    }
+    ImGui::Text("Zoom: %g pixels per cell (wheel to zoom, right drag to move)",
+                game.cellPixels());
+    ImGui::Text("Generation: %llu", static_cast<unsigned long long>(game.generation()));
+    drawTimeline(game, settings);
+    if (const auto& cycle = game.cycle(); cycle) {
+        ImGui::TextWrapped("%s", describeCycle(*cycle).c_str());
+    }
+
+    if (ImGui::CollapsingHeader("Statistics")) {
+        drawStatistics(game);
+    }
+    if (ImGui::CollapsingHeader("Performance")) {
+        drawPerformance(game, settings);
+    }
 
     ImGui::End();
 }
 
+void drawTimeline(GameOfLife& game, Settings& settings) {
+    const auto oldest = game.historyOldest();
+    const auto newest = game.historyNewest();
+    if (oldest == newest) {
+        return;
+    }
+    // Dragging the slider pauses, and seeks once per change of the value.
+    auto generation = static_cast<long long>(game.generation());
+    const auto min = static_cast<long long>(oldest);
+    const auto max = static_cast<long long>(newest);
+    if (ImGui::SliderScalar("History",
+                            ImGuiDataType_S64,
+                            &generation,
+                            &min,
+                            &max,
+                            "%lld",
+                            ImGuiSliderFlags_AlwaysClamp)) {
+        settings.paused = true;
+        game.setPaused(true);
+        game.seekGeneration(static_cast<std::uint64_t>(generation));
+    }
+    ImGui::TextDisabled("Backspace steps back, Shift+Backspace %d generations",
+                        Settings::step_back_fast);
+}
+
+std::string describeCycle(const Cycle& cycle) {
+    const auto start = std::to_string(cycle.start);
+    if (cycle.period == 1) {
+        return "Still since generation " + start;
+    }
+    return "Repeats every " + std::to_string(cycle.period)
+           + " generations since generation " + start;
+}
+
+void drawCycleNotice(const GameOfLife& game) {
+    const auto& cycle = game.cycle();
+    if (!cycle) {
+        return;
+    }
+    constexpr static ImGuiWindowFlags window_flags = ImGuiWindowFlags_NoDecoration
+                                                     | ImGuiWindowFlags_AlwaysAutoResize
+                                                     | ImGuiWindowFlags_NoMove
+                                                     | ImGuiWindowFlags_NoSavedSettings
+                                                     | ImGuiWindowFlags_NoFocusOnAppearing
+                                                     | ImGuiWindowFlags_NoNav;
+    ImGui::SetNextWindowPos(ImVec2{10, 10});
+    ImGui::SetNextWindowBgAlpha(0.6f);
+    ImGui::Begin("##cycle", nullptr, window_flags);
+    ImGui::TextUnformatted(describeCycle(*cycle).c_str());
+    ImGui::End();
+}
+
+void drawStatistics(const GameOfLife& game) {
+    const auto& statistics = game.statistics();
+    if (!statistics) {
+        ImGui::TextDisabled("Not counted on the plane");
+        return;
+    }
+    const auto print = [](std::uint64_t value) {
+        return static_cast<unsigned long long>(value);
+    };
+    ImGui::Text("Population: %llu", print(statistics->population));
+    ImGui::Text("Births: %llu, deaths: %llu",
+                print(statistics->births),
+                print(statistics->deaths));
+    if (statistics->hasBounds()) {
+        ImGui::Text("Bounds: rows %zu-%zu, columns %zu-%zu",
+                    statistics->first.row,
+                    statistics->last.row - 1,
+                    statistics->first.col,
+                    statistics->last.col - 1);
+    } else {
+        ImGui::TextUnformatted("Bounds: empty board");
+    }
+}
+
+void drawPerformance(GameOfLife& game, Settings& settings) {
+    const auto& metrics = game.metrics();
+
+    const auto step = metrics.summarize(Scope::step);
+    ImGui::Text("Step: %.3f ms (max %.3f ms)", step.mean_ms, step.max_ms);
+    ImGui::Text("Generations/s: %.1f",
+                settings.generation_rate.update(metrics.get(Counter::generation),
+                                                RateMeter::Clock::now()));
+    ImGui::Text("Population: %llu",
+                static_cast<unsigned long long>(metrics.get(Counter::population)));
+    const auto getKiB = [&metrics](Counter counter) {
+        return static_cast<unsigned long long>(metrics.get(counter) / 1024);
+    };
+    ImGui::Text("Memory: engine %llu KiB, frames %llu KiB",
+                getKiB(Counter::engine_bytes),
+                getKiB(Counter::frame_bytes));
+
+    for (const auto scope :
+         {Scope::publish, Scope::seek, Scope::events, Scope::imgui, Scope::render}) {
+        const auto summary = metrics.summarize(scope);
+        ImGui::Text("%-8s %.3f ms (max %.3f ms)",
+                    toString(scope).data(),
+                    summary.mean_ms,
+                    summary.max_ms);
+    }
+
+    const auto frames = metrics.timings(Scope::frame);
+    std::vector<float> frame_ms(frames.size());
+    std::ranges::transform(frames, frame_ms.begin(), [](std::uint64_t ns) {
+        return static_cast<float>(ns) / 1e6f;
+    });
+    const auto frame = metrics.summarize(Scope::frame);
+    std::array<char, 32> overlay{};
+    std::snprintf(overlay.data(), overlay.size(), "frame %.2f ms", frame.mean_ms);
+    ImGui::PlotHistogram("##frames",
+                         frame_ms.data(),
+                         static_cast<int>(frame_ms.size()),
+                         0,
+                         overlay.data(),
+                         0.f,
+                         static_cast<float>(frame.max_ms),
+                         ImVec2{ImGui::GetContentRegionAvail().x, 60});
+
+    ImGui::TextUnformatted("Export (.csv or .json):");
+    ImGui::InputText("##metrics",
+                     settings.metrics_path.data(),
+                     settings.metrics_path.size());
+    ImGui::SameLine();
+    if (ImGui::Button("Export")) {
+        try {
+            writeMetrics(settings.metrics_path.data(), metrics);
+            settings.metrics_status = "Exported";
+        } catch (const std::runtime_error& e) {
+            settings.metrics_status = e.what();
+        }
+    }
+    if (!settings.metrics_status.empty()) {
+        ImGui::TextWrapped("%s", settings.metrics_status.c_str());
+    }
+}
+
 void runGameLoop(sf::RenderWindow& window, GameOfLife& game) {
     auto settings = Settings{};
     auto clock = sf::Clock{};
-    int elapsed = 0;
 
-    while (window.isOpen()) {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            handleEvent(window, event, game, settings);
-        }
+    // The simulation runs on its own thread, this loop only renders the latest
+    // generation it published.
+    game.setPaused(settings.paused);
+    game.setStepDelay(settings.step_delta_ms);
+    game.setUnthrottled(settings.unthrottled);
 
-        ImGui::SFML::Update(window, clock.getElapsedTime());
-
-        if (settings.in_menu) {
-            drawMenu(window, game, settings);
+    auto& metrics = game.metrics();
+    while (window.isOpen()) {
+        const ScopedTimer frame_timer{metrics, Scope::frame};
+        {
+            const ScopedTimer timer{metrics, Scope::events};
+            sf::Event event;
+            while (window.pollEvent(event)) {
+                handleEvent(window, event, game, settings);
+            }
         }
 
-        if (!settings.paused) {
-            elapsed += clock.restart().asMilliseconds();
-            if (elapsed >= settings.step_delta_ms) {
-                elapsed = 0;
-                game.runStep();
+        {
+            const ScopedTimer timer{metrics, Scope::imgui};
+            ImGui::SFML::Update(window, clock.restart());
+            if (settings.in_menu) {
+                drawMenu(window, game, settings);
+            } else {
+                drawCycleNotice(game);
             }
         }
 
         window.clear(settings.background_color.toSfColor());
-        game.render(window);
+        {
+            const ScopedTimer timer{metrics, Scope::render};
+            game.render(window);
+        }
         ImGui::SFML::Render(window);
         window.display();
     }
@@ -140,7 +426,29 @@ void runGame(RunOptions options) {
     ImGui::GetIO().IniFilename = nullptr;
 
     const auto [x, y] = window.getSize();
-    auto game = GameOfLife({0, 0}, x, y, options.cell_size);
+    auto game = GameOfLife({0, 0},
+                           x,
+                           y,
+                           options.cell_size,
+                           Index{options.board_height, options.board_width},
+                           options.threads,
+                           options.rule,
+                           options.plane ? Topology::plane : Topology::torus);
+    if (!options.resume.empty()) {
+        auto [board, generation] = readCheckpoint(options.resume);
+        game.loadPattern(std::move(board), generation);
+    } else if (!options.pattern.empty()) {
+        game.loadPattern(readPattern(options.pattern));
+    }
+    game.setHistoryLimit(options.history_mib * 1024 * 1024);
+    if (options.checkpoint_every > 0) {
+        game.setCheckpoints(options.checkpoint_file, options.checkpoint_every);
+    }
+    // Declared after the game, so it stops before the simulation it drives.
+    std::optional<ControlServer> control;
+    if (!options.control.empty()) {
+        control.emplace(game.simulation(), options.control);
+    }
 
     runGameLoop(window, game);
 
@@ -1,8 +1,12 @@
 #pragma once
 
 #include "game.h"
+#include "metrics.h"
 #include "options.h"
 #include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
 #include <SFML/Graphics.hpp>
 
 struct RGBColor {
@@ -35,10 +39,23 @@ struct Settings {
     bool paused = true;
     bool in_menu = true;
     int step_delta_ms = 400;
+    bool unthrottled = false;
+    std::array<char, 256> pattern_path = {"pattern.rle"};
+    std::string pattern_status;
     RGBColor grid_color = {GameOfLife::default_grid};
     RGBColor alive_color = {GameOfLife::default_alive};
     RGBColor dead_color = {GameOfLife::default_dead};
     RGBColor background_color = {sf::Color::Black};
+    // Last mouse position of a drag with the right or middle button.
+    std::optional<sf::Vector2i> drag_position;
+    // Side of the square brush painting with the left mouse button, in cells.
+    int brush_size = 1;
+    float fill_density = 0.3f;
+    // Every random fill gets a seed of its own.
+    std::uint64_t fill_seed = 1;
+    std::array<char, 256> metrics_path = {"metrics.csv"};
+    std::string metrics_status;
+    RateMeter generation_rate;
 
     void increaseSpeed() {
         if (step_delta_ms <= max_update_ms - update_delta_ms) {
@@ -55,6 +72,11 @@ struct Settings {
     static constexpr int max_update_ms = 10'000;
     static constexpr int min_update_ms = 1;
     static constexpr int update_delta_ms = 100;
+    // Cells the view moves per key press on the plane.
+    static constexpr int pan_cells = 8;
+    static constexpr int max_brush_size = 256;
+    // Generations Shift+Backspace steps back.
+    static constexpr int step_back_fast = 100;
 };
 
 void handleEvent(sf::RenderWindow& window,
@@ -62,5 +84,13 @@ void handleEvent(sf::RenderWindow& window,
                  GameOfLife& game,
                  Settings& settings);
 void drawMenu(sf::RenderWindow& window, GameOfLife& game, Settings& settings);
+void drawPerformance(GameOfLife& game, Settings& settings);
+// Counts of the generation on screen, kept by the engine while stepping.
+void drawStatistics(const GameOfLife& game);
+// Slider over the generations the history can go back to.
+void drawTimeline(GameOfLife& game, Settings& settings);
+std::string describeCycle(const Cycle& cycle);
+// Shows when the board started repeating while the menu is hidden.
+void drawCycleNotice(const GameOfLife& game);
 void runGameLoop(sf::RenderWindow& window, GameOfLife& game);
 void runGame(RunOptions options);
@@ -0,0 +1,127 @@
+#include "work_stealing_pool.h"
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(std::size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    queues_.reserve(threads);
+    for (std::size_t i = 0; i < threads; i++) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    workers_.reserve(threads - 1);
+    for (std::size_t i = 1; i < threads; i++) {
+        workers_.emplace_back([this, i] { runWorker(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        const std::lock_guard lock{mutex_};
+        stopping_ = true;
+    }
+    start_cv_.notify_all();
+
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void WorkStealingPool::run(std::size_t count, const Task& task) {
+    // Deal out contiguous blocks, neighbouring tasks tend to be alike.
+    const auto threads = threadCount();
+    for (std::size_t worker = 0; worker < threads; worker++) {
+        auto& queue = *queues_[worker];
+        const std::lock_guard lock{queue.mutex};
+        for (auto i = count * worker / threads; i < count * (worker + 1) / threads; i++) {
+            queue.indices.push_back(i);
+        }
+    }
+
+    {
+        const std::lock_guard lock{mutex_};
+        task_ = &task;
+        pending_ = workers_.size();
+        generation_++;
+    }
+    start_cv_.notify_all();
+
+    drain(0);
+
+    std::unique_lock lock{mutex_};
+    done_cv_.wait(lock, [this] { return pending_ == 0; });
+    task_ = nullptr;
+}
+
+std::uint64_t WorkStealingPool::stealCount() const {
+    std::uint64_t result = 0;
+    for (const auto& queue : queues_) {
+        const std::lock_guard lock{queue->mutex};
+        result += queue->steals;
+    }
+    return result;
+}
+
+void WorkStealingPool::runWorker(std::size_t worker) {
+    std::uint64_t seen_generation = 0;
+
+    while (true) {
+        {
+            std::unique_lock lock{mutex_};
+            start_cv_.wait(lock, [&] {
+                return stopping_ || generation_ != seen_generation;
+            });
+            if (stopping_) {
+                return;
+            }
+            seen_generation = generation_;
+        }
+
+        drain(worker);
+
+        bool is_last = false;
+        {
+            const std::lock_guard lock{mutex_};
+            is_last = --pending_ == 0;
+        }
+        if (is_last) {
+            done_cv_.notify_one();
+        }
+    }
+}
+
+void WorkStealingPool::drain(std::size_t worker) const {
+    // Tasks are only ever added before the workers start, so once no deque
+    // has any left there is nothing more to wait for.
+    std::size_t index = 0;
+    while (popOwn(worker, index) || steal(worker, index)) {
+        (*task_)(index, worker);
+    }
+}
+
+bool WorkStealingPool::popOwn(std::size_t worker, std::size_t& index) const {
+    auto& queue = *queues_[worker];
+    const std::lock_guard lock{queue.mutex};
+    if (queue.indices.empty()) {
+        return false;
+    }
+    index = queue.indices.back();
+    queue.indices.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(std::size_t worker, std::size_t& index) const {
+    const auto threads = threadCount();
+    for (std::size_t offset = 1; offset < threads; offset++) {
+        auto& victim = *queues_[(worker + offset) % threads];
+        const std::lock_guard lock{victim.mutex};
+        if (!victim.indices.empty()) {
+            index = victim.indices.front();
+            victim.indices.pop_front();
+            victim.steals++;
+            return true;
+        }
+    }
+    return false;
+}
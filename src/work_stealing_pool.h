@@ -0,0 +1,64 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent pool of worker threads for many independent tasks of uneven
+// length. Every worker owns a deque of task indices: it takes its own from
+// the back and, once they run out, steals from the front of the others', so
+// a worker that drew the long tasks does not hold up the rest. As with
+// ThreadPool, the calling thread is worker 0 and a pool of one thread runs
+// everything inline.
+class WorkStealingPool {
+public:
+    // Called with the task index and the worker running it, which lets tasks
+    // keep per-worker state without locking.
+    using Task = std::function<void(std::size_t index, std::size_t worker)>;
+
+    // Zero threads means one per hardware thread.
+    explicit WorkStealingPool(std::size_t threads);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    std::size_t threadCount() const { return queues_.size(); }
+
+    // Runs `task` for every index in [0, count) and returns once all are done.
+    void run(std::size_t count, const Task& task);
+
+    // Tasks taken from another worker's deque since the pool was created.
+    std::uint64_t stealCount() const;
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::size_t> indices;
+        std::uint64_t steals = 0;
+    };
+
+    void runWorker(std::size_t worker);
+    // Runs tasks until every deque is empty.
+    void drain(std::size_t worker) const;
+    bool popOwn(std::size_t worker, std::size_t& index) const;
+    bool steal(std::size_t worker, std::size_t& index) const;
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+
+    const Task* task_ = nullptr;
+    std::uint64_t generation_ = 0;
+    std::size_t pending_ = 0;
+    bool stopping_ = false;
+};
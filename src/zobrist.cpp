@@ -0,0 +1,49 @@
+#include "zobrist.h"
+#include <bit>
+#include <cstring>
+
+std::uint64_t hashGrid(const Grid& grid, std::int64_t x, std::int64_t y) {
+    std::uint64_t hash = 0;
+    for (std::size_t i = 0; i < grid.rows(); i++) {
+        const auto* row = grid.row(i);
+        for (std::size_t j = 0; j < grid.columns(); j++) {
+            if (row[j].data) {
+                hash ^= getCellKey(x + static_cast<std::int64_t>(j),
+                                   y + static_cast<std::int64_t>(i));
+            }
+        }
+    }
+    return hash;
+}
+
+std::uint64_t hashRowChanges(const Cell* before,
+                             const Cell* after,
+                             std::size_t first,
+                             std::size_t last,
+                             std::int64_t y,
+                             std::int64_t x) {
+    static_assert(sizeof(Cell) == 1);
+    constexpr std::size_t word_cells = sizeof(std::uint64_t);
+
+    std::uint64_t hash = 0;
+    auto j = first;
+    for (; j + word_cells <= last; j += word_cells) {
+        std::uint64_t before_word;
+        std::uint64_t after_word;
+        std::memcpy(&before_word, before + j, word_cells);
+        std::memcpy(&after_word, after + j, word_cells);
+        // Cells are 0 or 1, so every set bit of the difference is one changed
+        // cell, whichever the byte order.
+        auto changed = before_word ^ after_word;
+        for (; changed != 0; changed &= changed - 1) {
+            const auto byte = static_cast<std::size_t>(std::countr_zero(changed)) / 8;
+            hash ^= getCellKey(x + static_cast<std::int64_t>(j + byte), y);
+        }
+    }
+    for (; j < last; j++) {
+        if (before[j].data != after[j].data) {
+            hash ^= getCellKey(x + static_cast<std::int64_t>(j), y);
+        }
+    }
+    return hash;
+}
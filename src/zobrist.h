@@ -0,0 +1,32 @@
+#pragma once
+
+#include "grid.h"
+#include <cstdint>
+#include <cstdlib>
+
+// Zobrist hashing of boards: the hash of a board is the XOR of a
+// pseudo-random key per live cell, so flipping a cell updates it with one
+// XOR and a step only has to look at the cells it changed. The keys are
+// derived from the cell coordinates instead of being stored, which keeps them
+// free for boards of any size, including the unbounded plane.
+inline std::uint64_t getCellKey(std::int64_t x, std::int64_t y) {
+    // splitmix64 of the packed coordinates.
+    auto key = static_cast<std::uint64_t>(y) * 0x9e3779b97f4a7c15ULL
+               + static_cast<std::uint64_t>(x);
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+    return key ^ (key >> 31);
+}
+
+// Hash of the whole grid with its upper left cell at (x, y).
+std::uint64_t hashGrid(const Grid& grid, std::int64_t x = 0, std::int64_t y = 0);
+
+// XOR of the keys of the cells in [first, last) that differ between two
+// versions of row `y`, whose cell 0 lies at column `x`. Unchanged stretches
+// are skipped eight cells at a time.
+std::uint64_t hashRowChanges(const Cell* before,
+                             const Cell* after,
+                             std::size_t first,
+                             std::size_t last,
+                             std::int64_t y,
+                             std::int64_t x = 0);
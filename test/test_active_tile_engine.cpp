@@ -0,0 +1,114 @@
+#include "catch.hpp"
+#include "test_helpers.h"
+#include "../src/active_tile_engine.h"
+#include "../src/zobrist.h"
+
+TEST_CASE("Active tile engine matches the full scan on random boards", "[active_tile_engine]") {
+	const std::size_t sizes[][3] = {
+		{ 5, 7, 4 }, { 16, 16, 8 }, { 30, 45, 8 }, { 100, 70, 16 }, { 64, 200, 64 }, { 9, 9, 1 }
+	};
+	for (const auto& size : sizes) {
+		for (const std::size_t threads : { 1, 3 }) {
+			INFO("board " << size[0] << "x" << size[1] << ", tile " << size[2]);
+			const auto seed = static_cast<unsigned>(size[0]);
+			const auto grid = makeRandomGrid(size[0], size[1], 0.1, seed);
+			GridEngine full{ size[0], size[1] };
+			ActiveTileEngine active{ size[0], size[1], threads, size[2] };
+			full.load(grid);
+			active.load(grid);
+			for (int gen = 0; gen < 150; gen++) {
+				full.step(1);
+				active.step(1);
+				REQUIRE(isSame(full.current(), active.current()));
+			}
+		}
+	}
+}
+
+TEST_CASE("Active tile engine matches the full scan for other rules", "[active_tile_engine]") {
+	// B0 rules flip empty space every generation, so nothing is skipped there.
+	for (const auto& rule : { highlife_rule, seeds_rule, parseRule("B0/S8"), parseRule("B35678/S5678") }) {
+		INFO("rule: " << toString(rule));
+		const auto grid = makeRandomGrid(40, 90, 0.2, 11);
+		GridEngine full{ 40, 90, 1, rule };
+		ActiveTileEngine active{ 40, 90, 2, 16, rule };
+		full.load(grid);
+		active.load(grid);
+		for (int gen = 0; gen < 60; gen++) {
+			full.step(1);
+			active.step(1);
+			REQUIRE(isSame(full.current(), active.current()));
+		}
+	}
+}
+
+TEST_CASE("Active tile engine follows a glider across the wrap-around", "[active_tile_engine]") {
+	{
+		GridEngine full{ 40, 40 };
+		ActiveTileEngine active{ 40, 40, 1, 8 };
+		const Index glider[] = { { 35, 36 }, { 36, 37 }, { 37, 35 }, { 37, 36 }, { 37, 37 } };
+		for (const auto ind : glider) {
+			full.set(ind, true);
+			active.set(ind, true);
+		}
+		for (int gen = 0; gen < 4 * 40; gen++) {
+			full.step(1);
+			active.step(1);
+			REQUIRE(isSame(full.current(), active.current()));
+			// Every tile starts out active, afterwards only the ones around
+			// the at most 2x2 tiles the glider touches are.
+			REQUIRE(active.activeTileCount() <= (gen == 0 ? 25 : 16));
+		}
+	}
+}
+
+TEST_CASE("Active tile engine skips still boards", "[active_tile_engine]") {
+	{
+		ActiveTileEngine engine{ 256, 256, 1, 32 };
+		REQUIRE(engine.tileCount() == 64);
+		// A block is a still life.
+		const Index block[] = { { 100, 100 }, { 100, 101 }, { 101, 100 }, { 101, 101 } };
+		for (const auto ind : block) {
+			engine.set(ind, true);
+		}
+		engine.step(1);
+		REQUIRE(engine.activeTileCount() == 64);
+		engine.step(1);
+		REQUIRE(engine.activeTileCount() == 0);
+		REQUIRE(engine.population() == 4);
+
+		// Edits wake the tiles around them up again.
+		engine.set({ 0, 0 }, true);
+		engine.step(1);
+		REQUIRE(engine.activeTileCount() == 9);
+		REQUIRE(engine.get({ 0, 0 }) == false);
+		engine.step(1);
+		REQUIRE(engine.activeTileCount() == 9);
+		engine.step(1);
+		REQUIRE(engine.activeTileCount() == 0);
+	}
+}
+
+TEST_CASE("Active tile engine steps regions edited in bulk", "[active_tile_engine]") {
+	{
+		// On a board that went still, an edit wrapping around a corner and not
+		// aligned to the tiles has to wake up the tiles under it.
+		GridEngine reference{ 70, 90 };
+		ActiveTileEngine engine{ 70, 90, 1, 16 };
+		for (auto* target : { static_cast<GridEngine*>(&reference), static_cast<GridEngine*>(&engine) }) {
+			target->trackHash();
+			target->step(5);
+			target->edit({ 60, 80 }, { 25, 30 }, [](Grid& grid) {
+				fillRandom(grid, { 60, 80 }, { 25, 30 }, 0.4, 8);
+			});
+		}
+		REQUIRE(engine.hash() == reference.hash());
+		REQUIRE(engine.hash() == hashGrid(engine.current()));
+		for (int generation = 0; generation < 30; generation++) {
+			reference.step(1);
+			engine.step(1);
+			REQUIRE(isSame(engine.current(), reference.current()));
+			REQUIRE(engine.hash() == reference.hash());
+		}
+	}
+}
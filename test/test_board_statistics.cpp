@@ -0,0 +1,173 @@
+#include <memory>
+#include <vector>
+#include "catch.hpp"
+#include "test_helpers.h"
+#include "../src/active_tile_engine.h"
+#include "../src/board_statistics.h"
+#include "../src/hashlife.h"
+#include "../src/tiled_grid_engine.h"
+
+namespace {
+
+// Counts cell by cell what the engines count a word at a time.
+BoardStatistics countCells(const Grid& before, const Grid& after) {
+	BoardStatistics counts;
+	for (std::size_t i = 0; i < after.rows(); i++) {
+		for (std::size_t j = 0; j < after.columns(); j++) {
+			const bool was_alive = before.at({ i, j }).data;
+			const bool is_alive = after.at({ i, j }).data;
+			counts.population += is_alive;
+			counts.births += is_alive && !was_alive;
+			counts.deaths += was_alive && !is_alive;
+			if (is_alive) {
+				counts.includeBounds({ i, j }, { i + 1, j + 1 });
+			}
+		}
+	}
+	return counts;
+}
+
+void requireSameCounts(const BoardStatistics& lhs, const BoardStatistics& rhs) {
+	REQUIRE(lhs.population == rhs.population);
+	REQUIRE(lhs.births == rhs.births);
+	REQUIRE(lhs.deaths == rhs.deaths);
+	REQUIRE(lhs.hasBounds() == rhs.hasBounds());
+	REQUIRE(lhs.first.row == rhs.first.row);
+	REQUIRE(lhs.first.col == rhs.first.col);
+	REQUIRE(lhs.last.row == rhs.last.row);
+	REQUIRE(lhs.last.col == rhs.last.col);
+}
+
+}
+
+TEST_CASE("Row counts match counting cell by cell", "[board_statistics]") {
+	{
+		// Wide enough for the byte lanes to be summed more than once per row.
+		Grid before{ 1, 2100 };
+		Grid after{ 1, 2100 };
+		fillRandom(before, 0.4, 1);
+		fillRandom(after, 0.4, 2);
+		for (const auto& [first, last] : { std::pair<std::size_t, std::size_t>{ 0, 2100 }, { 3, 2091 }, { 5, 12 }, { 7, 7 } }) {
+			INFO("cells " << first << " to " << last);
+			BoardStatistics counts;
+			countRowChanges(before.row(0), after.row(0), first, last, 0, counts);
+			BoardStatistics expected;
+			for (auto j = first; j < last; j++) {
+				const bool was_alive = before.at({ 0, j }).data;
+				const bool is_alive = after.at({ 0, j }).data;
+				expected.population += is_alive;
+				expected.births += is_alive && !was_alive;
+				expected.deaths += was_alive && !is_alive;
+				if (is_alive) {
+					expected.includeBounds({ 0, j }, { 1, j + 1 });
+				}
+			}
+			requireSameCounts(counts, expected);
+		}
+	}
+	{
+		// A single live cell at every position of a word, and none.
+		for (std::size_t col = 0; col < 19; col++) {
+			Grid row{ 1, 19 };
+			row.at({ 0, col }).data = true;
+			BoardStatistics counts;
+			countRowChanges(row.row(0), row.row(0), 0, 19, 4, counts);
+			REQUIRE(counts.population == 1);
+			REQUIRE(counts.first.row == 4);
+			REQUIRE(counts.first.col == col);
+			REQUIRE(counts.last.row == 5);
+			REQUIRE(counts.last.col == col + 1);
+		}
+		const Grid empty{ 1, 19 };
+		BoardStatistics counts;
+		countRowChanges(empty.row(0), empty.row(0), 0, 19, 4, counts);
+		REQUIRE(counts.population == 0);
+		REQUIRE_FALSE(counts.hasBounds());
+	}
+}
+
+TEST_CASE("Grid engines count every step", "[board_statistics]") {
+	std::vector<std::unique_ptr<GridEngine>> engines;
+	engines.push_back(std::make_unique<GridEngine>(37, 83, 3));
+	engines.push_back(std::make_unique<TiledGridEngine>(37, 83, 3, Index{ 8, 16 }));
+	for (auto& engine : engines) {
+		INFO("engine: " << engine->name());
+		Grid board{ 37, 83 };
+		fillRandom(board, { 5, 10 }, { 12, 20 }, 0.5, 3);
+		engine->load(board);
+		REQUIRE(engine->trackStatistics());
+		requireSameCounts(engine->boardStatistics(), countCells(board, board));
+
+		Grid previous{ 37, 83 };
+		for (int gen = 0; gen < 40; gen++) {
+			engine->save(previous);
+			engine->step(1);
+			const auto counts = engine->boardStatistics();
+			REQUIRE(counts.generation == engine->generation());
+			requireSameCounts(counts, countCells(previous, engine->current()));
+			REQUIRE(engine->population() == counts.population);
+		}
+	}
+}
+
+TEST_CASE("Edits keep the population and the bounds exact", "[board_statistics]") {
+	{
+		GridEngine engine{ 20, 30 };
+		REQUIRE(engine.trackStatistics());
+		REQUIRE(engine.population() == 0);
+		REQUIRE_FALSE(engine.boardStatistics().hasBounds());
+
+		engine.set({ 4, 6 }, true);
+		engine.set({ 4, 6 }, true);
+		engine.set({ 9, 2 }, true);
+		engine.set({ 6, 4 }, true);
+		REQUIRE(engine.population() == 3);
+		requireSameCounts(engine.boardStatistics(), countGrid(engine.current()));
+
+		// A cell inside the bounds leaves them as they are.
+		engine.set({ 6, 4 }, false);
+		REQUIRE(engine.population() == 2);
+		REQUIRE(engine.boardStatistics().first.row == 4);
+		REQUIRE(engine.boardStatistics().first.col == 2);
+		REQUIRE(engine.boardStatistics().last.row == 10);
+		REQUIRE(engine.boardStatistics().last.col == 7);
+
+		// The rectangle wraps around the corner of the board.
+		engine.edit({ 18, 28 }, { 4, 4 }, [](Grid& cells) { fillRect(cells, { 18, 28 }, { 4, 4 }, true); });
+		REQUIRE(engine.population() == 18);
+		requireSameCounts(engine.boardStatistics(), countGrid(engine.current()));
+		engine.edit({ 18, 28 }, { 4, 4 }, [](Grid& cells) { fillRect(cells, { 18, 28 }, { 4, 4 }, false); });
+		engine.set({ 9, 2 }, false);
+		REQUIRE(engine.population() == 1);
+		const auto counts = engine.boardStatistics();
+		REQUIRE(counts.first.row == 4);
+		REQUIRE(counts.first.col == 6);
+		REQUIRE(counts.last.row == 5);
+		REQUIRE(counts.last.col == 7);
+
+		// A step fits the bounds to the cells as well.
+		engine.step(1);
+		requireSameCounts(engine.boardStatistics(), countCells(engine.previous(), engine.current()));
+	}
+	{
+		// Clearing the board leaves no bounds.
+		TiledGridEngine engine{ 40, 50, 2 };
+		engine.load(makeRandomGrid(40, 50, 0.3, 9));
+		REQUIRE(engine.trackStatistics());
+		REQUIRE(engine.boardStatistics().hasBounds());
+		engine.edit({ 0, 0 }, { 40, 50 }, [](Grid& cells) { fillRect(cells, { 0, 0 }, cells.getSize(), false); });
+		REQUIRE(engine.population() == 0);
+		REQUIRE_FALSE(engine.boardStatistics().hasBounds());
+		REQUIRE(engine.boardStatistics().last.row == 0);
+		REQUIRE(engine.boardStatistics().last.col == 0);
+	}
+}
+
+TEST_CASE("Engines that skip cells do not count them", "[board_statistics]") {
+	{
+		ActiveTileEngine active{ 16, 16 };
+		REQUIRE_FALSE(active.trackStatistics());
+		HashLifeEngine hashlife;
+		REQUIRE_FALSE(hashlife.trackStatistics());
+	}
+}
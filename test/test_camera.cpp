@@ -0,0 +1,63 @@
+#include "catch.hpp"
+#include "../src/camera.h"
+
+TEST_CASE("Camera maps between screen pixels and cells", "[camera]") {
+	{
+		Camera camera{ 10, 5, -2 };
+		REQUIRE(camera.toCellX(0) == 5);
+		REQUIRE(camera.toCellX(25) == 7.5);
+		REQUIRE(camera.toCellY(20) == 0);
+		REQUIRE(camera.toScreenX(7.5) == 25);
+		REQUIRE(camera.toScreenY(0) == 20);
+	}
+	{
+		Camera camera{ 4 };
+		camera.drag(8, -4);
+		REQUIRE(camera.x() == -2);
+		REQUIRE(camera.y() == 1);
+	}
+}
+
+TEST_CASE("Camera zooms in whole pixels and out in powers of two", "[camera]") {
+	{
+		Camera camera{ 1 };
+		camera.zoom(1, 0, 0, 10);
+		REQUIRE(camera.cellPixels() == 2);
+		camera.zoom(3, 0, 0, 10);
+		REQUIRE(camera.cellPixels() == 5);
+		camera.zoom(1, 0, 0, 10);
+		REQUIRE(camera.cellPixels() == 6);
+		camera.zoom(-1, 0, 0, 10);
+		REQUIRE(camera.cellPixels() == 5);
+		REQUIRE(camera.level() == 0);
+	}
+	{
+		Camera camera{ 1 };
+		camera.zoom(-3, 0, 0, 10);
+		REQUIRE(camera.cellPixels() == 0.125);
+		REQUIRE(camera.level() == 3);
+		camera.zoom(2, 0, 0, 10);
+		REQUIRE(camera.cellPixels() == 0.5);
+		REQUIRE(camera.level() == 1);
+	}
+	{
+		Camera camera{ 1 };
+		camera.zoom(-20, 0, 0, 4);
+		REQUIRE(camera.cellPixels() == 0.0625);
+		camera.zoom(100, 0, 0, 4);
+		REQUIRE(camera.cellPixels() == Camera::max_cell_pixels);
+	}
+}
+
+TEST_CASE("Camera keeps the cell under the zoom point in place", "[camera]") {
+	{
+		Camera camera{ 8, 10, 20 };
+		const auto x = camera.toCellX(100);
+		const auto y = camera.toCellY(60);
+		for (const auto steps : { 3, -5, -2, 4 }) {
+			camera.zoom(steps, 100, 60, 12);
+			REQUIRE(camera.toCellX(100) == Approx(x));
+			REQUIRE(camera.toCellY(60) == Approx(y));
+		}
+	}
+}
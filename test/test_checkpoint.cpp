@@ -0,0 +1,110 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include "catch.hpp"
+#include "../src/checkpoint.h"
+
+namespace {
+
+constexpr auto checkpoint_path = "test_checkpoint.ckpt";
+
+void requireEqual(const Grid& first, const Grid& second) {
+	REQUIRE(first.rows() == second.rows());
+	REQUIRE(first.columns() == second.columns());
+	for (std::size_t i = 0; i < first.rows(); i++) {
+		for (std::size_t j = 0; j < first.columns(); j++) {
+			REQUIRE(first.at({ i, j }).data == second.at({ i, j }).data);
+		}
+	}
+}
+
+}
+
+TEST_CASE("Checkpoints resume from the last saved generation", "[checkpoint]") {
+	{
+		// Two gliders, sparse enough for delta checkpoints.
+		Grid grid{ 40, 600 };
+		for (const std::size_t offset : { 0, 300 }) {
+			for (const auto [row, col] : { Index{ 0, 1 }, Index{ 1, 2 }, Index{ 2, 0 }, Index{ 2, 1 }, Index{ 2, 2 } }) {
+				grid.at({ row + 10, col + offset }).data = true;
+			}
+		}
+
+		Grid next{ 40, 600 };
+		{
+			CheckpointWriter writer{ checkpoint_path, 4 };
+			for (std::uint64_t generation = 1; generation <= 10; generation++) {
+				grid.step(next);
+				std::swap(grid, next);
+				writer.save(grid, generation);
+				writer.flush();
+				const auto snapshot = readCheckpoint(checkpoint_path);
+				REQUIRE(snapshot.generation == generation);
+				requireEqual(snapshot.grid, grid);
+			}
+
+			const auto stats = writer.statistics();
+			REQUIRE(stats.checkpoints == 10);
+			REQUIRE(stats.full_checkpoints == 3);
+			REQUIRE(stats.stall_seconds > 0);
+		}
+		std::remove(checkpoint_path);
+	}
+}
+
+TEST_CASE("Checkpoint deltas only store changed blocks", "[checkpoint]") {
+	{
+		Grid grid{ 64, 1024 };
+		CheckpointWriter writer{ checkpoint_path };
+		writer.save(grid, 0);
+		writer.flush();
+		const auto full_size = std::filesystem::file_size(checkpoint_path);
+
+		grid.at({ 10, 10 }).data = true;
+		writer.save(grid, 1);
+		writer.flush();
+		// One block index and eight words after the record header.
+		REQUIRE(std::filesystem::file_size(checkpoint_path) == full_size + 3 * 8 + 9 * 8);
+
+		const auto snapshot = readCheckpoint(checkpoint_path);
+		REQUIRE(snapshot.generation == 1);
+		requireEqual(snapshot.grid, grid);
+
+		// A delta as large as the board is written as a full checkpoint.
+		for (std::size_t i = 0; i < grid.rows(); i++) {
+			for (std::size_t j = 0; j < grid.columns(); j += 64) {
+				grid.at({ i, j }).data = true;
+			}
+		}
+		writer.save(grid, 2);
+		writer.flush();
+		REQUIRE(std::filesystem::file_size(checkpoint_path) == full_size);
+		REQUIRE(writer.statistics().full_checkpoints == 2);
+		requireEqual(readCheckpoint(checkpoint_path).grid, grid);
+	}
+	std::remove(checkpoint_path);
+}
+
+TEST_CASE("Torn checkpoint records are ignored", "[checkpoint]") {
+	{
+		Grid grid{ 64, 512 };
+		{
+			CheckpointWriter writer{ checkpoint_path };
+			writer.save(grid, 5);
+			grid.at({ 1, 1 }).data = true;
+			writer.save(grid, 6);
+		}
+		const auto size = std::filesystem::file_size(checkpoint_path);
+		std::filesystem::resize_file(checkpoint_path, size - 8);
+
+		const auto snapshot = readCheckpoint(checkpoint_path);
+		REQUIRE(snapshot.generation == 5);
+		REQUIRE(snapshot.grid.at({ 1, 1 }).data == false);
+	}
+	{
+		std::ofstream{ checkpoint_path } << "not a checkpoint";
+		REQUIRE_THROWS(readCheckpoint(checkpoint_path));
+	}
+	std::remove(checkpoint_path);
+	REQUIRE_THROWS(readCheckpoint(checkpoint_path));
+}
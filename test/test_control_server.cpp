@@ -0,0 +1,240 @@
+#if !defined(_WIN32)
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "catch.hpp"
+#include "../src/control_server.h"
+#include "../src/little_endian.h"
+
+namespace {
+
+// A blocking client speaking the line protocol, as a script would.
+class TestClient {
+public:
+	explicit TestClient(const std::string& path) {
+		fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+		sockaddr_un address{};
+		address.sun_family = AF_UNIX;
+		std::strcpy(address.sun_path, path.c_str());
+		if (connect(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+			close(fd_);
+			throw std::runtime_error("could not connect to " + path);
+		}
+	}
+
+	~TestClient() { close(fd_); }
+
+	void send(const std::string& text) {
+		std::size_t sent = 0;
+		while (sent < text.size()) {
+			const auto count = ::send(fd_, text.data() + sent, text.size() - sent, 0);
+			REQUIRE(count > 0);
+			sent += static_cast<std::size_t>(count);
+		}
+	}
+
+	std::string readLine() {
+		std::string line;
+		char c;
+		while (::recv(fd_, &c, 1, 0) == 1 && c != '\n') {
+			line += c;
+		}
+		return line;
+	}
+
+	std::string readBytes(std::size_t size) {
+		std::string bytes(size, '\0');
+		std::size_t received = 0;
+		while (received < size) {
+			const auto count = ::recv(fd_, bytes.data() + received, size - received, 0);
+			REQUIRE(count > 0);
+			received += static_cast<std::size_t>(count);
+		}
+		return bytes;
+	}
+
+	std::string request(const std::string& line) {
+		send(line + "\n");
+		return readLine();
+	}
+
+	void shutdownSending() { ::shutdown(fd_, SHUT_WR); }
+
+private:
+	int fd_;
+};
+
+bool getBit(const std::string& region, std::size_t words_per_row, std::size_t row, std::size_t col) {
+	const auto offset = (row * words_per_row + col / 64) * sizeof(std::uint64_t);
+	const auto word = readLittleEndian(reinterpret_cast<const std::byte*>(region.data() + offset));
+	return (word >> (col % 64)) & 1;
+}
+
+}
+
+TEST_CASE("Control clients step and query the simulation", "[control]") {
+	{
+		Simulation simulation{ 16, 80 };
+		ControlServer server{ simulation, "test_control.sock" };
+		TestClient client{ server.path() };
+
+		// A blinker, horizontal on even generations.
+		REQUIRE(client.request("set 1 5 70 5 71 5 72") == "ok 0");
+		REQUIRE(client.request("stats") == "ok 0 population 3 births 0 deaths 0 bounds 5 70 6 73");
+		REQUIRE(client.request("step 3") == "ok 3");
+		REQUIRE(client.request("stats") == "ok 3 population 3 births 2 deaths 2 bounds 4 71 7 72");
+
+		// Whole rows come straight from the snapshot, the others are packed.
+		REQUIRE(client.request("region 4 0 3 80") == "ok 3 3 80 48");
+		const auto rows = client.readBytes(48);
+		for (std::size_t i = 0; i < 3; i++) {
+			for (std::size_t j = 0; j < 80; j++) {
+				REQUIRE(getBit(rows, 2, i, j) == (j == 71));
+			}
+		}
+		REQUIRE(client.request("region 3 70 5 3") == "ok 3 5 3 40");
+		const auto region = client.readBytes(40);
+		for (std::size_t i = 0; i < 5; i++) {
+			for (std::size_t j = 0; j < 3; j++) {
+				REQUIRE(getBit(region, 1, i, j) == (j == 1 && i >= 1 && i <= 3));
+			}
+		}
+
+		REQUIRE(client.request("fill 0 0 16 80 0") == "ok 3");
+		REQUIRE(client.request("stats").starts_with("ok 3 population 0"));
+		REQUIRE(client.request("region 0 0 0 0") == "ok 3 0 0 0");
+	}
+}
+
+TEST_CASE("Control clients load patterns and run the simulation", "[control]") {
+	{
+		const auto path = "test_control_blinker.cells";
+		{
+			std::ofstream out{ path };
+			out << "!Blinker\nOOO\n";
+		}
+		Simulation simulation{ 9, 9 };
+		ControlServer server{ simulation, "test_control.sock" };
+		TestClient client{ server.path() };
+
+		REQUIRE(client.request(std::string{ "load " } + path) == "ok 0");
+		std::remove(path);
+		REQUIRE(client.request("stats") == "ok 0 population 3 births 0 deaths 0 bounds 4 3 5 6");
+		const auto running = client.request("run");
+		REQUIRE(running.starts_with("ok "));
+		REQUIRE(client.request("pause").starts_with("ok "));
+		const auto paused = client.request("stats");
+		REQUIRE(client.request("stats") == paused);
+		REQUIRE(paused.ends_with("population 3 births 2 deaths 2 bounds 3 4 6 5")
+			!= paused.ends_with("population 3 births 2 deaths 2 bounds 4 3 5 6"));
+	}
+}
+
+TEST_CASE("Control clients get errors for bad requests", "[control]") {
+	{
+		Simulation simulation{ 8, 8 };
+		ControlServer server{ simulation, "test_control.sock" };
+		TestClient client{ server.path() };
+
+		REQUIRE(client.request("jump 3") == "error unknown request jump");
+		REQUIRE(client.request("step") == "error expected a number of generations");
+		REQUIRE(client.request("step 1 2") == "error too many arguments for step");
+		REQUIRE(client.request("set 2 1 1") == "error expected 0 or 1");
+		REQUIRE(client.request("set 1 1 8") == "error cell 1 8 is out of the view");
+		REQUIRE(client.request("region 4 4 5 1") == "error the region is out of the view");
+		const auto out_of_view = "error the rectangle is out of the view";
+		REQUIRE(client.request("fill 0 0 1000000000 1000000000 1") == out_of_view);
+		REQUIRE(client.request("fill 7 0 2 8 1") == out_of_view);
+		REQUIRE(client.request("load does_not_exist.rle").starts_with("error "));
+		// The connection stays usable, and nothing was applied.
+		REQUIRE(client.request("stats") == "ok 0 population 0 births 0 deaths 0 bounds 0 0 0 0");
+	}
+}
+
+TEST_CASE("Control clients are served side by side", "[control]") {
+	{
+		Simulation simulation{ 8, 8 };
+		ControlServer server{ simulation, "test_control.sock" };
+		TestClient first{ server.path() };
+		TestClient second{ server.path() };
+
+		// Requests sent in one go are answered in order, and those of a client
+		// that hung up are still answered.
+		first.send("set 1 0 0 0 1\nstats\n");
+		second.send("set 1 7 7\nstats\nshutdown\n");
+		second.shutdownSending();
+		REQUIRE(first.readLine() == "ok 0");
+		REQUIRE(first.readLine().starts_with("ok 0 population "));
+		REQUIRE(second.readLine() == "ok 0");
+		REQUIRE(second.readLine().starts_with("ok 0 population "));
+		REQUIRE(second.readLine() == "ok 0");
+		server.waitForShutdown();
+		REQUIRE(first.request("stats").starts_with("ok 0 population 3 "));
+	}
+}
+
+TEST_CASE("Control clients pause a step that takes too long", "[control]") {
+	{
+		Simulation simulation{ 8, 8 };
+		ControlServer server{ simulation, "test_control.sock" };
+		TestClient stepping{ server.path() };
+		TestClient pausing{ server.path() };
+
+		REQUIRE(stepping.request("set 1 3 3 3 4 4 3 4 4") == "ok 0");
+		stepping.send("step 1000000000000\n");
+		// Pausing before the step got to the simulation would not stop it.
+		while (simulation.frame().generation == 0) {
+			simulation.updateFrame();
+			std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+		}
+		// Other clients are answered between the generations of the step.
+		const auto between = pausing.request("stats");
+		REQUIRE(between.starts_with("ok "));
+		REQUIRE(between.ends_with(" population 4 births 0 deaths 0 bounds 3 3 5 5"));
+		const auto paused = pausing.request("pause");
+		REQUIRE(paused.starts_with("ok "));
+		REQUIRE(paused != "ok 1000000000000");
+		REQUIRE(stepping.readLine() == paused);
+		REQUIRE(stepping.request("stats").starts_with(paused + " population 4 "));
+	}
+}
+
+TEST_CASE("Control clients get the cells of their own requests", "[control]") {
+	{
+		Simulation simulation{ 8, 64 };
+		ControlServer server{ simulation, "test_control.sock" };
+		TestClient client{ server.path() };
+		REQUIRE(client.request("fill 0 0 8 64 1") == "ok 0");
+
+		// Stats requests of other clients are acknowledged in between, without
+		// any cells.
+		std::vector<std::unique_ptr<TestClient>> others;
+		for (int i = 0; i < 4; i++) {
+			others.push_back(std::make_unique<TestClient>(server.path()));
+		}
+		for (int i = 0; i < 100; i++) {
+			client.send("region 0 0 8 64\n");
+			for (auto& other : others) {
+				other->send("stats\n");
+			}
+			REQUIRE(client.readLine() == "ok 0 8 64 64");
+			REQUIRE(client.readBytes(64) == std::string(64, '\xff'));
+			for (auto& other : others) {
+				REQUIRE(other->readLine().starts_with("ok 0 population 512 "));
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,61 @@
+#include "catch.hpp"
+#include "../src/cycle_detector.h"
+
+TEST_CASE("Cycle detector finds the first repeated hash", "[cycle_detector]") {
+	{
+		CycleDetector detector;
+		REQUIRE_FALSE(detector.update(0, 10));
+		REQUIRE_FALSE(detector.update(1, 11));
+		REQUIRE_FALSE(detector.update(2, 12));
+		REQUIRE_FALSE(detector.update(3, 13));
+		REQUIRE(detector.update(4, 11) == Cycle{ .start = 1, .period = 3 });
+	}
+	{
+		CycleDetector detector;
+		REQUIRE_FALSE(detector.update(5, 7));
+		REQUIRE(detector.update(6, 7) == Cycle{ .start = 5, .period = 1 });
+	}
+}
+
+TEST_CASE("Cycle detector restarts on a gap or a reset", "[cycle_detector]") {
+	{
+		CycleDetector detector;
+		REQUIRE_FALSE(detector.update(0, 1));
+		REQUIRE_FALSE(detector.update(1, 2));
+		REQUIRE_FALSE(detector.update(5, 1));
+		REQUIRE(detector.update(6, 1) == Cycle{ .start = 5, .period = 1 });
+	}
+	{
+		CycleDetector detector;
+		REQUIRE_FALSE(detector.update(0, 1));
+		detector.reset();
+		REQUIRE_FALSE(detector.update(1, 1));
+	}
+}
+
+TEST_CASE("Cycle detector only remembers its history", "[cycle_detector]") {
+	{
+		CycleDetector detector{ 4 };
+		for (std::uint64_t gen = 0; gen < 4; gen++) {
+			REQUIRE_FALSE(detector.update(gen, 100 + gen));
+		}
+		// Period 4 still fits, the hash of generation 0 is dropped now.
+		REQUIRE(detector.update(4, 100) == Cycle{ .start = 0, .period = 4 });
+
+		CycleDetector other{ 4 };
+		for (std::uint64_t gen = 0; gen < 5; gen++) {
+			REQUIRE_FALSE(other.update(gen, 100 + gen));
+		}
+		REQUIRE_FALSE(other.update(5, 100));
+		REQUIRE(other.update(6, 103) == Cycle{ .start = 3, .period = 3 });
+	}
+	{
+		// A hash seen twice stays known while its later generation is kept.
+		CycleDetector detector{ 3 };
+		REQUIRE_FALSE(detector.update(0, 1));
+		REQUIRE(detector.update(1, 1) == Cycle{ .start = 0, .period = 1 });
+		REQUIRE_FALSE(detector.update(2, 2));
+		REQUIRE_FALSE(detector.update(3, 3));
+		REQUIRE(detector.update(4, 1) == Cycle{ .start = 1, .period = 3 });
+	}
+}
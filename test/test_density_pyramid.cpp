@@ -0,0 +1,105 @@
+#include <random>
+#include "catch.hpp"
+#include "test_helpers.h"
+#include "../src/density_pyramid.h"
+
+namespace {
+
+// Density of a block computed from scratch the way the pyramid does it.
+unsigned getDensity(const Grid& grid, unsigned level, std::size_t row, std::size_t col) {
+	if (level == 0) {
+		if (row >= grid.rows() || col >= grid.columns()) {
+			return 0;
+		}
+		return grid.at({ row, col }).data ? 255 : 0;
+	}
+	const auto sum = getDensity(grid, level - 1, 2 * row, 2 * col)
+		+ getDensity(grid, level - 1, 2 * row, 2 * col + 1)
+		+ getDensity(grid, level - 1, 2 * row + 1, 2 * col)
+		+ getDensity(grid, level - 1, 2 * row + 1, 2 * col + 1);
+	return (sum + 2) / 4;
+}
+
+void requireMatches(const DensityPyramid& pyramid, const Grid& grid) {
+	for (unsigned level = 1; level <= pyramid.levelCount(); level++) {
+		const auto size = pyramid.levelSize(level);
+		for (std::size_t i = 0; i < size.row; i++) {
+			for (std::size_t j = 0; j < size.col; j++) {
+				REQUIRE(pyramid.row(level, i)[j] == getDensity(grid, level, i, j));
+			}
+		}
+	}
+}
+
+}
+
+TEST_CASE("Density pyramid halves the size up to a single block", "[density_pyramid]") {
+	{
+		DensityPyramid pyramid{ 100, 37 };
+		REQUIRE(pyramid.levelCount() == 7);
+		REQUIRE(pyramid.levelSize(1).row == 50);
+		REQUIRE(pyramid.levelSize(1).col == 19);
+		REQUIRE(pyramid.levelSize(3).row == 13);
+		REQUIRE(pyramid.levelSize(3).col == 5);
+		REQUIRE(pyramid.levelSize(7).row == 1);
+		REQUIRE(pyramid.levelSize(7).col == 1);
+	}
+	{
+		DensityPyramid pyramid{ 1, 1 };
+		REQUIRE(pyramid.levelCount() == 0);
+	}
+}
+
+TEST_CASE("Density pyramid scales live cell shares to bytes", "[density_pyramid]") {
+	{
+		Grid cells{ 4, 4 };
+		Grid source{ 4, 4 };
+		source.at({ 0, 0 }).data = 1;
+		source.at({ 0, 1 }).data = 1;
+		source.at({ 1, 0 }).data = 1;
+		source.at({ 1, 1 }).data = 1;
+		source.at({ 2, 2 }).data = 1;
+
+		DensityPyramid pyramid{ 4, 4 };
+		pyramid.update(cells, source);
+		REQUIRE(pyramid.row(1, 0)[0] == 255);
+		REQUIRE(pyramid.row(1, 0)[1] == 0);
+		REQUIRE(pyramid.row(1, 1)[1] == 64);
+		REQUIRE(pyramid.row(2, 0)[0] == 80);
+		REQUIRE(cells.at({ 2, 2 }).data == 1);
+	}
+}
+
+TEST_CASE("Density pyramid updates match a fresh computation", "[density_pyramid]") {
+	{
+		for (const auto& [rows, columns] : { std::pair{ 64, 64 }, std::pair{ 45, 71 }, std::pair{ 1, 33 } }) {
+			std::size_t r = rows;
+			std::size_t c = columns;
+			Grid cells{ r, c };
+			DensityPyramid pyramid{ r, c };
+
+			auto source = makeRandomGrid(r, c, 0.3, 5);
+			pyramid.update(cells, source);
+			requireMatches(pyramid, source);
+
+			std::mt19937 gen{ 9 };
+			std::uniform_int_distribution<std::size_t> row{ 0, r - 1 };
+			std::uniform_int_distribution<std::size_t> col{ 0, c - 1 };
+			for (int round = 0; round < 20; round++) {
+				for (int k = 0; k < 10; k++) {
+					auto& cell = source.at({ row(gen), col(gen) });
+					cell.data = !cell.data;
+				}
+				pyramid.update(cells, source);
+				requireMatches(pyramid, source);
+			}
+
+			// A stale copy from an older update is caught up in one go.
+			Grid stale{ r, c };
+			DensityPyramid other{ r, c };
+			other.update(stale, makeRandomGrid(r, c, 0.5, 11));
+			other.update(stale, source);
+			requireMatches(other, source);
+		}
+	}
+}
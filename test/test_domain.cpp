@@ -0,0 +1,215 @@
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "catch.hpp"
+#include "test_helpers.h"
+#include "../src/domain.h"
+#include "../src/grid_engine.h"
+#include "../src/pattern.h"
+
+namespace {
+
+std::uint64_t countPopulation(const Grid& grid) {
+	std::uint64_t population = 0;
+	for (std::size_t i = 0; i < grid.rows(); i++) {
+		for (std::size_t j = 0; j < grid.columns(); j++) {
+			population += grid.at({ i, j }).data;
+		}
+	}
+	return population;
+}
+
+Grid stepGrid(const Grid& board, std::uint64_t generations, const Rule& rule = life_rule) {
+	GridEngine engine{ board.rows(), board.columns(), 1, rule };
+	engine.load(board);
+	engine.step(generations);
+	Grid result{ board.rows(), board.columns() };
+	engine.save(result);
+	return result;
+}
+
+// Steps `board` in domain processes. Each process compares its domain with
+// `expected` and fails on a mismatch, which fails the run.
+DomainReport runChecked(const Grid& board,
+	Index domains,
+	std::uint64_t generations,
+	const Grid& expected,
+	const Rule& rule = life_rule) {
+	return runDomains(
+		board.getSize(), domains, generations, rule,
+		[&board](DomainEngine& engine) { engine.load(board); },
+		[&expected](const DomainEngine& engine) {
+			const auto origin = engine.origin();
+			const auto extent = engine.extent();
+			for (std::size_t i = 0; i < extent.row; i++) {
+				for (std::size_t j = 0; j < extent.col; j++) {
+					const Index cell{ origin.row + i, origin.col + j };
+					if (engine.get(cell) != static_cast<bool>(expected.at(cell).data)) {
+						throw std::runtime_error("domain differs");
+					}
+				}
+			}
+		});
+}
+
+}
+
+TEST_CASE("Domain layouts cover the board", "[domain]") {
+	{
+		const DomainLayout layout{ { 10, 7 }, { 3, 2 } };
+		REQUIRE(layout.count() == 6);
+		std::vector<int> covered(10 * 7, 0);
+		for (std::size_t domain = 0; domain < layout.count(); domain++) {
+			const auto origin = layout.origin(domain);
+			const auto extent = layout.extent(domain);
+			REQUIRE(extent.row <= layout.maxExtent().row);
+			REQUIRE(extent.col <= layout.maxExtent().col);
+			for (std::size_t i = 0; i < extent.row; i++) {
+				for (std::size_t j = 0; j < extent.col; j++) {
+					covered[(origin.row + i) * 7 + origin.col + j]++;
+				}
+			}
+		}
+		for (const auto count : covered) {
+			REQUIRE(count == 1);
+		}
+
+		REQUIRE(layout.neighbour(0, -1, -1) == 5);
+		REQUIRE(layout.neighbour(5, 1, 1) == 0);
+		REQUIRE(layout.neighbour(2, 0, 1) == 3);
+		REQUIRE(DomainLayout({ 4, 4 }, { 1, 1 }).neighbour(0, 1, -1) == 0);
+
+		REQUIRE_THROWS(DomainLayout({ 4, 4 }, { 5, 1 }));
+		REQUIRE_THROWS(DomainLayout({ 4, 4 }, { 1, 0 }));
+	}
+}
+
+TEST_CASE("Domains stepped on threads match the grid engine", "[domain]") {
+	{
+		Grid board{ 23, 31 };
+		fillRandom(board, 0.35, 4);
+		const auto expected = stepGrid(board, 40);
+
+		const DomainLayout layout{ board.getSize(), { 2, 3 } };
+		HaloExchange exchange{ layout };
+		std::vector<std::unique_ptr<DomainEngine>> engines;
+		for (std::size_t domain = 0; domain < layout.count(); domain++) {
+			engines.push_back(std::make_unique<DomainEngine>(layout, domain, exchange));
+			engines.back()->load(board);
+		}
+		std::vector<std::thread> threads;
+		for (auto& engine : engines) {
+			threads.emplace_back([&engine] { engine->step(40); });
+		}
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		Grid result{ board.rows(), board.columns() };
+		std::uint64_t population = 0;
+		for (const auto& engine : engines) {
+			engine->save(result);
+			population += engine->population();
+			REQUIRE(engine->generation() == 40);
+		}
+		REQUIRE(isSame(result, expected));
+		REQUIRE(population == countPopulation(expected));
+	}
+}
+
+TEST_CASE("Domain processes match the single-process engine", "[domain]") {
+	// Even and uneven splits, single domain rows and columns, and domains of a
+	// single cell, whose neighbours on both sides are the same domain.
+	const std::size_t layouts[][4] = {
+		{ 16, 16, 1, 1 }, { 16, 16, 2, 2 }, { 21, 30, 3, 2 }, { 12, 40, 1, 4 },
+		{ 40, 12, 4, 1 }, { 3, 3, 3, 3 }
+	};
+	for (const auto& layout : layouts) {
+		INFO("board " << layout[0] << "x" << layout[1]
+			<< ", domains " << layout[2] << "x" << layout[3]);
+		Grid board{ layout[0], layout[1] };
+		fillRandom(board, 0.3, layout[1]);
+		const auto expected = stepGrid(board, 50);
+
+		const auto report = runChecked(board, { layout[2], layout[3] }, 50, expected);
+		REQUIRE(report.population == countPopulation(expected));
+	}
+}
+
+TEST_CASE("Gliders cross domain borders and wrap around the torus", "[domain]") {
+	{
+		Grid board{ 20, 20 };
+		const Index glider[] = { { 0, 1 }, { 1, 2 }, { 2, 0 }, { 2, 1 }, { 2, 2 } };
+		for (const auto cell : glider) {
+			board.at(cell).data = true;
+		}
+		// A glider comes back to where it started after 4 generations per cell
+		// of the torus it crosses.
+		const auto report = runChecked(board, { 2, 2 }, 80, board);
+		REQUIRE(report.population == 5);
+	}
+}
+
+TEST_CASE("Domain processes support other rules", "[domain]") {
+	for (const auto& rule : { highlife_rule, parseRule("B0/S8") }) {
+		INFO("rule: " << toString(rule));
+		Grid board{ 18, 25 };
+		fillRandom(board, 0.25, 9);
+		REQUIRE_NOTHROW(runChecked(board, { 3, 2 }, 20, stepGrid(board, 20, rule), rule));
+	}
+}
+
+TEST_CASE("Domain processes fail the run when a domain does", "[domain]") {
+	{
+		const Grid board{ 16, 16 };
+		REQUIRE_THROWS(runChecked(board, { 2, 2 }, 10, makeRandomGrid(16, 16, 1.0, 0)));
+		REQUIRE_THROWS(runDomains({ 16, 16 }, { 2, 2 }, 10, life_rule, [](DomainEngine& engine) {
+			if (engine.domain() == 3) {
+				throw std::runtime_error("cannot fill");
+			}
+		}));
+	}
+}
+
+TEST_CASE("Domains draw and dump their own cells", "[domain]") {
+	{
+		REQUIRE(domainDumpPath("board.rle", 3) == "board.3.rle");
+		REQUIRE(domainDumpPath("out/board", 0) == "out/board.0");
+
+		RunOptions options{};
+		options.board_width = 70;
+		options.board_height = 33;
+		options.density = 0.3;
+		options.seed = 12;
+		options.generations = 30;
+		options.rule = life_rule;
+		options.domains_across = 3;
+		options.domains_down = 2;
+		options.dump = "test_domain_dump.rle";
+		runDomains(options);
+
+		// Domain d is drawn with seed + d like a rectangle of the whole board.
+		const DomainLayout layout{ { 33, 70 }, { 2, 3 } };
+		Grid board{ 33, 70 };
+		for (std::size_t domain = 0; domain < layout.count(); domain++) {
+			fillRandom(board, layout.origin(domain), layout.extent(domain), 0.3, 12 + domain);
+		}
+		const auto expected = stepGrid(board, 30);
+		for (std::size_t domain = 0; domain < layout.count(); domain++) {
+			const auto path = domainDumpPath(options.dump, domain);
+			const auto cells = readPattern(path);
+			std::remove(path.c_str());
+			const auto origin = layout.origin(domain);
+			REQUIRE(cells.rows() == layout.extent(domain).row);
+			REQUIRE(cells.columns() == layout.extent(domain).col);
+			for (std::size_t i = 0; i < cells.rows(); i++) {
+				for (std::size_t j = 0; j < cells.columns(); j++) {
+					REQUIRE(cells.at({ i, j }).data
+						== expected.at({ origin.row + i, origin.col + j }).data);
+				}
+			}
+		}
+	}
+}
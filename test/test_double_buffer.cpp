@@ -0,0 +1,38 @@
+#include "catch.hpp"
+#include "../src/double_buffer.h"
+#include "../src/grid.h"
+
+TEST_CASE("DoubleBuffer flips generations without copying", "[double_buffer]") {
+	{
+		DoubleBuffer<Grid> generations{ 3, 4 };
+		REQUIRE(generations.current().rows() == 3);
+		REQUIRE(generations.next().columns() == 4);
+
+		const Cell* front = generations.current().row(0);
+		const Cell* back = generations.next().row(0);
+		REQUIRE(front != back);
+
+		generations.next().at({ 1, 2 }).data = true;
+		generations.flip();
+		REQUIRE(generations.current().row(0) == back);
+		REQUIRE(generations.next().row(0) == front);
+		REQUIRE(generations.current().at({ 1, 2 }).data == true);
+		REQUIRE(generations.next().at({ 1, 2 }).data == false);
+	}
+}
+
+TEST_CASE("DoubleBuffer steps a blinker", "[double_buffer]") {
+	{
+		DoubleBuffer<Grid> generations{ 5, 5 };
+		for (const std::size_t col : { 1, 2, 3 }) {
+			generations.current().at({ 2, col }).data = true;
+		}
+		for (int step = 0; step < 2; step++) {
+			generations.current().step(generations.next());
+			generations.flip();
+			REQUIRE(generations.current().at({ 1, 2 }).data == (step == 0));
+			REQUIRE(generations.current().at({ 2, 1 }).data == (step == 1));
+			REQUIRE(generations.current().at({ 2, 2 }).data == true);
+		}
+	}
+}
@@ -0,0 +1,146 @@
+#include <sstream>
+#include <string>
+#include <vector>
+#include "catch.hpp"
+#include "../src/engine.h"
+#include "../src/ensemble.h"
+
+namespace {
+
+std::vector<EnsembleJob> makeJobs() {
+	std::vector<EnsembleJob> jobs;
+	for (std::uint64_t seed = 0; seed < 6; seed++) {
+		jobs.push_back({ .size = { 24, 32 }, .density = 0.35, .seed = seed, .max_generations = 400 });
+	}
+	jobs.push_back({ .size = { 16, 16 }, .density = 0.0, .seed = 0, .max_generations = 400 });
+	return jobs;
+}
+
+}
+
+TEST_CASE("Ensemble jobs match stepping an engine", "[ensemble]") {
+	{
+		EnsembleArena arena;
+		const auto jobs = makeJobs();
+		for (std::size_t i = 0; i < jobs.size(); i++) {
+			const auto& job = jobs[i];
+			const auto result = runEnsembleJob(job, i, life_rule, arena);
+			REQUIRE(result.job == i);
+
+			Grid board{ job.size.row, job.size.col };
+			fillRandom(board, job.density, job.seed);
+			auto engine = makeEngine("grid", job.size, 1);
+			engine->load(board);
+			REQUIRE(engine->trackHash());
+			REQUIRE(result.initial_population == engine->population());
+
+			CycleDetector detector;
+			std::optional<Cycle> cycle = detector.update(0, engine->hash());
+			while (!cycle && engine->generation() < job.max_generations) {
+				engine->step(1);
+				cycle = detector.update(engine->generation(), engine->hash());
+			}
+			REQUIRE(result.cycle == cycle);
+			REQUIRE(result.generations == engine->generation());
+			REQUIRE(result.final_population == engine->population());
+		}
+	}
+}
+
+TEST_CASE("Ensemble stops at the first repeat", "[ensemble]") {
+	{
+		EnsembleArena arena;
+		const auto empty = runEnsembleJob({ .size = { 8, 8 }, .density = 0.0, .seed = 0, .max_generations = 100 }, 0, life_rule, arena);
+		REQUIRE(empty.cycle == Cycle{ 0, 1 });
+		REQUIRE(empty.generations == 1);
+		REQUIRE(empty.final_population == 0);
+
+		const auto limited = runEnsembleJob({ .size = { 64, 64 }, .density = 0.4, .seed = 3, .max_generations = 5 }, 0, life_rule, arena);
+		REQUIRE(!limited.cycle);
+		REQUIRE(limited.generations == 5);
+	}
+}
+
+TEST_CASE("Ensemble arena reuses boards of the same size", "[ensemble]") {
+	{
+		EnsembleArena arena;
+		const auto* first = arena.getBoards({ 10, 12 })[0].row(0);
+		REQUIRE(arena.getBoards({ 10, 12 })[0].row(0) == first);
+		const auto& resized = arena.getBoards({ 12, 10 });
+		REQUIRE(resized[0].rows() == 12);
+		REQUIRE(resized[1].columns() == 10);
+	}
+}
+
+TEST_CASE("Ensemble runs every job once on any thread count", "[ensemble]") {
+	{
+		const auto jobs = makeJobs();
+		EnsembleArena arena;
+		std::vector<EnsembleResult> expected;
+		for (std::size_t i = 0; i < jobs.size(); i++) {
+			expected.push_back(runEnsembleJob(jobs[i], i, life_rule, arena));
+		}
+
+		for (const std::size_t threads : { 1, 3 }) {
+			std::vector<int> visits(jobs.size());
+			runEnsemble(jobs, threads, life_rule, [&](const EnsembleResult& result) {
+				visits[result.job]++;
+				REQUIRE(result.cycle == expected[result.job].cycle);
+				REQUIRE(result.generations == expected[result.job].generations);
+				REQUIRE(result.final_population == expected[result.job].final_population);
+			});
+			REQUIRE(visits == std::vector<int>(jobs.size(), 1));
+		}
+	}
+}
+
+TEST_CASE("Ensemble jobs cover every density and seed", "[ensemble]") {
+	{
+		RunOptions options{};
+		options.board_width = 20;
+		options.board_height = 10;
+		options.seed = 5;
+		options.density = 0.5;
+		options.generations = 70;
+		options.ensemble = 3;
+		REQUIRE(makeEnsembleJobs(options).size() == 3);
+
+		options.ensemble_densities = { 0.1, 0.2 };
+		const auto jobs = makeEnsembleJobs(options);
+		REQUIRE(jobs.size() == 6);
+		REQUIRE(jobs[0].density == 0.1);
+		REQUIRE(jobs[0].seed == 5);
+		REQUIRE(jobs[5].density == 0.2);
+		REQUIRE(jobs[5].seed == 7);
+		REQUIRE(jobs[5].size.row == 10);
+		REQUIRE(jobs[5].size.col == 20);
+		REQUIRE(jobs[5].max_generations == 70);
+	}
+}
+
+TEST_CASE("Ensemble CSV rows leave the cycle of unsettled boards empty", "[ensemble]") {
+	{
+		const EnsembleJob job{ .size = { 4, 6 }, .density = 0.25, .seed = 9, .max_generations = 10 };
+		std::ostringstream out;
+		writeEnsembleCsvHeader(out);
+		writeEnsembleCsvRow(out, job,
+			{ .job = 2,
+				.initial_population = 5,
+				.final_population = 3,
+				.generations = 10,
+				.cycle = std::nullopt,
+				.seconds = 0.5 });
+		writeEnsembleCsvRow(out, job,
+			{ .job = 3,
+				.initial_population = 5,
+				.final_population = 4,
+				.generations = 8,
+				.cycle = Cycle{ 6, 2 },
+				.seconds = 0.25 });
+		REQUIRE(out.str()
+			== "job,rows,columns,density,seed,initial_population,final_population,"
+			   "generations,stabilized,cycle_start,period,milliseconds\n"
+			   "2,4,6,0.25,9,5,3,10,0,,,500\n"
+			   "3,4,6,0.25,9,5,4,8,1,6,2,250\n");
+	}
+}
@@ -0,0 +1,105 @@
+#include <sstream>
+#include <string>
+#include <vector>
+#include "catch.hpp"
+#include "test_helpers.h"
+#include "../src/frame_export.h"
+#include "../src/grid_engine.h"
+
+namespace {
+
+// Reads the boards out of a YUV4MPEG2 stream of `rows` x `columns` frames.
+std::vector<Grid> readY4m(const std::string& stream, std::size_t rows, std::size_t columns) {
+	const auto header_end = stream.find('\n');
+	REQUIRE(stream.substr(0, header_end)
+		== "YUV4MPEG2 W" + std::to_string(columns) + " H" + std::to_string(rows)
+			+ " F30:1 Ip A1:1 Cmono");
+	std::vector<Grid> boards;
+	for (auto offset = header_end + 1; offset < stream.size(); offset += 6 + rows * columns) {
+		REQUIRE(stream.compare(offset, 6, "FRAME\n") == 0);
+		auto& board = boards.emplace_back(rows, columns);
+		for (std::size_t i = 0; i < rows; i++) {
+			for (std::size_t j = 0; j < columns; j++) {
+				const auto luma = static_cast<unsigned char>(stream[offset + 6 + i * columns + j]);
+				REQUIRE((luma == 0 || luma == 255));
+				board.at({ i, j }).data = luma == 0;
+			}
+		}
+	}
+	return boards;
+}
+
+}
+
+TEST_CASE("Frame formats are picked by name or extension", "[frame_export]") {
+	{
+		REQUIRE(getFrameFormat("", "run.y4m") == FrameFormat::y4m);
+		REQUIRE(getFrameFormat("", "run.pbm") == FrameFormat::pbm);
+		REQUIRE(getFrameFormat("", "-") == FrameFormat::pbm);
+		REQUIRE(getFrameFormat("y4m", "-") == FrameFormat::y4m);
+		REQUIRE(getFrameFormat("pbm", "run.y4m") == FrameFormat::pbm);
+		REQUIRE_THROWS(getFrameFormat("png", "run.png"));
+	}
+}
+
+TEST_CASE("PBM frames pack eight cells to a byte, first cell highest", "[frame_export]") {
+	{
+		// Wide enough for a whole word of cells and a padded last byte.
+		Grid board{ 2, 19 };
+		for (const std::size_t col : { 0, 7, 9, 16, 18 }) {
+			board.at({ 0, col }).data = true;
+		}
+		board.at({ 1, 3 }).data = true;
+
+		std::vector<char> out;
+		encodePbm(board, out);
+		const std::string header = "P4\n19 2\n";
+		REQUIRE(std::string(out.begin(), out.begin() + header.size()) == header);
+		const std::vector<unsigned char> expected = { 0x81, 0x40, 0xa0, 0x10, 0x00, 0x00 };
+		REQUIRE(std::vector<unsigned char>(out.begin() + header.size(), out.end()) == expected);
+	}
+}
+
+TEST_CASE("Exported frames follow the engine", "[frame_export]") {
+	for (const std::size_t queue_frames : { 1, 4 }) {
+		INFO("queue frames: " << queue_frames);
+		Grid board{ 13, 21 };
+		fillRandom(board, 0.3, 5);
+		GridEngine engine{ 13, 21 };
+		engine.load(board);
+
+		std::ostringstream stream;
+		std::vector<Grid> expected;
+		{
+			FrameExporter exporter{ stream, board.getSize(), FrameFormat::y4m, queue_frames };
+			for (int frame = 0; frame < 10; frame++) {
+				exporter.exportFrame(engine);
+				auto& copy = expected.emplace_back(13, 21);
+				engine.save(copy);
+				engine.step(1);
+			}
+			exporter.flush();
+			REQUIRE(exporter.statistics().frames == 10);
+			REQUIRE(exporter.statistics().bytes_written == stream.str().size());
+		}
+
+		const auto frames = readY4m(stream.str(), 13, 21);
+		REQUIRE(frames.size() == expected.size());
+		for (std::size_t i = 0; i < frames.size(); i++) {
+			REQUIRE(isSame(frames[i], expected[i]));
+		}
+	}
+}
+
+TEST_CASE("Failing to write a frame is reported", "[frame_export]") {
+	{
+		REQUIRE_THROWS(FrameExporter{ "nonexistent_directory/frames.pbm", { 4, 4 }, FrameFormat::pbm });
+
+		std::ostringstream stream;
+		stream.setstate(std::ios::badbit);
+		GridEngine engine{ 4, 4 };
+		FrameExporter exporter{ stream, { 4, 4 }, FrameFormat::pbm };
+		exporter.exportFrame(engine);
+		REQUIRE_THROWS(exporter.flush());
+	}
+}
@@ -0,0 +1,117 @@
+#include <vector>
+#include "catch.hpp"
+#include "test_helpers.h"
+#include "../src/generation_history.h"
+#include "../src/grid_engine.h"
+
+namespace {
+
+// Steps a random board `generations` times, recording every step, and returns
+// all boards from generation 0 on.
+std::vector<Grid> recordRun(GenerationHistory& history,
+                            std::size_t rows,
+                            std::size_t columns,
+                            std::uint64_t generations) {
+	Grid board{ rows, columns };
+	fillRandom(board, 0.35, rows + columns);
+	GridEngine engine{ rows, columns };
+	engine.load(board);
+	std::vector<Grid> boards{ board };
+	for (std::uint64_t gen = 1; gen <= generations; gen++) {
+		engine.step(1);
+		history.record(engine.previous(), engine.current(), gen);
+		boards.push_back(engine.current());
+	}
+	return boards;
+}
+
+}
+
+TEST_CASE("Change lists toggle boards both ways", "[generation_history]") {
+	{
+		Grid before{ 37, 70 };
+		fillRandom(before, 0.4, 1);
+		Grid after{ 37, 70 };
+		fillRandom(after, 0.4, 2);
+
+		std::vector<std::uint8_t> changes;
+		encodeChanges(before, after, changes);
+		auto board = before;
+		applyChanges(changes, board);
+		REQUIRE(isSame(board, after));
+		applyChanges(changes, board);
+		REQUIRE(isSame(board, before));
+
+		changes.clear();
+		encodeChanges(before, before, changes);
+		REQUIRE(changes.empty());
+	}
+}
+
+TEST_CASE("History seeks to every recorded generation", "[generation_history]") {
+	{
+		GenerationHistory history{ 16 };
+		REQUIRE(history.empty());
+		const auto boards = recordRun(history, 40, 50, 100);
+		REQUIRE(history.oldest() == 0);
+		REQUIRE(history.newest() == 100);
+		REQUIRE(history.keyframeCount() == 7);
+
+		auto board = boards.back();
+		for (const std::uint64_t target : { 99, 50, 0, 1, 17, 100, 63, 64, 65, 3 }) {
+			INFO("generation " << target);
+			REQUIRE(history.seek(target, board) == target);
+			REQUIRE(history.cursor() == target);
+			REQUIRE(isSame(board, boards[target]));
+		}
+		REQUIRE(history.seek(1000, board) == 100);
+		REQUIRE(isSame(board, boards.back()));
+	}
+}
+
+TEST_CASE("Stepping after seeking back replaces the future", "[generation_history]") {
+	{
+		GenerationHistory history{ 8 };
+		const auto boards = recordRun(history, 20, 20, 30);
+		auto board = boards.back();
+		history.seek(10, board);
+
+		// A different future from generation 10.
+		Grid edited = board;
+		edited.at({ 0, 0 }).data = !edited.at({ 0, 0 }).data;
+		GridEngine engine{ 20, 20 };
+		engine.load(edited);
+		engine.step(1);
+		history.record(board, engine.current(), 11);
+		REQUIRE(history.newest() == 11);
+
+		Grid stepped = engine.current();
+		history.seek(5, stepped);
+		REQUIRE(isSame(stepped, boards[5]));
+		history.seek(11, stepped);
+		REQUIRE(isSame(stepped, engine.current()));
+
+		// A generation that does not follow the cursor starts over.
+		history.record(engine.current(), engine.current(), 40);
+		REQUIRE(history.oldest() == 39);
+		REQUIRE(history.newest() == 40);
+	}
+}
+
+TEST_CASE("History drops the oldest generations beyond its memory cap", "[generation_history]") {
+	{
+		GenerationHistory history{ 32, 16 * 1024 };
+		const auto boards = recordRun(history, 64, 64, 200);
+		REQUIRE(history.memoryUsage() <= 16 * 1024);
+		REQUIRE(history.oldest() > 0);
+		REQUIRE(history.newest() == 200);
+
+		auto board = boards.back();
+		REQUIRE(history.seek(0, board) == history.oldest());
+		REQUIRE(isSame(board, boards[history.oldest()]));
+
+		history.clear();
+		REQUIRE(history.empty());
+		REQUIRE(history.memoryUsage() == 0);
+	}
+}
@@ -1,5 +1,5 @@
 #include "catch.hpp"
-#include "../src/game.h"
+#include "../src/grid.h"
 
 TEST_CASE("Grid class sizes are correct", "[grid]") {
 	{
@@ -48,3 +48,67 @@ TEST_CASE("Grid class periodic indexing is correct", "[grid]") {
 		REQUIRE(big_neg_index.col == 4);
 	}
 }
+
+TEST_CASE("Rectangles are filled with wrap-around", "[grid]") {
+	{
+		Grid grid{ 6, 7 };
+		fillRect(grid, { 4, 5 }, { 3, 4 }, true);
+		for (std::size_t i = 0; i < 6; i++) {
+			for (std::size_t j = 0; j < 7; j++) {
+				const bool in_rows = i >= 4 || i < 1;
+				const bool in_columns = j >= 5 || j < 2;
+				REQUIRE(grid.at({ i, j }).data == (in_rows && in_columns));
+			}
+		}
+
+		// Larger than the grid, every cell once.
+		fillRect(grid, { 2, 3 }, { 100, 100 }, false);
+		fillRect(grid, { 0, 0 }, { 0, 7 }, true);
+		for (std::size_t i = 0; i < 6; i++) {
+			for (std::size_t j = 0; j < 7; j++) {
+				REQUIRE_FALSE(grid.at({ i, j }).data);
+			}
+		}
+	}
+}
+
+TEST_CASE("Random fills keep to their density and rectangle", "[grid]") {
+	{
+		Grid first{ 300, 301 };
+		Grid second{ 300, 301 };
+		fillRandom(first, 0.3, 11);
+		fillRandom(second, 0.3, 11);
+		std::size_t population = 0;
+		for (std::size_t i = 0; i < first.rows(); i++) {
+			for (std::size_t j = 0; j < first.columns(); j++) {
+				REQUIRE(first.at({ i, j }).data == second.at({ i, j }).data);
+				population += first.at({ i, j }).data;
+			}
+		}
+		const auto density = static_cast<double>(population) / (300 * 301);
+		REQUIRE(density > 0.29);
+		REQUIRE(density < 0.31);
+
+		fillRandom(second, 0.3, 12);
+		bool is_different = false;
+		for (std::size_t i = 0; i < first.rows() && !is_different; i++) {
+			for (std::size_t j = 0; j < first.columns(); j++) {
+				is_different |= first.at({ i, j }).data != second.at({ i, j }).data;
+			}
+		}
+		REQUIRE(is_different);
+
+		Grid grid{ 20, 30 };
+		fillRandom(grid, { 18, 25 }, { 4, 10 }, 1.0, 3);
+		fillRandom(grid, { 5, 5 }, { 4, 4 }, 0.0, 3);
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < 20; i++) {
+			for (std::size_t j = 0; j < 30; j++) {
+				const bool inside = (i >= 18 || i < 2) && (j >= 25 || j < 5);
+				REQUIRE(grid.at({ i, j }).data == inside);
+				count += inside;
+			}
+		}
+		REQUIRE(count == 40);
+	}
+}
@@ -0,0 +1,210 @@
+#include <string_view>
+#include <vector>
+#include "catch.hpp"
+#include "test_helpers.h"
+#include "../src/grid_engine.h"
+#include "../src/hashlife.h"
+
+namespace {
+
+// Patterns in plaintext form, 'O' is an alive cell.
+constexpr std::string_view r_pentomino[] = {
+	".OO",
+	"OO.",
+	".O.",
+};
+
+constexpr std::string_view glider[] = {
+	".O.",
+	"..O",
+	"OOO",
+};
+
+constexpr std::string_view gosper_glider_gun[] = {
+	"........................O...........",
+	"......................O.O...........",
+	"............OO......OO............OO",
+	"...........O...O....OO............OO",
+	"OO........O.....O...OO..............",
+	"OO........O...O.OO....O.O...........",
+	"..........O.....O.......O...........",
+	"...........O...O....................",
+	"............OO......................",
+};
+
+template <std::size_t N>
+void placePattern(Engine& engine, const std::string_view (&pattern)[N], Index offset) {
+	for (std::size_t i = 0; i < N; i++) {
+		for (std::size_t j = 0; j < pattern[i].size(); j++) {
+			if (pattern[i][j] == 'O') {
+				engine.set({ offset.row + i, offset.col + j }, true);
+			}
+		}
+	}
+}
+
+bool isSame(const GridEngine& grid_engine, const HashLifeEngine& hashlife) {
+	const auto& grid = grid_engine.current();
+	for (std::size_t i = 0; i < grid.rows(); i++) {
+		for (std::size_t j = 0; j < grid.columns(); j++) {
+			if (grid.at({ i, j }).data != hashlife.get({ i, j })) {
+				return false;
+			}
+		}
+	}
+	return grid_engine.population() == hashlife.population();
+}
+
+}
+
+TEST_CASE("HashLife engine sets and gets cells", "[hashlife]") {
+	{
+		HashLifeEngine engine;
+		REQUIRE(engine.population() == 0);
+		engine.setCell(0, 0, true);
+		engine.setCell(-5, 3, true);
+		engine.setCell(1000000, -1000000, true);
+		REQUIRE(engine.population() == 3);
+		REQUIRE(engine.getCell(0, 0) == true);
+		REQUIRE(engine.getCell(-5, 3) == true);
+		REQUIRE(engine.getCell(1000000, -1000000) == true);
+		REQUIRE(engine.getCell(1, 0) == false);
+		REQUIRE(engine.get({ 0, 0 }) == true);
+		engine.setCell(-5, 3, false);
+		REQUIRE(engine.population() == 2);
+		REQUIRE(engine.getCell(-5, 3) == false);
+	}
+}
+
+TEST_CASE("HashLife engine matches the grid engine step by step", "[hashlife]") {
+	{
+		GridEngine grid_engine{ 256, 256 };
+		HashLifeEngine hashlife;
+		placePattern(grid_engine, r_pentomino, { 128, 128 });
+		placePattern(hashlife, r_pentomino, { 128, 128 });
+		for (int gen = 0; gen < 200; gen++) {
+			grid_engine.step(1);
+			hashlife.step(1);
+			REQUIRE(isSame(grid_engine, hashlife));
+		}
+		REQUIRE(hashlife.generation() == 200);
+	}
+}
+
+TEST_CASE("HashLife engine matches the grid engine on standard patterns", "[hashlife]") {
+	SECTION("R-pentomino") {
+		GridEngine grid_engine{ 1024, 1024 };
+		HashLifeEngine hashlife;
+		placePattern(grid_engine, r_pentomino, { 512, 512 });
+		placePattern(hashlife, r_pentomino, { 512, 512 });
+		for (int checkpoint = 0; checkpoint < 15; checkpoint++) {
+			grid_engine.step(100);
+			hashlife.step(100);
+			REQUIRE(isSame(grid_engine, hashlife));
+		}
+		REQUIRE(hashlife.population() == 116);
+	}
+	SECTION("Gosper glider gun") {
+		GridEngine grid_engine{ 1024, 1024 };
+		HashLifeEngine hashlife;
+		placePattern(grid_engine, gosper_glider_gun, { 64, 64 });
+		placePattern(hashlife, gosper_glider_gun, { 64, 64 });
+		for (int checkpoint = 0; checkpoint < 10; checkpoint++) {
+			grid_engine.step(210);
+			hashlife.step(210);
+			REQUIRE(isSame(grid_engine, hashlife));
+		}
+	}
+}
+
+TEST_CASE("HashLife engine follows other rules like the grid engine", "[hashlife]") {
+	for (const auto& rule : { highlife_rule, parseRule("B36/S245"), parseRule("B3/S012345678") }) {
+		INFO("rule: " << toString(rule));
+		GridEngine grid_engine{ 256, 256, 1, rule };
+		HashLifeEngine hashlife{ HashLifeEngine::default_node_limit, rule };
+		placePattern(grid_engine, r_pentomino, { 128, 128 });
+		placePattern(hashlife, r_pentomino, { 128, 128 });
+		for (int checkpoint = 0; checkpoint < 10; checkpoint++) {
+			grid_engine.step(8);
+			hashlife.step(8);
+			REQUIRE(isSame(grid_engine, hashlife));
+		}
+	}
+	{
+		REQUIRE_THROWS(HashLifeEngine{ HashLifeEngine::default_node_limit, parseRule("B0/S8") });
+	}
+}
+
+TEST_CASE("HashLife engine jumps by powers of two", "[hashlife]") {
+	{
+		HashLifeEngine engine;
+		placePattern(engine, glider, { 0, 0 });
+		engine.stepPowerOfTwo(40);
+		REQUIRE(engine.generation() == (std::uint64_t{ 1 } << 40));
+		REQUIRE(engine.population() == 5);
+		// A glider moves one cell diagonally every four generations.
+		const auto shift = HashLifeEngine::Coord{ 1 } << 38;
+		REQUIRE(engine.getCell(shift + 1, shift) == true);
+		REQUIRE(engine.getCell(shift + 2, shift + 1) == true);
+		REQUIRE(engine.getCell(shift, shift + 2) == true);
+		REQUIRE(engine.getCell(shift + 1, shift + 2) == true);
+		REQUIRE(engine.getCell(shift + 2, shift + 2) == true);
+	}
+	{
+		HashLifeEngine engine;
+		placePattern(engine, gosper_glider_gun, { 0, 0 });
+		engine.step(std::uint64_t{ 1 } << 30);
+		// The gun emits one glider every 30 generations.
+		REQUIRE(engine.population() >= 5 * ((std::uint64_t{ 1 } << 30) / 30));
+	}
+}
+
+TEST_CASE("HashLife engine stays correct under a small node limit", "[hashlife]") {
+	{
+		GridEngine grid_engine{ 512, 512 };
+		HashLifeEngine hashlife{ 2000 };
+		placePattern(grid_engine, gosper_glider_gun, { 32, 32 });
+		placePattern(hashlife, gosper_glider_gun, { 32, 32 });
+		for (int checkpoint = 0; checkpoint < 20; checkpoint++) {
+			grid_engine.step(37);
+			hashlife.step(37);
+			REQUIRE(isSame(grid_engine, hashlife));
+		}
+		hashlife.collectGarbage();
+		REQUIRE(hashlife.nodeCount() <= hashlife.nodeLimit());
+	}
+}
+
+TEST_CASE("HashLife engine collects garbage during a jump", "[hashlife]") {
+	{
+		// A soup builds many more nodes in one jump than the limit.
+		const auto soup = makeRandomGrid(128, 128, 0.4, 7);
+		HashLifeEngine unlimited;
+		HashLifeEngine limited{ 20000 };
+		unlimited.load(soup);
+		limited.load(soup);
+		unlimited.stepPowerOfTwo(10);
+		limited.stepPowerOfTwo(10);
+		REQUIRE(limited.population() == unlimited.population());
+		REQUIRE(limited.nodeCount() < unlimited.nodeCount() / 4);
+		REQUIRE(limited.memoryUsage() < unlimited.memoryUsage() / 4);
+	}
+	{
+		// Once the board is cleared, every block of nodes but the one of the
+		// empty nodes goes back.
+		HashLifeEngine engine;
+		engine.load(makeRandomGrid(128, 128, 0.4, 7));
+		engine.step(64);
+		const auto used = engine.memoryUsage();
+		for (HashLifeEngine::Coord y = -200; y < 328; y++) {
+			for (HashLifeEngine::Coord x = -200; x < 328; x++) {
+				if (engine.getCell(x, y)) {
+					engine.setCell(x, y, false);
+				}
+			}
+		}
+		REQUIRE(engine.population() == 0);
+		engine.collectGarbage();
+		REQUIRE(engine.memoryUsage() < used / 4);
+	}
+}
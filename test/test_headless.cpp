@@ -0,0 +1,242 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "catch.hpp"
+#include "../src/headless.h"
+
+namespace {
+
+RunOptions makeHeadlessOptions() {
+	RunOptions options{};
+	options.headless = true;
+	options.board_width = 40;
+	options.board_height = 30;
+	options.seed = 7;
+	options.density = 0.3;
+	options.generations = 50;
+	options.engine = "grid";
+	options.threads = 2;
+	return options;
+}
+
+}
+
+TEST_CASE("Engines are created by name", "[headless]") {
+	{
+		REQUIRE(makeEngine("grid", { 4, 4 }, 1)->name() == "grid");
+		REQUIRE(makeEngine("tiled", { 4, 4 }, 1)->name() == "tiled");
+		REQUIRE(makeEngine("active", { 4, 4 }, 1)->name() == "active");
+		REQUIRE(makeEngine("hashlife", { 4, 4 }, 1)->name() == "hashlife");
+		REQUIRE_THROWS(makeEngine("nonexistent", { 4, 4 }, 1));
+	}
+}
+
+TEST_CASE("Random headless boards are reproducible", "[headless]") {
+	{
+		const auto options = makeHeadlessOptions();
+		const auto first = makeInitialBoard(options);
+		const auto second = makeInitialBoard(options);
+		REQUIRE(first.rows() == 30);
+		REQUIRE(first.columns() == 40);
+		std::size_t population = 0;
+		for (std::size_t i = 0; i < first.rows(); i++) {
+			for (std::size_t j = 0; j < first.columns(); j++) {
+				REQUIRE(first.at({ i, j }).data == second.at({ i, j }).data);
+				population += first.at({ i, j }).data;
+			}
+		}
+		REQUIRE(population > 0);
+		REQUIRE(population < 40 * 30);
+	}
+}
+
+TEST_CASE("Pattern files are placed in the middle of headless boards", "[headless]") {
+	{
+		const auto path = "test_headless_blinker.cells";
+		{
+			std::ofstream out{ path };
+			out << "!Blinker\nOOO\n";
+		}
+		auto options = makeHeadlessOptions();
+		options.pattern = path;
+		options.board_width = 5;
+		options.board_height = 5;
+		const auto board = makeInitialBoard(options);
+		std::remove(path);
+
+		REQUIRE(board.at({ 2, 1 }).data == true);
+		REQUIRE(board.at({ 2, 2 }).data == true);
+		REQUIRE(board.at({ 2, 3 }).data == true);
+		REQUIRE(board.at({ 1, 2 }).data == false);
+	}
+}
+
+TEST_CASE("Headless runs report the final population", "[headless]") {
+	{
+		const auto options = makeHeadlessOptions();
+		const auto board = makeInitialBoard(options);
+		for (const auto name : { "grid", "active", "hashlife" }) {
+			auto engine = makeEngine(name, board.getSize(), options.threads);
+			engine->load(board);
+			const auto report = runHeadless(*engine, 1, board.rows() * board.columns());
+			REQUIRE(report.generations == 1);
+			REQUIRE(report.cells == 40 * 30);
+			REQUIRE(report.population == engine->population());
+			REQUIRE(engine->generation() == 1);
+		}
+	}
+}
+
+TEST_CASE("Headless runs of no measurable time report no rates", "[headless]") {
+	{
+		const HeadlessReport report{ .generations = 0, .seconds = 0, .cells = 100, .population = 3, .cycle = std::nullopt };
+		REQUIRE(report.generationsPerSecond() == 0);
+		REQUIRE(report.cellUpdatesPerSecond() == 0);
+		REQUIRE(report.percentOfRunTime(0) == 0);
+
+		const HeadlessReport timed{ .generations = 10, .seconds = 2, .cells = 100, .population = 3, .cycle = std::nullopt };
+		REQUIRE(timed.generationsPerSecond() == 5);
+		REQUIRE(timed.cellUpdatesPerSecond() == 500);
+		REQUIRE(timed.percentOfRunTime(0.5) == 25);
+	}
+}
+
+TEST_CASE("Headless runs stop once the board repeats", "[headless]") {
+	{
+		// A blinker next to a block: period 2 from the start.
+		Grid board{ 12, 12 };
+		for (const std::size_t col : { 2, 3, 4 }) {
+			board.at({ 3, col }).data = true;
+		}
+		for (const Index cell : { Index{ 8, 8 }, Index{ 8, 9 }, Index{ 9, 8 }, Index{ 9, 9 } }) {
+			board.at(cell).data = true;
+		}
+
+		for (const auto name : { "grid", "active", "sparse" }) {
+			for (const std::uint64_t generations : { 1'000'001, 1'000'000 }) {
+				auto engine = makeEngine(name, board.getSize(), 1);
+				engine->load(board);
+				const auto report = runHeadless(*engine, generations, board.rows() * board.columns(),
+					std::nullopt, true);
+				REQUIRE(report.cycle == Cycle{ .start = 0, .period = 2 });
+				REQUIRE(report.generations == generations);
+				REQUIRE(report.population == 7);
+				// Only the first period and the odd remainder were stepped.
+				REQUIRE(engine->generation() <= 3);
+				REQUIRE(engine->get({ 2, 3 }) == (generations % 2 == 1));
+				REQUIRE(engine->get({ 3, 2 }) == (generations % 2 == 0));
+			}
+		}
+	}
+	{
+		const auto options = makeHeadlessOptions();
+		const auto board = makeInitialBoard(options);
+		auto engine = makeEngine("hashlife", board.getSize(), 1);
+		engine->load(board);
+		const auto report = runHeadless(*engine, 10, board.rows() * board.columns(), std::nullopt, true);
+		REQUIRE_FALSE(report.cycle);
+		REQUIRE(engine->generation() == 10);
+	}
+}
+
+TEST_CASE("Headless runs resume from their checkpoints", "[headless]") {
+	{
+		const auto path = "test_headless.ckpt";
+		const auto options = makeHeadlessOptions();
+		const auto board = makeInitialBoard(options);
+
+		auto straight = makeEngine("grid", board.getSize(), 1);
+		straight->load(board);
+		straight->step(50);
+
+		{
+			CheckpointWriter writer{ path };
+			auto engine = makeEngine("active", board.getSize(), 1);
+			engine->load(board);
+			runHeadless(*engine, 35, board.rows() * board.columns(),
+				HeadlessCheckpoints{ writer, 10, board.getSize(), 0 });
+		}
+
+		auto [resumed_board, generation] = readCheckpoint(path);
+		std::remove(path);
+		REQUIRE(generation == 30);
+		auto resumed = makeEngine("grid", resumed_board.getSize(), 1);
+		resumed->load(resumed_board);
+		resumed->step(20);
+
+		for (std::size_t i = 0; i < board.rows(); i++) {
+			for (std::size_t j = 0; j < board.columns(); j++) {
+				REQUIRE(resumed->get({ i, j }) == straight->get({ i, j }));
+			}
+		}
+	}
+}
+
+TEST_CASE("Headless runs export every Nth generation", "[headless]") {
+	{
+		const auto options = makeHeadlessOptions();
+		const auto board = makeInitialBoard(options);
+		auto engine = makeEngine("grid", board.getSize(), 1);
+		engine->load(board);
+
+		std::ostringstream stream;
+		{
+			FrameExporter exporter{ stream, board.getSize(), FrameFormat::pbm };
+			runHeadless(*engine, 10, board.rows() * board.columns(), std::nullopt, false,
+				HeadlessExport{ exporter, 3 });
+			exporter.flush();
+			REQUIRE(exporter.statistics().frames == 4);
+		}
+
+		// Generations 0, 3, 6 and 9, each a header and 30 rows of 5 bytes.
+		const std::string header = "P4\n40 30\n";
+		const auto frame_size = header.size() + 30 * 5;
+		const auto frames = stream.str();
+		REQUIRE(frames.size() == 4 * frame_size);
+		auto stepped = makeEngine("grid", board.getSize(), 1);
+		stepped->load(board);
+		stepped->step(9);
+		const auto last = frames.substr(3 * frame_size + header.size());
+		for (std::size_t i = 0; i < board.rows(); i++) {
+			for (std::size_t j = 0; j < board.columns(); j++) {
+				const bool alive = (static_cast<unsigned char>(last[i * 5 + j / 8]) >> (7 - j % 8)) & 1;
+				REQUIRE(alive == stepped->get({ i, j }));
+			}
+		}
+	}
+}
+
+TEST_CASE("Headless runs write the counts of every generation", "[headless]") {
+	{
+		const auto options = makeHeadlessOptions();
+		const auto board = makeInitialBoard(options);
+		auto engine = makeEngine("tiled", board.getSize(), 2);
+		engine->load(board);
+		REQUIRE(engine->trackStatistics());
+
+		std::ostringstream csv;
+		runHeadless(*engine, 5, board.rows() * board.columns(), std::nullopt, false, std::nullopt,
+			HeadlessStatistics{ csv, 100 });
+
+		std::istringstream lines{ csv.str() };
+		std::string line;
+		std::getline(lines, line);
+		REQUIRE(line == "generation,population,births,deaths,first_row,first_col,last_row,last_col");
+		auto stepped = makeEngine("grid", board.getSize(), 1);
+		stepped->load(board);
+		for (std::uint64_t generation = 0; generation <= 5; generation++) {
+			if (generation > 0) {
+				stepped->step(1);
+			}
+			REQUIRE(std::getline(lines, line));
+			std::istringstream fields{ line };
+			std::string generation_field;
+			std::string population_field;
+			std::getline(fields, generation_field, ',');
+			std::getline(fields, population_field, ',');
+			REQUIRE(generation_field == std::to_string(100 + generation));
+			REQUIRE(population_field == std::to_string(stepped->population()));
+		}
+		REQUIRE_FALSE(std::getline(lines, line));
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include "../src/grid.h"
+
+// A board with each cell alive with probability `density`, the same cells for
+// the same seed.
+inline Grid makeRandomGrid(std::size_t rows, std::size_t columns, double density, std::uint64_t seed) {
+	Grid grid{ rows, columns };
+	fillRandom(grid, density, seed);
+	return grid;
+}
+
+// Whether both boards are the same size with the same cells alive.
+inline bool isSame(const Grid& lhs, const Grid& rhs) {
+	if (lhs.rows() != rhs.rows() || lhs.columns() != rhs.columns()) {
+		return false;
+	}
+	for (std::size_t i = 0; i < lhs.rows(); i++) {
+		for (std::size_t j = 0; j < lhs.columns(); j++) {
+			if (lhs.at({ i, j }).data != rhs.at({ i, j }).data) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,111 @@
+#include <sstream>
+#include <string>
+#include <thread>
+#include "catch.hpp"
+#include "../src/metrics.h"
+
+TEST_CASE("SampleRing keeps the latest values in order", "[metrics]") {
+	{
+		SampleRing<4> ring;
+		REQUIRE(ring.count() == 0);
+		REQUIRE(ring.latest().empty());
+
+		ring.push(1);
+		ring.push(2);
+		REQUIRE(ring.latest() == std::vector<std::uint64_t>{ 1, 2 });
+
+		for (std::uint64_t i = 3; i <= 9; i++) {
+			ring.push(i);
+		}
+		REQUIRE(ring.count() == 9);
+		// The slot after the newest value may be in the middle of a write.
+		REQUIRE(ring.latest() == std::vector<std::uint64_t>{ 7, 8, 9 });
+	}
+}
+
+TEST_CASE("SampleRing readers never see overwritten values", "[metrics]") {
+	{
+		constexpr std::uint64_t value_count = 200000;
+		SampleRing<16> ring;
+
+		std::thread writer{ [&] {
+			for (std::uint64_t i = 1; i <= value_count; i++) {
+				ring.push(i);
+			}
+		} };
+
+		bool is_consecutive = true;
+		while (ring.count() < value_count) {
+			const auto values = ring.latest();
+			for (std::size_t i = 1; i < values.size(); i++) {
+				is_consecutive = is_consecutive && values[i] == values[i - 1] + 1;
+			}
+		}
+		writer.join();
+		REQUIRE(is_consecutive);
+	}
+}
+
+TEST_CASE("Metrics summarize timings and keep counters", "[metrics]") {
+	{
+		Metrics metrics;
+		REQUIRE(metrics.summarize(Scope::step).samples == 0);
+
+		metrics.record(Scope::step, std::chrono::milliseconds{ 1 });
+		metrics.record(Scope::step, std::chrono::milliseconds{ 3 });
+		metrics.record(Scope::render, std::chrono::microseconds{ 500 });
+		metrics.set(Counter::population, 42);
+
+		const auto step = metrics.summarize(Scope::step);
+		REQUIRE(step.samples == 2);
+		REQUIRE(step.mean_ms == Approx(2));
+		REQUIRE(step.max_ms == Approx(3));
+		REQUIRE(metrics.timingCount(Scope::render) == 1);
+		REQUIRE(metrics.get(Counter::population) == 42);
+		REQUIRE(metrics.get(Counter::generation) == 0);
+	}
+	{
+		Metrics metrics;
+		{
+			const ScopedTimer timer{ metrics, Scope::publish };
+			std::this_thread::sleep_for(std::chrono::milliseconds{ 2 });
+		}
+		REQUIRE(metrics.timingCount(Scope::publish) == 1);
+		REQUIRE(metrics.summarize(Scope::publish).mean_ms >= 2);
+	}
+}
+
+TEST_CASE("RateMeter averages over its interval", "[metrics]") {
+	{
+		RateMeter meter{ std::chrono::milliseconds{ 500 } };
+		const auto start = RateMeter::Clock::time_point{};
+		REQUIRE(meter.update(100, start) == 0);
+		REQUIRE(meter.update(150, start + std::chrono::milliseconds{ 100 }) == 0);
+		REQUIRE(meter.update(600, start + std::chrono::seconds{ 1 }) == Approx(500));
+		REQUIRE(meter.update(700, start + std::chrono::milliseconds{ 1100 }) == Approx(500));
+		REQUIRE(meter.update(700, start + std::chrono::seconds{ 2 }) == Approx(100));
+	}
+}
+
+TEST_CASE("Metrics export as CSV and JSON", "[metrics]") {
+	{
+		Metrics metrics;
+		metrics.record(Scope::step, std::chrono::nanoseconds{ 10 });
+		metrics.record(Scope::step, std::chrono::nanoseconds{ 20 });
+		metrics.set(Counter::generation, 7);
+
+		std::ostringstream csv;
+		writeMetricsCsv(csv, metrics);
+		const auto csv_text = csv.str();
+		REQUIRE(csv_text.starts_with("kind,name,index,value\n"));
+		REQUIRE(csv_text.find("timing,step,0,10\ntiming,step,1,20\n") != std::string::npos);
+		REQUIRE(csv_text.find("counter,generation,,7\n") != std::string::npos);
+
+		std::ostringstream json;
+		writeMetricsJson(json, metrics);
+		const auto json_text = json.str();
+		REQUIRE(json_text.find("\"step\": [10, 20]") != std::string::npos);
+		REQUIRE(json_text.find("\"render\": []") != std::string::npos);
+		REQUIRE(json_text.find("\"generation\": 7") != std::string::npos);
+	}
+}
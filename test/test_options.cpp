@@ -28,3 +28,107 @@ TEST_CASE("Command line options are correctly parsed", "[options]") {
 		REQUIRE(run_options.cell_size == 40);
 	}
 }
+
+TEST_CASE("Thread count option is correctly parsed", "[options]") {
+	{
+		std::array<std::string, 3> in{ "game_of_life", "-t", "6" };
+		std::array<char*, in.size()> argv{ in[0].data(), in[1].data(), in[2].data() };
+
+		const auto run_options = parseOptions(argv.size(), argv.data());
+		REQUIRE(run_options.threads == 6);
+	}
+	{
+		std::array<std::string, 1> in{ "game_of_life" };
+		std::array<char*, in.size()> argv{ in[0].data() };
+
+		const auto run_options = parseOptions(argv.size(), argv.data());
+		REQUIRE(run_options.threads == 0);
+	}
+}
+
+TEST_CASE("Headless options are correctly parsed", "[options]") {
+	{
+		std::array<std::string, 13> in{
+			"game_of_life", "--headless", "-s", "300x200", "--seed", "12",
+			"-g", "500", "-e", "hashlife", "--density", "0.25", "--stop-on-cycle"
+		};
+		std::array<char*, in.size()> argv{};
+		for (std::size_t i = 0; i < in.size(); i++) {
+			argv[i] = in[i].data();
+		}
+
+		const auto run_options = parseOptions(argv.size(), argv.data());
+		REQUIRE(run_options.headless == true);
+		REQUIRE(run_options.board_width == 300);
+		REQUIRE(run_options.board_height == 200);
+		REQUIRE(run_options.seed == 12);
+		REQUIRE(run_options.generations == 500);
+		REQUIRE(run_options.engine == "hashlife");
+		REQUIRE(run_options.density == 0.25);
+		REQUIRE(run_options.pattern.empty());
+		REQUIRE(run_options.dump.empty());
+		REQUIRE(run_options.stop_on_cycle == true);
+	}
+}
+
+TEST_CASE("Rule option is correctly parsed", "[options]") {
+	{
+		std::array<std::string, 3> in{ "game_of_life", "--rule", "B36/S23" };
+		std::array<char*, in.size()> argv{ in[0].data(), in[1].data(), in[2].data() };
+
+		const auto run_options = parseOptions(argv.size(), argv.data());
+		REQUIRE(run_options.rule == highlife_rule);
+	}
+	{
+		std::array<std::string, 1> in{ "game_of_life" };
+		std::array<char*, in.size()> argv{ in[0].data() };
+
+		const auto run_options = parseOptions(argv.size(), argv.data());
+		REQUIRE(run_options.rule == life_rule);
+	}
+}
+
+TEST_CASE("Ensemble options are correctly parsed", "[options]") {
+	{
+		std::array<std::string, 5> in{ "game_of_life", "--ensemble", "8", "--ensemble-densities", "0.1,0.35" };
+		std::array<char*, in.size()> argv{};
+		for (std::size_t i = 0; i < in.size(); i++) {
+			argv[i] = in[i].data();
+		}
+
+		const auto run_options = parseOptions(argv.size(), argv.data());
+		REQUIRE(run_options.headless == true);
+		REQUIRE(run_options.ensemble == 8);
+		REQUIRE(run_options.ensemble_densities == std::vector{ 0.1, 0.35 });
+	}
+	{
+		REQUIRE(parseDensities("").empty());
+		REQUIRE(parseDensities("1") == std::vector{ 1.0 });
+		REQUIRE_THROWS(parseDensities("0.1,,0.2"));
+		REQUIRE_THROWS(parseDensities("1.5"));
+		REQUIRE_THROWS(parseDensities("abc"));
+	}
+}
+
+TEST_CASE("Domain options are correctly parsed", "[options]") {
+	{
+		std::array<std::string, 3> in{ "game_of_life", "--domains", "4x2" };
+		std::array<char*, in.size()> argv{};
+		for (std::size_t i = 0; i < in.size(); i++) {
+			argv[i] = in[i].data();
+		}
+
+		const auto run_options = parseOptions(argv.size(), argv.data());
+		REQUIRE(run_options.headless == true);
+		REQUIRE(run_options.domains_across == 4);
+		REQUIRE(run_options.domains_down == 2);
+	}
+	{
+		std::array<std::string, 1> in{ "game_of_life" };
+		std::array<char*, in.size()> argv{ in[0].data() };
+
+		const auto run_options = parseOptions(argv.size(), argv.data());
+		REQUIRE(run_options.domains_across == 0);
+		REQUIRE(run_options.domains_down == 0);
+	}
+}
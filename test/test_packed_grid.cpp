@@ -0,0 +1,113 @@
+#include <vector>
+#include "catch.hpp"
+#include "test_helpers.h"
+#include "../src/packed_grid.h"
+
+namespace {
+
+Grid stepWithCheckCell(const Grid& grid) {
+	Grid next{ grid.rows(), grid.columns() };
+	for (std::size_t i = 0; i < grid.rows(); i++) {
+		for (std::size_t j = 0; j < grid.columns(); j++) {
+			next.at({ i, j }).data = grid.checkCell({ i, j });
+		}
+	}
+	return next;
+}
+
+}
+
+TEST_CASE("PackedGrid class sizes are correct", "[packed_grid]") {
+	{
+		const PackedGrid grid{ 5, 130 };
+		REQUIRE(grid.rows() == 5);
+		REQUIRE(grid.columns() == 130);
+		REQUIRE(grid.wordsPerRow() == 3);
+	}
+	{
+		const PackedGrid grid{ 3, 64 };
+		REQUIRE(grid.wordsPerRow() == 1);
+	}
+}
+
+TEST_CASE("PackedGrid class converts to and from Grid", "[packed_grid]") {
+	{
+		const auto grid = makeRandomGrid(7, 100, 0.5, 1);
+		const PackedGrid packed{ grid };
+		for (std::size_t i = 0; i < grid.rows(); i++) {
+			for (std::size_t j = 0; j < grid.columns(); j++) {
+				REQUIRE(packed.get({ i, j }) == grid.at({ i, j }).data);
+			}
+		}
+		REQUIRE(isSame(packed.toGrid(), grid));
+	}
+	{
+		PackedGrid packed{ 2, 70 };
+		packed.set({ 1, 69 }, true);
+		REQUIRE(packed.get({ 1, 69 }) == true);
+		REQUIRE(packed.row(1)[1] == (PackedGrid::Word{ 1 } << 5));
+		packed.set({ 1, 69 }, false);
+		REQUIRE(packed.get({ 1, 69 }) == false);
+	}
+}
+
+TEST_CASE("PackedGrid step matches Grid::checkCell", "[packed_grid]") {
+	const std::size_t sizes[][2] = {
+		{ 1, 1 }, { 2, 2 }, { 3, 5 }, { 1, 70 }, { 8, 63 }, { 9, 64 },
+		{ 10, 65 }, { 16, 128 }, { 17, 129 }, { 40, 200 }
+	};
+	unsigned seed = 0;
+	for (const auto& size : sizes) {
+		for (const double density : { 0.1, 0.35, 0.6 }) {
+			auto grid = makeRandomGrid(size[0], size[1], density, seed++);
+			PackedGrid current{ grid };
+			PackedGrid next{ grid.rows(), grid.columns() };
+			for (int gen = 0; gen < 20; gen++) {
+				grid = stepWithCheckCell(grid);
+				current.step(next);
+				std::swap(current, next);
+				REQUIRE(isSame(current.toGrid(), grid));
+			}
+		}
+	}
+}
+
+TEST_CASE("PackedGrid glider wraps around the torus", "[packed_grid]") {
+	{
+		PackedGrid current{ 6, 70 };
+		PackedGrid next{ 6, 70 };
+		const Index glider[] = {
+			{ 0, 68 }, { 1, 69 }, { 2, 67 }, { 2, 68 }, { 2, 69 }
+		};
+		for (const auto ind : glider) {
+			current.set(ind, true);
+		}
+		Grid grid = current.toGrid();
+		for (int gen = 0; gen < 4 * 70; gen++) {
+			grid = stepWithCheckCell(grid);
+			current.step(next);
+			std::swap(current, next);
+		}
+		REQUIRE(isSame(current.toGrid(), grid));
+	}
+}
+
+TEST_CASE("Cells are packed and unpacked in the PackedGrid layout", "[packed_grid]") {
+	for (const std::size_t count : { 1, 7, 8, 63, 64, 65, 200 }) {
+		const auto grid = makeRandomGrid(1, count, 0.5, static_cast<unsigned>(count));
+		std::vector<PackedGrid::Word> words((count + 63) / 64, ~PackedGrid::Word{ 0 });
+		packCells(grid.row(0), count, words.data());
+		for (std::size_t j = 0; j < count; j++) {
+			REQUIRE(((words[j / 64] >> (j % 64)) & 1) == grid.at({ 0, j }).data);
+		}
+		if (count % 64 != 0) {
+			REQUIRE(words.back() >> (count % 64) == 0);
+		}
+
+		std::vector<Cell> cells(count, Cell{ true });
+		unpackCells(words.data(), count, cells.data());
+		for (std::size_t j = 0; j < count; j++) {
+			REQUIRE(cells[j].data == grid.at({ 0, j }).data);
+		}
+	}
+}
@@ -0,0 +1,166 @@
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "catch.hpp"
+#include "../src/pattern.h"
+
+TEST_CASE("Plaintext patterns are correctly read", "[pattern]") {
+	{
+		std::istringstream in{ "!Name: Glider\n!\n.O\n..O\r\nOOO\n" };
+		const auto grid = readPlaintext(in);
+		REQUIRE(grid.rows() == 3);
+		REQUIRE(grid.columns() == 3);
+		REQUIRE(grid.at({ 0, 1 }).data == true);
+		REQUIRE(grid.at({ 0, 2 }).data == false);
+		REQUIRE(grid.at({ 1, 2 }).data == true);
+		REQUIRE(grid.at({ 2, 0 }).data == true);
+		REQUIRE(grid.at({ 2, 2 }).data == true);
+	}
+	{
+		std::istringstream in{ "!only a comment\n" };
+		REQUIRE_THROWS(readPlaintext(in));
+	}
+}
+
+TEST_CASE("Plaintext patterns survive a round trip", "[pattern]") {
+	{
+		Grid grid{ 2, 4 };
+		grid.at({ 0, 3 }).data = true;
+		grid.at({ 1, 0 }).data = true;
+		std::stringstream stream;
+		writePlaintext(stream, grid);
+		REQUIRE(stream.str() == "...O\nO...\n");
+		const auto read = readPlaintext(stream);
+		REQUIRE(read.rows() == 2);
+		REQUIRE(read.columns() == 4);
+		REQUIRE(read.at({ 0, 3 }).data == true);
+		REQUIRE(read.at({ 1, 0 }).data == true);
+		REQUIRE(read.at({ 0, 0 }).data == false);
+	}
+}
+
+TEST_CASE("Patterns are placed with wrap-around", "[pattern]") {
+	{
+		Grid pattern{ 2, 2 };
+		pattern.at({ 0, 0 }).data = true;
+		pattern.at({ 1, 1 }).data = true;
+		Grid target{ 4, 5 };
+		placePattern(pattern, target, { 3, 4 });
+		REQUIRE(target.at({ 3, 4 }).data == true);
+		REQUIRE(target.at({ 0, 0 }).data == true);
+		REQUIRE(target.at({ 3, 0 }).data == false);
+		REQUIRE(target.at({ 0, 4 }).data == false);
+	}
+}
+
+TEST_CASE("RLE patterns are correctly read", "[pattern]") {
+	{
+		std::istringstream in{ "#N Glider\n#C a comment\nx = 3, y = 3, rule = B3/S23\nbo$2bo$3o!\n" };
+		const auto grid = readRle(in);
+		REQUIRE(grid.rows() == 3);
+		REQUIRE(grid.columns() == 3);
+		REQUIRE(grid.at({ 0, 0 }).data == false);
+		REQUIRE(grid.at({ 0, 1 }).data == true);
+		REQUIRE(grid.at({ 1, 2 }).data == true);
+		REQUIRE(grid.at({ 2, 0 }).data == true);
+		REQUIRE(grid.at({ 2, 2 }).data == true);
+	}
+	{
+		std::istringstream in{ "x=4,y=5\n2o$\n3$3b\no!" };
+		const auto grid = readRle(in);
+		REQUIRE(grid.rows() == 5);
+		REQUIRE(grid.columns() == 4);
+		REQUIRE(grid.at({ 0, 1 }).data == true);
+		REQUIRE(grid.at({ 4, 3 }).data == true);
+		REQUIRE(grid.at({ 3, 3 }).data == false);
+	}
+	{
+		std::istringstream in{ "bo$2bo$3o!\n" };
+		REQUIRE_THROWS(readRle(in));
+	}
+	{
+		std::istringstream in{ "x = 2, y = 2\n3o!\n" };
+		REQUIRE_THROWS(readRle(in));
+	}
+	// Malformed sizes, and sizes too large to allocate.
+	const char* headers[] = {
+		"x = abc, y = 2", "x = 3, y = 2z", "x = 99999999999999999999999, y = 2",
+		"x = 100000000, y = 100000000", "x = 18446744073709551615, y = 2"
+	};
+	for (const auto header : headers) {
+		std::istringstream in{ std::string{ header } + "\n3o!\n" };
+		REQUIRE_THROWS_AS(readRle(in), std::runtime_error);
+	}
+}
+
+TEST_CASE("RLE patterns survive a round trip", "[pattern]") {
+	{
+		Grid grid{ 6, 100 };
+		grid.at({ 0, 0 }).data = true;
+		grid.at({ 0, 1 }).data = true;
+		grid.at({ 3, 50 }).data = true;
+		for (std::size_t col = 60; col < 99; col++) {
+			grid.at({ 4, col }).data = col % 3 == 0;
+		}
+		std::stringstream stream;
+		writeRle(stream, grid);
+		REQUIRE(stream.str().starts_with("x = 100, y = 6, rule = B3/S23\n2o3$50bo$60bo"));
+
+		std::string line;
+		while (std::getline(stream, line)) {
+			REQUIRE(line.size() <= 70);
+		}
+
+		stream.clear();
+		stream.seekg(0);
+		const auto read = readRle(stream);
+		REQUIRE(read.rows() == grid.rows());
+		REQUIRE(read.columns() == grid.columns());
+		for (std::size_t row = 0; row < grid.rows(); row++) {
+			for (std::size_t col = 0; col < grid.columns(); col++) {
+				REQUIRE(read.at({ row, col }).data == grid.at({ row, col }).data);
+			}
+		}
+	}
+	{
+		Grid grid{ 1, 1 };
+		std::stringstream stream;
+		writeRle(stream, grid, highlife_rule);
+		REQUIRE(stream.str().starts_with("x = 1, y = 1, rule = B36/S23\n"));
+	}
+}
+
+TEST_CASE("Pattern files are read and written by extension", "[pattern]") {
+	Grid grid{ 3, 70 };
+	grid.at({ 0, 1 }).data = true;
+	grid.at({ 1, 69 }).data = true;
+	grid.at({ 2, 0 }).data = true;
+
+	for (const std::string path : { "test_pattern.cells", "test_pattern.rle", "test_pattern.RLE", "test_pattern.gol" }) {
+		writePattern(path, grid);
+		const auto read = readPattern(path);
+		std::remove(path.c_str());
+
+		REQUIRE(read.rows() == grid.rows());
+		REQUIRE(read.columns() == grid.columns());
+		for (std::size_t row = 0; row < grid.rows(); row++) {
+			for (std::size_t col = 0; col < grid.columns(); col++) {
+				REQUIRE(read.at({ row, col }).data == grid.at({ row, col }).data);
+			}
+		}
+	}
+
+	REQUIRE_THROWS(readPattern("nonexistent.rle"));
+	REQUIRE_THROWS(readPattern("nonexistent.gol"));
+}
+
+TEST_CASE("Patterns are placed in the middle", "[pattern]") {
+	{
+		Grid pattern{ 2, 2 };
+		pattern.at({ 0, 0 }).data = true;
+		Grid target{ 6, 7 };
+		placePatternCentred(pattern, target);
+		REQUIRE(target.at({ 2, 2 }).data == true);
+	}
+}
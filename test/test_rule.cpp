@@ -0,0 +1,51 @@
+#include <string>
+#include "catch.hpp"
+#include "../src/rule.h"
+
+TEST_CASE("Rules in B/S notation are correctly parsed", "[rule]") {
+	{
+		REQUIRE(parseRule("B3/S23") == life_rule);
+		REQUIRE(parseRule("b36/s23") == highlife_rule);
+		REQUIRE(parseRule("S23/B36") == highlife_rule);
+		REQUIRE(parseRule("B3678/S34678") == day_and_night_rule);
+		REQUIRE(parseRule("B2/S") == seeds_rule);
+	}
+	{
+		// Older S/B notation, survival first.
+		REQUIRE(parseRule("23/3") == life_rule);
+		REQUIRE(parseRule("/2") == seeds_rule);
+	}
+}
+
+TEST_CASE("Invalid rules are rejected", "[rule]") {
+	{
+		REQUIRE_THROWS(parseRule(""));
+		REQUIRE_THROWS(parseRule("B3S23"));
+		REQUIRE_THROWS(parseRule("B9/S23"));
+		REQUIRE_THROWS(parseRule("B3/X23"));
+		REQUIRE_THROWS(parseRule("B3/S2a"));
+	}
+}
+
+TEST_CASE("Rules are written in B/S notation", "[rule]") {
+	{
+		REQUIRE(toString(life_rule) == "B3/S23");
+		REQUIRE(toString(seeds_rule) == "B2/S");
+		REQUIRE(toString(parseRule("s8/b0")) == "B0/S8");
+		REQUIRE(parseRule(toString(day_and_night_rule)) == day_and_night_rule);
+	}
+}
+
+TEST_CASE("Rules give the next state from the sum including the cell", "[rule]") {
+	{
+		REQUIRE(life_rule.getNextState(false, 3) == true);
+		REQUIRE(life_rule.getNextState(false, 4) == false);
+		REQUIRE(life_rule.getNextState(true, 3) == true);
+		REQUIRE(life_rule.getNextState(true, 4) == true);
+		REQUIRE(life_rule.getNextState(true, 5) == false);
+		REQUIRE(life_rule.getNextState(true, 1) == false);
+		REQUIRE(highlife_rule.getNextState(false, 6) == true);
+		REQUIRE(parseRule("B0/S8").getNextState(false, 0) == true);
+		REQUIRE(parseRule("B0/S8").getNextState(true, 9) == true);
+	}
+}
@@ -0,0 +1,321 @@
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "catch.hpp"
+#include "../src/simulation.h"
+
+namespace {
+
+// Polls for a frame that satisfies `predicate`, the simulation publishes
+// asynchronously.
+template <typename Predicate>
+bool waitForFrame(Simulation& simulation, Predicate predicate) {
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{ 10 };
+	while (std::chrono::steady_clock::now() < deadline) {
+		simulation.updateFrame();
+		if (predicate(simulation.frame())) {
+			return true;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+	}
+	return false;
+}
+
+Simulation::Acknowledge acknowledge(std::uint64_t ticket, bool with_cells, bool waits_for_steps) {
+	return { .ticket = ticket,
+		.on_published = nullptr,
+		.with_cells = with_cells,
+		.waits_for_steps = waits_for_steps };
+}
+
+// Polls for the snapshot of the Acknowledge with `ticket`.
+std::shared_ptr<const SimulationSnapshot> waitForSnapshot(Simulation& simulation, std::uint64_t ticket) {
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{ 10 };
+	while (std::chrono::steady_clock::now() < deadline) {
+		auto snapshot = simulation.snapshot();
+		if (snapshot && snapshot->ticket == ticket) {
+			return snapshot;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+	}
+	return nullptr;
+}
+
+}
+
+TEST_CASE("Simulation publishes edits while paused", "[simulation]") {
+	{
+		Simulation simulation{ 8, 8 };
+		REQUIRE(simulation.frame().generation == 0);
+
+		simulation.post(Simulation::ToggleCell{ { 2, 3 } });
+		REQUIRE(waitForFrame(simulation, [](const SimulationFrame& frame) {
+			return frame.grid.at({ 2, 3 }).data;
+		}));
+		REQUIRE(simulation.frame().generation == 0);
+
+		simulation.post(Simulation::ToggleCell{ { 2, 3 } });
+		REQUIRE(waitForFrame(simulation, [](const SimulationFrame& frame) {
+			return !frame.grid.at({ 2, 3 }).data;
+		}));
+	}
+}
+
+TEST_CASE("Simulation steps on its own thread", "[simulation]") {
+	{
+		Simulation simulation{ 16, 16, 2 };
+		for (const std::size_t col : { 1, 2, 3 }) {
+			simulation.post(Simulation::ToggleCell{ { 5, col } });
+		}
+		simulation.post(Simulation::SetUnthrottled{ true });
+		simulation.post(Simulation::SetPaused{ false });
+		REQUIRE(waitForFrame(simulation, [](const SimulationFrame& frame) {
+			return frame.generation >= 100;
+		}));
+
+		simulation.post(Simulation::SetPaused{ true });
+		std::this_thread::sleep_for(std::chrono::milliseconds{ 20 });
+		simulation.updateFrame();
+		const auto paused_at = simulation.frame().generation;
+		std::this_thread::sleep_for(std::chrono::milliseconds{ 20 });
+		simulation.updateFrame();
+		REQUIRE(simulation.frame().generation == paused_at);
+
+		// A blinker: vertical on odd generations, horizontal on even ones.
+		const auto& grid = simulation.frame().grid;
+		const bool is_vertical = paused_at % 2 == 1;
+		REQUIRE(grid.at({ 5, 2 }).data == true);
+		REQUIRE(grid.at({ 4, 2 }).data == is_vertical);
+		REQUIRE(grid.at({ 5, 1 }).data == !is_vertical);
+
+		const auto& metrics = simulation.metrics();
+		REQUIRE(metrics.timingCount(Scope::step) == paused_at);
+		REQUIRE(metrics.timingCount(Scope::publish) > 0);
+		REQUIRE(metrics.get(Counter::generation) == paused_at);
+		REQUIRE(metrics.get(Counter::engine_bytes) >= 2 * 16 * 16);
+		REQUIRE(metrics.get(Counter::frame_bytes) >= 3 * 16 * 16);
+	}
+}
+
+TEST_CASE("Simulation honours the step delay", "[simulation]") {
+	{
+		Simulation simulation{ 8, 8 };
+		simulation.post(Simulation::SetStepDelay{ std::chrono::milliseconds{ 1000 } });
+		simulation.post(Simulation::SetPaused{ false });
+		REQUIRE(waitForFrame(simulation, [](const SimulationFrame& frame) {
+			return frame.generation == 1;
+		}));
+		std::this_thread::sleep_for(std::chrono::milliseconds{ 50 });
+		simulation.updateFrame();
+		REQUIRE(simulation.frame().generation == 1);
+	}
+}
+
+TEST_CASE("Simulation moves the view across the plane", "[simulation]") {
+	{
+		Simulation simulation{ 8, 8, 1, life_rule, Topology::plane };
+		REQUIRE(simulation.topology() == Topology::plane);
+
+		simulation.post(Simulation::ToggleCell{ { 2, 3 } });
+		simulation.post(Simulation::PanView{ -10, 2 });
+		REQUIRE(waitForFrame(simulation, [](const SimulationFrame& frame) {
+			return frame.view_x == -10 && frame.view_y == 2;
+		}));
+		// The cell is now outside the view.
+		for (std::size_t i = 0; i < 8; i++) {
+			for (std::size_t j = 0; j < 8; j++) {
+				REQUIRE(simulation.frame().grid.at({ i, j }).data == false);
+			}
+		}
+
+		simulation.post(Simulation::PanView{ 7, -1 });
+		REQUIRE(waitForFrame(simulation, [](const SimulationFrame& frame) {
+			return frame.view_x == -3 && frame.view_y == 1;
+		}));
+		REQUIRE(simulation.frame().grid.at({ 1, 6 }).data == true);
+	}
+	{
+		// A torus ignores panning, edits keep showing where they were made.
+		Simulation simulation{ 8, 8 };
+		simulation.post(Simulation::PanView{ 3, 3 });
+		simulation.post(Simulation::ToggleCell{ { 2, 3 } });
+		REQUIRE(waitForFrame(simulation, [](const SimulationFrame& frame) {
+			return frame.grid.at({ 2, 3 }).data;
+		}));
+		REQUIRE(simulation.frame().view_x == 0);
+	}
+}
+
+TEST_CASE("Simulation notices when the board repeats", "[simulation]") {
+	{
+		Simulation simulation{ 10, 10 };
+		for (const std::size_t col : { 1, 2, 3 }) {
+			simulation.post(Simulation::ToggleCell{ { 5, col } });
+		}
+		simulation.post(Simulation::SetUnthrottled{ true });
+		simulation.post(Simulation::SetPaused{ false });
+		REQUIRE(waitForFrame(simulation, [](const SimulationFrame& frame) {
+			return frame.cycle.has_value();
+		}));
+		REQUIRE(simulation.frame().cycle->start == 0);
+		REQUIRE(simulation.frame().cycle->period == 2);
+
+		// Editing the board starts the search over.
+		simulation.post(Simulation::SetPaused{ true });
+		simulation.post(Simulation::ToggleCell{ { 0, 0 } });
+		REQUIRE(waitForFrame(simulation, [](const SimulationFrame& frame) {
+			return !frame.cycle.has_value();
+		}));
+	}
+}
+
+TEST_CASE("Simulation steps back through its history", "[simulation]") {
+	{
+		Simulation simulation{ 16, 16 };
+		// A glider, which never repeats on the way back.
+		for (const Index cell : { Index{ 0, 1 }, Index{ 1, 2 }, Index{ 2, 0 }, Index{ 2, 1 }, Index{ 2, 2 } }) {
+			simulation.post(Simulation::ToggleCell{ cell });
+		}
+		simulation.post(Simulation::SetUnthrottled{ true });
+		simulation.post(Simulation::SetPaused{ false });
+		REQUIRE(waitForFrame(simulation, [](const SimulationFrame& frame) {
+			return frame.generation >= 20;
+		}));
+		simulation.post(Simulation::SetPaused{ true });
+		simulation.post(Simulation::SeekGeneration{ 4 });
+		REQUIRE(waitForFrame(simulation, [](const SimulationFrame& frame) {
+			return frame.generation == 4;
+		}));
+		REQUIRE(simulation.frame().history_oldest == 0);
+		REQUIRE(simulation.frame().history_newest >= 20);
+		// Four generations move a glider one cell diagonally.
+		for (const Index cell : { Index{ 1, 2 }, Index{ 2, 3 }, Index{ 3, 1 }, Index{ 3, 2 }, Index{ 3, 3 } }) {
+			REQUIRE(simulation.frame().grid.at(cell).data);
+		}
+
+		simulation.post(Simulation::StepBack{ 10 });
+		REQUIRE(waitForFrame(simulation, [](const SimulationFrame& frame) {
+			return frame.generation == 0 && frame.grid.at({ 2, 0 }).data;
+		}));
+		REQUIRE(simulation.metrics().timingCount(Scope::seek) == 2);
+	}
+}
+
+TEST_CASE("Simulation applies bulk edits", "[simulation]") {
+	for (const auto topology : { Topology::torus, Topology::plane }) {
+		Simulation simulation{ 10, 12, 1, life_rule, topology };
+		const auto countLive = [](const SimulationFrame& frame) {
+			std::size_t population = 0;
+			for (std::size_t i = 0; i < frame.grid.rows(); i++) {
+				for (std::size_t j = 0; j < frame.grid.columns(); j++) {
+					population += frame.grid.at({ i, j }).data;
+				}
+			}
+			return population;
+		};
+
+		Grid pattern{ 2, 3 };
+		pattern.at({ 1, 2 }).data = true;
+		simulation.post(Simulation::FillCells{ { 1, 1 }, { 3, 4 }, true });
+		simulation.post(Simulation::FillCells{ { 2, 2 }, { 1, 2 }, false });
+		simulation.post(Simulation::PastePattern{ pattern, { 7, 8 } });
+		REQUIRE(waitForFrame(simulation, [&](const SimulationFrame& frame) {
+			return countLive(frame) == 11;
+		}));
+		const auto& grid = simulation.frame().grid;
+		REQUIRE(grid.at({ 1, 1 }).data);
+		REQUIRE(grid.at({ 3, 4 }).data);
+		REQUIRE_FALSE(grid.at({ 2, 2 }).data);
+		REQUIRE_FALSE(grid.at({ 4, 1 }).data);
+		REQUIRE(grid.at({ 8, 10 }).data);
+
+		simulation.post(Simulation::RandomFillCells{ { 0, 0 }, { 10, 12 }, 1.0, 1 });
+		REQUIRE(waitForFrame(simulation, [&](const SimulationFrame& frame) {
+			return countLive(frame) == 120;
+		}));
+
+		simulation.post(Simulation::ClearBoard{});
+		REQUIRE(waitForFrame(simulation, [&](const SimulationFrame& frame) {
+			return countLive(frame) == 0;
+		}));
+	}
+}
+
+TEST_CASE("Simulation only packs the view into snapshots that ask for it", "[simulation]") {
+	{
+		Simulation simulation{ 6, 70 };
+		REQUIRE(simulation.snapshot() == nullptr);
+
+		simulation.post(Simulation::SetCells{ { { 2, 1 }, { 2, 2 }, { 2, 3 } }, true });
+		simulation.post(acknowledge(1, false, false));
+		const auto counts = waitForSnapshot(simulation, 1);
+		REQUIRE(counts != nullptr);
+		REQUIRE(counts->generation == 0);
+		REQUIRE(counts->population == 3);
+		REQUIRE(counts->cells == nullptr);
+
+		simulation.post(acknowledge(2, true, false));
+		const auto first = waitForSnapshot(simulation, 2);
+		simulation.post(acknowledge(3, true, false));
+		const auto second = waitForSnapshot(simulation, 3);
+		REQUIRE(first != nullptr);
+		REQUIRE(second != nullptr);
+		REQUIRE(second->cells != nullptr);
+		REQUIRE(second->cells->get({ 2, 1 }));
+		REQUIRE_FALSE(second->cells->get({ 1, 2 }));
+		// The board did not change in between, so the cells are packed once.
+		REQUIRE(first->cells == second->cells);
+
+		simulation.post(Simulation::Step{ 1 });
+		simulation.post(acknowledge(4, true, true));
+		const auto stepped = waitForSnapshot(simulation, 4);
+		REQUIRE(stepped != nullptr);
+		REQUIRE(stepped->generation == 1);
+		REQUIRE(stepped->cells != second->cells);
+		REQUIRE(stepped->cells->get({ 1, 2 }));
+		REQUIRE_FALSE(stepped->cells->get({ 2, 1 }));
+	}
+}
+
+TEST_CASE("Simulation works off steps between other commands", "[simulation]") {
+	{
+		Simulation simulation{ 32, 32 };
+		simulation.post(Simulation::SetCells{ { { 2, 1 }, { 2, 2 }, { 2, 3 } }, true });
+		simulation.post(Simulation::Step{ 1'000'000'000'000 });
+		simulation.post(acknowledge(1, false, true));
+		REQUIRE(waitForFrame(simulation, [](const SimulationFrame& frame) {
+			return frame.generation > 0;
+		}));
+
+		// Edits and other acknowledgements get through while stepping, the one
+		// waiting for the step only once pausing drops it.
+		const std::vector<Index> block{ { 20, 20 }, { 20, 21 }, { 21, 20 }, { 21, 21 } };
+		simulation.post(Simulation::SetCells{ block, true });
+		simulation.post(acknowledge(2, false, false));
+		const auto between = waitForSnapshot(simulation, 2);
+		REQUIRE(between != nullptr);
+		REQUIRE(between->ticket == 2);
+		REQUIRE(between->population == 7);
+		REQUIRE(between->generation > 0);
+		REQUIRE(between->generation < 1'000'000'000'000);
+		simulation.post(Simulation::SetPaused{ true });
+		const auto paused = waitForSnapshot(simulation, 1);
+		REQUIRE(paused != nullptr);
+		REQUIRE(paused->ticket == 1);
+		REQUIRE(paused->generation < 1'000'000'000'000);
+		REQUIRE(paused->population == 7);
+
+		simulation.post(Simulation::Step{ 2 });
+		simulation.post(acknowledge(3, false, true));
+		const auto stepped = waitForSnapshot(simulation, 3);
+		REQUIRE(stepped != nullptr);
+		REQUIRE(stepped->generation == paused->generation + 2);
+	}
+	{
+		// Stopping does not wait for the step either.
+		Simulation simulation{ 32, 32 };
+		simulation.post(Simulation::Step{ 1'000'000'000'000 });
+	}
+}
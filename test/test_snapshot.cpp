@@ -0,0 +1,59 @@
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include "catch.hpp"
+#include "../src/snapshot.h"
+
+TEST_CASE("Snapshots survive a round trip", "[snapshot]") {
+	for (const auto& [rows, columns] : { std::pair{ 1, 1 }, std::pair{ 3, 64 }, std::pair{ 17, 130 } }) {
+		Grid grid(rows, columns);
+		std::mt19937 gen{ 42 };
+		std::bernoulli_distribution alive{ 0.4 };
+		for (std::size_t row = 0; row < grid.rows(); row++) {
+			for (std::size_t col = 0; col < grid.columns(); col++) {
+				grid.at({ row, col }).data = alive(gen);
+			}
+		}
+
+		writeSnapshot("test_snapshot.gol", grid, 1234);
+		const auto snapshot = readSnapshot("test_snapshot.gol");
+		std::remove("test_snapshot.gol");
+
+		REQUIRE(snapshot.generation == 1234);
+		REQUIRE(snapshot.grid.rows() == grid.rows());
+		REQUIRE(snapshot.grid.columns() == grid.columns());
+		for (std::size_t row = 0; row < grid.rows(); row++) {
+			for (std::size_t col = 0; col < grid.columns(); col++) {
+				REQUIRE(snapshot.grid.at({ row, col }).data == grid.at({ row, col }).data);
+			}
+		}
+	}
+}
+
+TEST_CASE("Snapshots are compact", "[snapshot]") {
+	{
+		writeSnapshot("test_snapshot.gol", Grid{ 10, 65 });
+		std::ifstream in{ "test_snapshot.gol", std::ios::binary | std::ios::ate };
+		REQUIRE(in.tellg() == 32 + 10 * 2 * 8);
+		in.close();
+		std::remove("test_snapshot.gol");
+	}
+}
+
+TEST_CASE("Invalid snapshots are rejected", "[snapshot]") {
+	{
+		std::ofstream{ "test_snapshot.gol" } << "O.O\n.O.\n";
+		REQUIRE_THROWS(readSnapshot("test_snapshot.gol"));
+	}
+	{
+		writeSnapshot("test_snapshot.gol", Grid{ 4, 4 });
+		std::ofstream{ "test_snapshot.gol", std::ios::binary | std::ios::app } << 'x';
+		REQUIRE_THROWS(readSnapshot("test_snapshot.gol"));
+	}
+	{
+		std::ofstream{ "test_snapshot.gol" };
+		REQUIRE_THROWS(readSnapshot("test_snapshot.gol"));
+	}
+	std::remove("test_snapshot.gol");
+	REQUIRE_THROWS(readSnapshot("test_snapshot.gol"));
+}
@@ -0,0 +1,139 @@
+#include "catch.hpp"
+#include "test_helpers.h"
+#include "../src/grid_engine.h"
+#include "../src/sparse_tile_engine.h"
+
+namespace {
+
+void placeGlider(SparseTileEngine& engine, SparseTileEngine::Coord x, SparseTileEngine::Coord y) {
+	engine.setCell(x + 1, y, true);
+	engine.setCell(x + 2, y + 1, true);
+	engine.setCell(x, y + 2, true);
+	engine.setCell(x + 1, y + 2, true);
+	engine.setCell(x + 2, y + 2, true);
+}
+
+}
+
+TEST_CASE("Sparse engine sets and gets cells anywhere on the plane", "[sparse_tile_engine]") {
+	{
+		SparseTileEngine engine;
+		REQUIRE(engine.population() == 0);
+		engine.setCell(0, 0, true);
+		engine.setCell(-1, -1, true);
+		engine.setCell(-65, 63, true);
+		engine.setCell(1'000'000'000, -1'000'000'000, true);
+		REQUIRE(engine.population() == 4);
+		REQUIRE(engine.tileCount() == 4);
+		REQUIRE(engine.getCell(-1, -1) == true);
+		REQUIRE(engine.getCell(-65, 63) == true);
+		REQUIRE(engine.getCell(1'000'000'000, -1'000'000'000) == true);
+		REQUIRE(engine.getCell(-64, 63) == false);
+		REQUIRE(engine.get({ 0, 0 }) == true);
+		engine.setCell(-1, -1, false);
+		REQUIRE(engine.population() == 3);
+		REQUIRE(engine.getCell(-1, -1) == false);
+	}
+	{
+		SparseTileEngine engine;
+		const auto grid = makeRandomGrid(100, 150, 0.3, 1);
+		engine.load(grid, -70, -20);
+		Grid copy{ 100, 150 };
+		engine.save(copy, -70, -20);
+		for (std::size_t i = 0; i < grid.rows(); i++) {
+			for (std::size_t j = 0; j < grid.columns(); j++) {
+				REQUIRE(copy.at({ i, j }).data == grid.at({ i, j }).data);
+			}
+		}
+		engine.clear();
+		REQUIRE(engine.population() == 0);
+		REQUIRE(engine.tileCount() == 0);
+	}
+}
+
+TEST_CASE("Sparse engine matches the grid engine away from the torus edges", "[sparse_tile_engine]") {
+	for (const auto& rule : { life_rule, highlife_rule, parseRule("B36/S245") }) {
+		for (const std::size_t threads : { 1, 3 }) {
+			INFO("rule: " << toString(rule) << ", threads: " << threads);
+			// The soup stays far from the torus edges within the generations run.
+			const auto soup = makeRandomGrid(40, 40, 0.4, 7);
+			Grid board{ 400, 400 };
+			for (std::size_t i = 0; i < soup.rows(); i++) {
+				for (std::size_t j = 0; j < soup.columns(); j++) {
+					board.at({ 180 + i, 180 + j }) = soup.at({ i, j });
+				}
+			}
+			GridEngine grid_engine{ 400, 400, 1, rule };
+			SparseTileEngine sparse{ threads, rule };
+			grid_engine.load(board);
+			sparse.load(soup, -20, -20);
+
+			Grid view{ 400, 400 };
+			for (int checkpoint = 0; checkpoint < 8; checkpoint++) {
+				grid_engine.step(10);
+				sparse.step(10);
+				sparse.save(view, -200, -200);
+				for (std::size_t i = 0; i < view.rows(); i++) {
+					for (std::size_t j = 0; j < view.columns(); j++) {
+						REQUIRE(view.at({ i, j }).data == grid_engine.current().at({ i, j }).data);
+					}
+				}
+				REQUIRE(sparse.population() == grid_engine.population());
+			}
+		}
+	}
+}
+
+TEST_CASE("Sparse engine lets gliders fly without wrapping around", "[sparse_tile_engine]") {
+	{
+		SparseTileEngine engine;
+		placeGlider(engine, 0, 0);
+		// A glider moves one cell down and right every 4 generations.
+		engine.step(4 * 300);
+		REQUIRE(engine.population() == 5);
+		REQUIRE(engine.getCell(301, 300) == true);
+		REQUIRE(engine.getCell(302, 301) == true);
+		REQUIRE(engine.getCell(300, 302) == true);
+		// Only the tiles around the glider exist, not its trail.
+		REQUIRE(engine.tileCount() <= 4);
+		REQUIRE(engine.pooledTileCount() <= 8);
+	}
+}
+
+TEST_CASE("Sparse engine returns dead tiles to the pool", "[sparse_tile_engine]") {
+	{
+		SparseTileEngine engine;
+		engine.setCell(10, 10, true);
+		engine.setCell(-200, 500, true);
+		REQUIRE(engine.tileCount() == 2);
+		engine.step(1);
+		REQUIRE(engine.population() == 0);
+		REQUIRE(engine.tileCount() == 0);
+		const auto pooled = engine.pooledTileCount();
+
+		engine.setCell(5000, 5000, true);
+		engine.setCell(-5000, 5000, true);
+		REQUIRE(engine.tileCount() == 2);
+		REQUIRE(engine.pooledTileCount() == pooled);
+	}
+	{
+		// Once a pattern of many tiles died out, the pool shrinks back.
+		SparseTileEngine engine;
+		for (SparseTileEngine::Coord i = 0; i < 1000; i++) {
+			engine.setCell(i * 100, (i % 7) * 100, true);
+		}
+		REQUIRE(engine.tileCount() == 1000);
+		engine.step(1);
+		REQUIRE(engine.tileCount() == 0);
+		REQUIRE(engine.pooledTileCount() == SparseTileEngine::min_pooled_tiles);
+
+		for (SparseTileEngine::Coord i = 0; i < 1000; i++) {
+			engine.setCell(i * 100, 0, true);
+		}
+		engine.clear();
+		REQUIRE(engine.pooledTileCount() == SparseTileEngine::min_pooled_tiles);
+	}
+	{
+		REQUIRE_THROWS(SparseTileEngine{ 1, parseRule("B0/S8") });
+	}
+}
@@ -0,0 +1,212 @@
+#include <random>
+#include "catch.hpp"
+#include "test_helpers.h"
+#include "../src/step_kernels.h"
+
+namespace {
+
+// Steps copies of `grid` with both kernels and requires them to agree.
+void requireSameSteps(
+	Grid grid, RowKernel expected_kernel, RowKernel actual_kernel, const Rule& rule) {
+	auto expected = grid;
+	auto actual = std::move(grid);
+	Grid next{ expected.rows(), expected.columns() };
+	for (int gen = 0; gen < 6; gen++) {
+		stepRows(expected, next, 0, expected.rows(), expected_kernel, rule);
+		std::swap(expected, next);
+		stepRows(actual, next, 0, actual.rows(), actual_kernel, rule);
+		std::swap(actual, next);
+		for (std::size_t i = 0; i < expected.rows(); i++) {
+			for (std::size_t j = 0; j < expected.columns(); j++) {
+				REQUIRE(actual.at({ i, j }).data == expected.at({ i, j }).data);
+			}
+		}
+	}
+}
+
+}
+
+TEST_CASE("Scalar kernel is always available first", "[step_kernels]") {
+	{
+		const auto& kernels = getAvailableKernels();
+		REQUIRE(kernels.size() >= 1);
+		REQUIRE(kernels.front().name == "scalar");
+		REQUIRE(getDefaultKernel().name == kernels.back().name);
+	}
+}
+
+TEST_CASE("Scalar kernel matches Grid::checkCell", "[step_kernels]") {
+	const auto scalar = getAvailableKernels().front().compute_row;
+	for (const std::size_t columns : { 1, 2, 3, 17, 70 }) {
+		const auto grid = makeRandomGrid(9, columns, 0.4, static_cast<unsigned>(columns));
+		Grid next{ grid.rows(), grid.columns() };
+		stepRows(grid, next, 0, grid.rows(), scalar);
+		for (std::size_t i = 0; i < grid.rows(); i++) {
+			for (std::size_t j = 0; j < grid.columns(); j++) {
+				REQUIRE(next.at({ i, j }).data == grid.checkCell({ i, j }));
+			}
+		}
+	}
+}
+
+TEST_CASE("Every kernel matches the scalar one on random boards", "[step_kernels]") {
+	const auto scalar = getAvailableKernels().front().compute_row;
+	const std::size_t columns_list[] = {
+		1, 2, 3, 15, 16, 17, 18, 31, 33, 34, 63, 65, 66, 100, 129, 130, 257
+	};
+	for (const auto& kernel : getAvailableKernels()) {
+		INFO("kernel: " << kernel.name);
+		unsigned seed = 0;
+		for (const auto columns : columns_list) {
+			for (const double density : { 0.05, 0.3, 0.7 }) {
+				INFO("columns: " << columns << ", density: " << density);
+				auto expected = makeRandomGrid(11, columns, density, seed++);
+				auto actual = expected;
+				Grid next{ expected.rows(), expected.columns() };
+				for (int gen = 0; gen < 8; gen++) {
+					stepRows(expected, next, 0, expected.rows(), scalar);
+					std::swap(expected, next);
+					stepRows(actual, next, 0, actual.rows(), kernel.compute_row);
+					std::swap(actual, next);
+					for (std::size_t i = 0; i < expected.rows(); i++) {
+						for (std::size_t j = 0; j < expected.columns(); j++) {
+							REQUIRE(actual.at({ i, j }).data == expected.at({ i, j }).data);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("Every kernel computes column ranges like whole rows", "[step_kernels]") {
+	const auto scalar = getAvailableKernels().front().compute_row;
+	for (const auto& kernel : getAvailableKernels()) {
+		INFO("kernel: " << kernel.name);
+		for (const std::size_t columns : { 1, 5, 64, 150 }) {
+			const auto grid = makeRandomGrid(3, columns, 0.4, static_cast<unsigned>(columns));
+			Grid expected{ 3, columns };
+			stepRows(grid, expected, 0, 3, scalar);
+
+			std::mt19937 gen{ 5 };
+			for (int repeat = 0; repeat < 50; repeat++) {
+				std::uniform_int_distribution<std::size_t> bound{ 0, columns };
+				auto first = bound(gen);
+				auto last = bound(gen);
+				if (first > last) {
+					std::swap(first, last);
+				}
+				Grid actual{ 3, columns };
+				kernel.compute_row(
+					grid.row(0), grid.row(1), grid.row(2), actual.row(1), columns, first, last,
+					life_rule);
+				for (std::size_t j = 0; j < columns; j++) {
+					const bool in_range = j >= first && j < last;
+					REQUIRE(actual.at({ 1, j }).data == (in_range && expected.at({ 1, j }).data));
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("Rules without specialized kernels get the table kernels", "[step_kernels]") {
+	{
+		const auto& kernels = getTableKernels();
+		REQUIRE(kernels.front().name == "scalar-table");
+		REQUIRE(&getAvailableKernels(parseRule("B2/S1")) == &kernels);
+		REQUIRE(getDefaultKernel(parseRule("B2/S1")).name == kernels.back().name);
+	}
+	{
+		for (const auto& rule : getSpecializedRules()) {
+			REQUIRE(getAvailableKernels(rule).front().name == "scalar");
+		}
+	}
+}
+
+TEST_CASE("Scalar table kernel matches Grid::checkCell for any rule", "[step_kernels]") {
+	const auto scalar = getTableKernels().front().compute_row;
+	std::mt19937 gen{ 3 };
+	std::uniform_int_distribution<unsigned> mask{ 0, 0x1ff };
+	for (int repeat = 0; repeat < 20; repeat++) {
+		const Rule rule{ .birth = static_cast<std::uint16_t>(mask(gen)),
+						 .survival = static_cast<std::uint16_t>(mask(gen)) };
+		INFO("rule: " << toString(rule));
+		const auto grid = makeRandomGrid(9, 23, 0.4, static_cast<unsigned>(repeat));
+		Grid next{ grid.rows(), grid.columns() };
+		stepRows(grid, next, 0, grid.rows(), scalar, rule);
+		for (std::size_t i = 0; i < grid.rows(); i++) {
+			for (std::size_t j = 0; j < grid.columns(); j++) {
+				REQUIRE(next.at({ i, j }).data == grid.checkCell({ i, j }, rule));
+			}
+		}
+	}
+}
+
+TEST_CASE("Every specialized kernel matches the table kernel of its rule", "[step_kernels]") {
+	const auto table = getTableKernels().front().compute_row;
+	for (const auto& rule : getSpecializedRules()) {
+		for (const auto& kernel : getAvailableKernels(rule)) {
+			INFO("rule: " << toString(rule) << ", kernel: " << kernel.name);
+			unsigned seed = 0;
+			for (const std::size_t columns : { 1, 3, 17, 34, 66, 130, 257 }) {
+				for (const double density : { 0.05, 0.3, 0.7 }) {
+					INFO("columns: " << columns << ", density: " << density);
+					requireSameSteps(
+						makeRandomGrid(11, columns, density, seed++), table, kernel.compute_row, rule);
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("Every table kernel matches the scalar one for random rules", "[step_kernels]") {
+	const auto scalar = getTableKernels().front().compute_row;
+	std::mt19937 gen{ 7 };
+	std::uniform_int_distribution<unsigned> mask{ 0, 0x1ff };
+	for (int repeat = 0; repeat < 10; repeat++) {
+		const Rule rule{ .birth = static_cast<std::uint16_t>(mask(gen)),
+						 .survival = static_cast<std::uint16_t>(mask(gen)) };
+		for (const auto& kernel : getTableKernels()) {
+			INFO("rule: " << toString(rule) << ", kernel: " << kernel.name);
+			unsigned seed = 0;
+			for (const std::size_t columns : { 2, 16, 33, 65, 200 }) {
+				INFO("columns: " << columns);
+				requireSameSteps(
+					makeRandomGrid(9, columns, 0.3, seed++), scalar, kernel.compute_row, rule);
+			}
+		}
+	}
+}
+
+TEST_CASE("Every kernel counts the cells it computes", "[step_kernels]") {
+	const auto scalar = getAvailableKernels().front().compute_row;
+	for (const auto* kernels : { &getAvailableKernels(), &getTableKernels() }) {
+		for (const auto& kernel : *kernels) {
+			INFO("kernel: " << kernel.name);
+			for (const std::size_t columns : { 1, 5, 64, 150, 300 }) {
+				for (const std::size_t first_col : { std::size_t{ 0 }, columns / 3 }) {
+					INFO("columns: " << columns << ", first column: " << first_col);
+					const auto grid = makeRandomGrid(3, columns, 0.4, static_cast<unsigned>(columns));
+					Grid expected{ 3, columns };
+					stepRows(grid, expected, 0, 3, scalar);
+					Grid actual{ 3, columns };
+					RowCounts counts;
+					kernel.compute_counted_row(grid.row(0), grid.row(1), grid.row(2), actual.row(1), columns, first_col, columns, life_rule, counts);
+
+					RowCounts expected_counts;
+					for (auto j = first_col; j < columns; j++) {
+						REQUIRE(actual.at({ 1, j }).data == expected.at({ 1, j }).data);
+						const bool was_alive = grid.at({ 1, j }).data;
+						const bool is_alive = expected.at({ 1, j }).data;
+						expected_counts.population += is_alive;
+						expected_counts.births += is_alive && !was_alive;
+						expected_counts.deaths += was_alive && !is_alive;
+					}
+					REQUIRE(counts.population == expected_counts.population);
+					REQUIRE(counts.births == expected_counts.births);
+					REQUIRE(counts.deaths == expected_counts.deaths);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,73 @@
+#include <atomic>
+#include <random>
+#include <vector>
+#include "catch.hpp"
+#include "../src/grid.h"
+#include "../src/thread_pool.h"
+
+TEST_CASE("ThreadPool thread count is correct", "[thread_pool]") {
+	{
+		const ThreadPool pool{ 4 };
+		REQUIRE(pool.threadCount() == 4);
+	}
+	{
+		const ThreadPool pool{ 0 };
+		REQUIRE(pool.threadCount() >= 1);
+	}
+}
+
+TEST_CASE("ThreadPool covers every index exactly once", "[thread_pool]") {
+	for (const std::size_t threads : { 1, 2, 3, 8 }) {
+		ThreadPool pool{ threads };
+		for (const std::size_t count : { 0, 1, 5, 100, 1001 }) {
+			std::vector<std::atomic<int>> visits(count);
+			std::atomic<bool> empty_band{ false };
+			for (int repeat = 0; repeat < 10; repeat++) {
+				pool.parallelFor(count, [&](std::size_t begin, std::size_t end) {
+					empty_band = empty_band || begin >= end;
+					for (std::size_t i = begin; i < end; i++) {
+						visits[i]++;
+					}
+				});
+			}
+			REQUIRE(empty_band == false);
+			for (const auto& visit : visits) {
+				REQUIRE(visit == 10);
+			}
+		}
+	}
+}
+
+TEST_CASE("Multithreaded grid step matches single-threaded one", "[thread_pool]") {
+	{
+		std::mt19937 gen{ 42 };
+		std::bernoulli_distribution alive{ 0.3 };
+		Grid grid{ 67, 45 };
+		for (std::size_t i = 0; i < grid.rows(); i++) {
+			for (std::size_t j = 0; j < grid.columns(); j++) {
+				grid.at({ i, j }).data = alive(gen);
+			}
+		}
+
+		ThreadPool pool{ 5 };
+		Grid single = grid;
+		Grid single_next = grid;
+		Grid multi = grid;
+		Grid multi_next = grid;
+		for (int step = 0; step < 30; step++) {
+			single.step(single_next);
+			std::swap(single, single_next);
+
+			pool.parallelFor(multi.rows(), [&](std::size_t begin, std::size_t end) {
+				multi.step(multi_next, begin, end);
+			});
+			std::swap(multi, multi_next);
+
+			for (std::size_t i = 0; i < grid.rows(); i++) {
+				for (std::size_t j = 0; j < grid.columns(); j++) {
+					REQUIRE(single.at({ i, j }).data == multi.at({ i, j }).data);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,84 @@
+#include "catch.hpp"
+#include "test_helpers.h"
+#include "../src/tiled_grid_engine.h"
+#include "../src/zobrist.h"
+
+TEST_CASE("Tiled engine matches the row sweep on random boards", "[tiled_grid_engine]") {
+	// Tiles that divide the board, that do not, single cells, single rows and
+	// tiles larger than the board.
+	const std::size_t sizes[][4] = {
+		{ 5, 7, 2, 3 }, { 16, 16, 8, 8 }, { 30, 45, 8, 16 }, { 100, 70, 16, 64 },
+		{ 64, 200, 64, 32 }, { 9, 9, 1, 1 }, { 33, 70, 1, 70 }, { 20, 20, 64, 64 }
+	};
+	for (const auto& size : sizes) {
+		for (const std::size_t threads : { 1, 3 }) {
+			INFO("board " << size[0] << "x" << size[1] << ", tile " << size[2] << "x" << size[3]);
+			const auto grid = makeRandomGrid(size[0], size[1], 0.3, static_cast<unsigned>(size[1]));
+			GridEngine rows{ size[0], size[1] };
+			TiledGridEngine tiled{ size[0], size[1], threads, { size[2], size[3] } };
+			rows.load(grid);
+			tiled.load(grid);
+			for (int gen = 0; gen < 60; gen++) {
+				rows.step(1);
+				tiled.step(1);
+				REQUIRE(isSame(rows.current(), tiled.current()));
+			}
+		}
+	}
+}
+
+TEST_CASE("Tiled engine matches the row sweep for other rules", "[tiled_grid_engine]") {
+	for (const auto& rule : { highlife_rule, seeds_rule, parseRule("B0/S8"), parseRule("B35678/S5678") }) {
+		INFO("rule: " << toString(rule));
+		const auto grid = makeRandomGrid(40, 90, 0.2, 11);
+		GridEngine rows{ 40, 90, 1, rule };
+		TiledGridEngine tiled{ 40, 90, 2, { 16, 32 }, rule };
+		rows.load(grid);
+		tiled.load(grid);
+		for (int gen = 0; gen < 30; gen++) {
+			rows.step(1);
+			tiled.step(1);
+			REQUIRE(isSame(rows.current(), tiled.current()));
+		}
+	}
+}
+
+TEST_CASE("Tiled engine keeps its hash up to date across tiles", "[tiled_grid_engine]") {
+	{
+		TiledGridEngine tiled{ 50, 70, 2, { 8, 16 } };
+		REQUIRE(tiled.trackHash());
+		tiled.load(makeRandomGrid(50, 70, 0.35, 5));
+		for (int gen = 0; gen < 20; gen++) {
+			tiled.step(1);
+			REQUIRE(tiled.hash() == hashGrid(tiled.current()));
+		}
+	}
+}
+
+TEST_CASE("Tiled engine picks its tile size from the cache size", "[tiled_grid_engine]") {
+	{
+		REQUIRE(TiledGridEngine::getCacheSize() > 0);
+		// Tiles are squares of a power-of-two width filling half the cache
+		// with both generations, also on boards that fit the cache in rows.
+		const auto square = TiledGridEngine::getAutoTileSize(256 * 1024, 4096);
+		REQUIRE(square.row == 256);
+		REQUIRE(square.col == 256);
+		const auto large = TiledGridEngine::getAutoTileSize(2 * 1024 * 1024, 16384);
+		REQUIRE(large.row == 1024);
+		REQUIRE(large.col == 512);
+		// Boards narrower than a tile get taller tiles.
+		const auto narrow = TiledGridEngine::getAutoTileSize(256 * 1024, 100);
+		REQUIRE(narrow.col == 100);
+		REQUIRE(narrow.row == 655);
+		REQUIRE(TiledGridEngine::getAutoTileSize(256 * 1024, 10).row == 6553);
+		const auto tiny = TiledGridEngine::getAutoTileSize(64, 100000);
+		REQUIRE(tiny.row == TiledGridEngine::min_auto_tile_rows);
+
+		const TiledGridEngine tiled{ 1000, 300, 1, { 100, 128 } };
+		REQUIRE(tiled.tileSize().row == 100);
+		REQUIRE(tiled.tileCount() == 30);
+		const TiledGridEngine automatic{ 10, 10 };
+		REQUIRE(automatic.tileSize().row > 0);
+		REQUIRE(automatic.tileCount() == 1);
+	}
+}
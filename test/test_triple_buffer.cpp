@@ -0,0 +1,67 @@
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "catch.hpp"
+#include "../src/triple_buffer.h"
+
+TEST_CASE("TripleBuffer hands over the latest published frame", "[triple_buffer]") {
+	{
+		TripleBuffer<int> frames{ 0 };
+		REQUIRE(frames.update() == false);
+		REQUIRE(frames.front() == 0);
+
+		frames.back() = 1;
+		frames.publish();
+		REQUIRE(frames.hasUnreadFrame());
+		REQUIRE(frames.update() == true);
+		REQUIRE(frames.front() == 1);
+		REQUIRE(frames.hasUnreadFrame() == false);
+		REQUIRE(frames.update() == false);
+		REQUIRE(frames.front() == 1);
+	}
+	{
+		TripleBuffer<int> frames{ 0 };
+		for (int i = 1; i <= 5; i++) {
+			frames.back() = i;
+			frames.publish();
+		}
+		REQUIRE(frames.update() == true);
+		REQUIRE(frames.front() == 5);
+	}
+}
+
+TEST_CASE("TripleBuffer never exposes a partially written frame", "[triple_buffer]") {
+	{
+		constexpr std::uint64_t frame_count = 20000;
+		TripleBuffer<std::vector<std::uint64_t>> frames{ std::vector<std::uint64_t>(64, 0) };
+
+		std::thread writer{ [&] {
+			for (std::uint64_t i = 1; i <= frame_count; i++) {
+				for (auto& value : frames.back()) {
+					value = i;
+				}
+				frames.publish();
+			}
+		} };
+
+		std::uint64_t last_seen = 0;
+		bool is_consistent = true;
+		bool is_monotonic = true;
+		while (last_seen < frame_count) {
+			if (!frames.update()) {
+				continue;
+			}
+			const auto& frame = frames.front();
+			for (const auto value : frame) {
+				is_consistent = is_consistent && value == frame[0];
+			}
+			is_monotonic = is_monotonic && frame[0] > last_seen;
+			last_seen = frame[0];
+		}
+		writer.join();
+
+		REQUIRE(is_consistent);
+		REQUIRE(is_monotonic);
+	}
+}
@@ -0,0 +1,58 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "catch.hpp"
+#include "../src/work_stealing_pool.h"
+
+TEST_CASE("WorkStealingPool thread count is correct", "[work_stealing_pool]") {
+	{
+		const WorkStealingPool pool{ 3 };
+		REQUIRE(pool.threadCount() == 3);
+	}
+	{
+		const WorkStealingPool pool{ 0 };
+		REQUIRE(pool.threadCount() >= 1);
+	}
+}
+
+TEST_CASE("WorkStealingPool runs every task exactly once", "[work_stealing_pool]") {
+	for (const std::size_t threads : { 1, 2, 3, 8 }) {
+		WorkStealingPool pool{ threads };
+		for (const std::size_t count : { 0, 1, 5, 100, 1001 }) {
+			std::vector<std::atomic<int>> visits(count);
+			std::atomic<bool> bad_worker{ false };
+			for (int repeat = 0; repeat < 10; repeat++) {
+				pool.run(count, [&](std::size_t index, std::size_t worker) {
+					bad_worker = bad_worker || worker >= threads;
+					visits[index]++;
+				});
+			}
+			REQUIRE(bad_worker == false);
+			for (const auto& visit : visits) {
+				REQUIRE(visit == 10);
+			}
+		}
+	}
+}
+
+TEST_CASE("WorkStealingPool steals the tasks of a busy worker", "[work_stealing_pool]") {
+	{
+		// Worker 0 is dealt the first tasks; while it is stuck in the first
+		// one, the others have to take the rest of its share.
+		WorkStealingPool pool{ 4 };
+		std::vector<std::atomic<std::size_t>> workers(16);
+		pool.run(workers.size(), [&](std::size_t index, std::size_t worker) {
+			workers[index] = worker;
+			if (index == 3) {
+				std::this_thread::sleep_for(std::chrono::milliseconds{ 200 });
+			}
+		});
+		REQUIRE(pool.stealCount() > 0);
+		std::size_t run_by_others = 0;
+		for (std::size_t i = 0; i < 3; i++) {
+			run_by_others += workers[i] != 0;
+		}
+		REQUIRE(run_by_others > 0);
+	}
+}
@@ -0,0 +1,90 @@
+#include "catch.hpp"
+#include "test_helpers.h"
+#include "../src/engine.h"
+#include "../src/sparse_tile_engine.h"
+#include "../src/zobrist.h"
+
+namespace {
+
+std::uint64_t countAlive(const Grid& grid) {
+	std::uint64_t population = 0;
+	for (std::size_t i = 0; i < grid.rows(); i++) {
+		for (std::size_t j = 0; j < grid.columns(); j++) {
+			population += grid.at({ i, j }).data;
+		}
+	}
+	return population;
+}
+
+}
+
+TEST_CASE("Row changes hash like a full rehash", "[zobrist]") {
+	{
+		const auto before = makeRandomGrid(1, 77, 0.5, 1);
+		const auto after = makeRandomGrid(1, 77, 0.5, 2);
+		const auto changes = hashRowChanges(before.row(0), after.row(0), 0, 77, 0);
+		REQUIRE(changes == (hashGrid(before) ^ hashGrid(after)));
+		REQUIRE(hashRowChanges(before.row(0), before.row(0), 0, 77, 0) == 0);
+
+		// Only [first, last) counts, at the given coordinates.
+		Grid dead{ 1, 77 };
+		REQUIRE(hashRowChanges(dead.row(0), after.row(0), 0, 77, -3, 10) == hashGrid(after, 10, -3));
+		const auto part = hashRowChanges(dead.row(0), after.row(0), 5, 13, 0);
+		std::uint64_t expected = 0;
+		for (std::size_t j = 5; j < 13; j++) {
+			if (after.at({ 0, j }).data) {
+				expected ^= getCellKey(static_cast<std::int64_t>(j), 0);
+			}
+		}
+		REQUIRE(part == expected);
+	}
+}
+
+TEST_CASE("Engines keep their hash up to date incrementally", "[zobrist]") {
+	{
+		const auto board = makeRandomGrid(70, 90, 0.35, 3);
+		for (const auto name : { "grid", "tiled", "active", "sparse" }) {
+			for (const std::size_t threads : { 1, 3 }) {
+				auto engine = makeEngine(name, board.getSize(), threads);
+				REQUIRE(engine->trackHash());
+				REQUIRE(engine->hash() == 0);
+				engine->load(board);
+				REQUIRE(engine->hash() == hashGrid(board));
+
+				Grid saved{ board.rows(), board.columns() };
+				for (int round = 0; round < 10; round++) {
+					engine->step(3);
+					engine->set({ 5, static_cast<std::size_t>(round) }, round % 2 == 0);
+					if (std::string_view{ name } == "sparse") {
+						// The plane is not cut off at the board's edges.
+						continue;
+					}
+					engine->save(saved);
+					REQUIRE(engine->hash() == hashGrid(saved));
+				}
+			}
+		}
+	}
+	{
+		SparseTileEngine engine;
+		const auto pattern = makeRandomGrid(20, 20, 0.4, 4);
+		engine.load(pattern, -100, 50);
+		REQUIRE(engine.trackHash());
+		REQUIRE(engine.hash() == hashGrid(pattern, -100, 50));
+
+		for (int round = 0; round < 20; round++) {
+			engine.step(1);
+			Grid saved{ 200, 200 };
+			engine.save(saved, -190, -40);
+			// Every live cell is inside the saved window.
+			REQUIRE(engine.population() == countAlive(saved));
+			REQUIRE(engine.hash() == hashGrid(saved, -190, -40));
+		}
+		engine.clear();
+		REQUIRE(engine.hash() == 0);
+	}
+	{
+		auto engine = makeEngine("hashlife", { 8, 8 }, 1);
+		REQUIRE_FALSE(engine->trackHash());
+	}
+}